@@ -0,0 +1,59 @@
+/// \file bobopt_annotations.hpp File contains annotations tuning optimizer
+/// for single box.
+///
+/// Header is self-contained, annotated program only needs the annotations
+/// directory in its include path. Annotations are placed between class key
+/// and name of box:
+/// \code
+/// class BOBOPT_YIELD_THRESHOLD(5000) BOBOPT_NO_PREFETCH my_box : public bobox::basic_box
+/// \endcode
+/// They override configuration of optimizer for analysis of that box only.
+/// Functions are annotated by cost of their call:
+/// \code
+/// BOBOPT_COST(50000) void rebuild_index();
+/// \endcode
+/// Compilers other than Clang ignore annotations.
+
+#ifndef BOBOPT_ANNOTATIONS_BOBOPT_ANNOTATIONS_HPP_GUARD_
+#define BOBOPT_ANNOTATIONS_BOBOPT_ANNOTATIONS_HPP_GUARD_
+
+/// \def BOBOPT_CONFIG(group, variable, value)
+/// Override configuration variable for box, all arguments are string literals,
+/// e.g., BOBOPT_CONFIG("prefetch", "call_after_execution", "true").
+#if defined(__clang__)
+#define BOBOPT_CONFIG(group, variable, value) __attribute__((annotate("bobopt:config:" group ":" variable ":" value)))
+#else
+#define BOBOPT_CONFIG(group, variable, value)
+#endif
+
+/// \def BOBOPT_DISABLE(method)
+/// Disable optimization method for box, method is string literal with its name,
+/// i.e., "prefetch", "yield_complex" or "profile_probes".
+#if defined(__clang__)
+#define BOBOPT_DISABLE(method) __attribute__((annotate("bobopt:disable:" method)))
+#else
+#define BOBOPT_DISABLE(method)
+#endif
+
+/// \def BOBOPT_COST(value)
+/// Complexity of call to function used by yield complex method instead of its
+/// estimate, e.g., for expensive function defined in other translation unit.
+#if defined(__clang__)
+#define BOBOPT_COST(value) __attribute__((annotate("bobopt:cost:" #value)))
+#else
+#define BOBOPT_COST(value)
+#endif
+
+/// \def BOBOPT_YIELD_THRESHOLD(value)
+/// Complexity threshold of yield complex method for box.
+#define BOBOPT_YIELD_THRESHOLD(value) BOBOPT_CONFIG("yield complex", "threshold", #value)
+
+/// \def BOBOPT_NO_PREFETCH
+/// Don't prefetch inputs of box.
+#define BOBOPT_NO_PREFETCH BOBOPT_DISABLE("prefetch")
+
+/// \def BOBOPT_NO_YIELD
+/// Don't insert yields into box.
+#define BOBOPT_NO_YIELD BOBOPT_DISABLE("yield_complex")
+
+#endif // guard
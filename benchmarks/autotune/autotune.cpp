@@ -0,0 +1,386 @@
+/// \file autotune.cpp Closed-loop tuner of optimizer parameters.
+///
+/// Usage: bobopt_autotune -config=<file> -build=<command> -run=<command>
+///        -output=<file> [-log=<file>] [-base=<file>] [-rounds=<n>]
+///
+/// Every trial writes candidate configuration to \c config file, runs
+/// \c build command, which optimizes and rebuilds benchmark with that file,
+/// and \c run command, which prints benchmark report. Throughput of trial is
+/// number of runs per second by median wall time of the report.
+///
+/// Parameters are searched by coordinate search: each parameter in turn is set
+/// to every candidate value while others keep the best values found so far.
+/// Search stops after \c rounds rounds or when round doesn't improve
+/// throughput. Configuration with the best throughput is written to \c output,
+/// all trials are logged to \c log as tab separated values. Variables of
+/// \c base configuration that aren't tuned are kept in trial configurations.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#define popen _popen
+#define pclose _pclose
+#endif
+
+namespace bobopt
+{
+
+    /// \brief Options of tuner.
+    struct autotune_options
+    {
+        autotune_options()
+            : config()
+            , build()
+            , run()
+            , output()
+            , log()
+            , base()
+            , rounds(3)
+        {
+        }
+
+        std::string config;
+        std::string build;
+        std::string run;
+        std::string output;
+        std::string log;
+        std::string base;
+        unsigned rounds;
+    };
+
+    /// \brief Tuned configuration variable and its candidate values.
+    struct parameter
+    {
+        const char* group;
+        const char* variable;
+        std::vector<std::string> values;
+    };
+
+    /// \brief Configuration groups, variables and their values.
+    typedef std::map<std::string, std::map<std::string, std::string> > config_type;
+
+    /// \brief Index of current value of every parameter.
+    typedef std::vector<std::size_t> point_type;
+
+    static std::vector<parameter> make_parameters()
+    {
+        std::vector<parameter> result;
+
+        const parameter threshold = { "yield complex", "threshold", { "2000", "5000", "10000", "20000", "50000", "100000" } };
+        const parameter multiplier_for = { "yield complex", "multiplier_for", { "5", "1", "10", "20", "50" } };
+        const parameter multiplier_while = { "yield complex", "multiplier_while", { "15", "1", "5", "25", "50" } };
+        const parameter after_execution = { "prefetch", "call_after_execution", { "false", "true" } };
+
+        result.push_back(threshold);
+        result.push_back(multiplier_for);
+        result.push_back(multiplier_while);
+        result.push_back(after_execution);
+        return result;
+    }
+
+    static bool parse_string(const char* arg, const char* name, std::string& value)
+    {
+        const std::size_t length = std::strlen(name);
+        if ((std::strncmp(arg, name, length) != 0) || (arg[length] != '='))
+        {
+            return false;
+        }
+
+        value = arg + length + 1;
+        return true;
+    }
+
+    static bool parse_unsigned(const char* arg, const char* name, unsigned& value)
+    {
+        const std::size_t length = std::strlen(name);
+        if ((std::strncmp(arg, name, length) != 0) || (arg[length] != '='))
+        {
+            return false;
+        }
+
+        char* end = nullptr;
+        value = static_cast<unsigned>(std::strtoul(arg + length + 1, &end, 10));
+        return (end != arg + length + 1) && (*end == '\0');
+    }
+
+    static bool parse_options(int argc, char* argv[], autotune_options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const char* arg = argv[i];
+            if (!parse_string(arg, "-config", options.config) && !parse_string(arg, "-build", options.build) &&
+                !parse_string(arg, "-run", options.run) && !parse_string(arg, "-output", options.output) &&
+                !parse_string(arg, "-log", options.log) && !parse_string(arg, "-base", options.base) &&
+                !parse_unsigned(arg, "-rounds", options.rounds))
+            {
+                std::cerr << "invalid option: " << arg << std::endl;
+                return false;
+            }
+        }
+
+        if (options.config.empty() || options.build.empty() || options.run.empty() || options.output.empty())
+        {
+            std::cerr << "usage: " << argv[0] << " -config=<file> -build=<command> -run=<command> -output=<file> [-log=<file>] [-base=<file>] [-rounds=<n>]" << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    /// \brief Read configuration file in format of bobopt -c.
+    static bool read_config(const std::string& file_name, config_type& config)
+    {
+        std::ifstream file(file_name);
+        if (!file)
+        {
+            return false;
+        }
+
+        static const std::regex REGEX_GROUP(R"(\[([a-zA-Z0-9_ ]+)\])");
+        static const std::regex REGEX_VARIABLE(R"(([a-zA-Z0-9_]+)\s*:\s*(.*))");
+
+        std::string group;
+        for (std::string line; std::getline(file, line);)
+        {
+            std::smatch m;
+            if (std::regex_match(line, m, REGEX_VARIABLE))
+            {
+                config[group][m[1].str()] = m[2].str();
+            }
+            else if (std::regex_match(line, m, REGEX_GROUP))
+            {
+                group = m[1].str();
+            }
+        }
+
+        return true;
+    }
+
+    static bool write_config(const std::string& file_name, const config_type& config)
+    {
+        std::ofstream file(file_name, std::ios::trunc);
+        for (const auto& group : config)
+        {
+            if (group.first.empty())
+            {
+                continue;
+            }
+
+            file << '[' << group.first << ']' << std::endl;
+            file << std::endl;
+
+            for (const auto& variable : group.second)
+            {
+                file << variable.first << ": " << variable.second << std::endl;
+            }
+
+            file << std::endl;
+        }
+
+        return static_cast<bool>(file);
+    }
+
+    /// \brief Configuration of point, tuned parameters override base configuration.
+    static config_type get_config(const config_type& base, const std::vector<parameter>& parameters, const point_type& point)
+    {
+        config_type result = base;
+        for (std::size_t i = 0; i < parameters.size(); ++i)
+        {
+            result[parameters[i].group][parameters[i].variable] = parameters[i].values[point[i]];
+        }
+
+        return result;
+    }
+
+    /// \brief Run command and capture its standard output.
+    static bool run_command(const std::string& command, std::string& output)
+    {
+        FILE* pipe = popen(command.c_str(), "r");
+        if (pipe == nullptr)
+        {
+            return false;
+        }
+
+        char buffer[4096];
+        for (std::size_t read; (read = std::fread(buffer, 1, sizeof(buffer), pipe)) != 0;)
+        {
+            output.append(buffer, read);
+        }
+
+        return pclose(pipe) == 0;
+    }
+
+    /// \brief Median wall time in milliseconds from benchmark report.
+    static bool parse_report(const std::string& report, double& median)
+    {
+        static const std::regex REGEX_MEDIAN(R"("median":\s*([0-9.eE+-]+))");
+        static const std::regex REGEX_OK(R"("ok":\s*true)");
+
+        std::smatch m;
+        if (!std::regex_search(report, m, REGEX_MEDIAN) || !std::regex_search(report, REGEX_OK))
+        {
+            return false;
+        }
+
+        median = std::strtod(m[1].str().c_str(), nullptr);
+        return median > 0.0;
+    }
+
+    /// \brief Trials of tuner, each point is measured once.
+    class tuner
+    {
+    public:
+        tuner(const autotune_options& options, const config_type& base)
+            : options_(options)
+            , base_(base)
+            , parameters_(make_parameters())
+            , throughputs_()
+            , log_()
+            , trials_(0)
+        {
+            if (!options_.log.empty())
+            {
+                log_.open(options_.log, std::ios::trunc);
+                log_ << "trial";
+                for (const auto& parameter : parameters_)
+                {
+                    log_ << '\t' << parameter.variable;
+                }
+                log_ << "\tmedian_ms\tthroughput\tstatus" << std::endl;
+            }
+        }
+
+        const std::vector<parameter>& get_parameters() const
+        {
+            return parameters_;
+        }
+
+        /// \brief Throughput in runs per second, zero for failed trial.
+        double measure(const point_type& point)
+        {
+            auto found = throughputs_.find(point);
+            if (found != throughputs_.end())
+            {
+                return found->second;
+            }
+
+            ++trials_;
+
+            double median = 0.0;
+            const char* status = "ok";
+
+            std::string output;
+            std::string report;
+            if (!write_config(options_.config, get_config(base_, parameters_, point)))
+            {
+                status = "config_failed";
+            }
+            else if (!run_command(options_.build, output))
+            {
+                status = "build_failed";
+            }
+            else if (!run_command(options_.run, report) || !parse_report(report, median))
+            {
+                status = "run_failed";
+            }
+
+            const double throughput = (median > 0.0) ? (1000.0 / median) : 0.0;
+            throughputs_[point] = throughput;
+
+            std::cerr << "trial " << trials_ << ": " << status << ", median " << median << " ms" << std::endl;
+            if (log_.is_open())
+            {
+                log_ << trials_;
+                for (std::size_t i = 0; i < parameters_.size(); ++i)
+                {
+                    log_ << '\t' << parameters_[i].values[point[i]];
+                }
+                log_ << '\t' << median << '\t' << throughput << '\t' << status << std::endl;
+            }
+
+            return throughput;
+        }
+
+    private:
+        const autotune_options& options_;
+        const config_type& base_;
+        std::vector<parameter> parameters_;
+        std::map<point_type, double> throughputs_;
+        std::ofstream log_;
+        unsigned trials_;
+    };
+
+} // bobopt
+
+int main(int argc, char* argv[])
+{
+    bobopt::autotune_options options;
+    if (!bobopt::parse_options(argc, argv, options))
+    {
+        return 2;
+    }
+
+    bobopt::config_type base;
+    if (!options.base.empty() && !bobopt::read_config(options.base, base))
+    {
+        std::cerr << "failed to read base configuration: " << options.base << std::endl;
+        return 1;
+    }
+
+    bobopt::tuner tuner(options, base);
+    const auto& parameters = tuner.get_parameters();
+
+    // The first value of every parameter is default of optimizer.
+    bobopt::point_type best(parameters.size(), 0);
+    double best_throughput = tuner.measure(best);
+
+    for (unsigned round = 0; round < options.rounds; ++round)
+    {
+        bool improved = false;
+        for (std::size_t i = 0; i < parameters.size(); ++i)
+        {
+            bobopt::point_type point = best;
+            for (std::size_t value = 0; value < parameters[i].values.size(); ++value)
+            {
+                point[i] = value;
+
+                const double throughput = tuner.measure(point);
+                if (throughput > best_throughput)
+                {
+                    best = point;
+                    best_throughput = throughput;
+                    improved = true;
+                }
+            }
+        }
+
+        if (!improved)
+        {
+            break;
+        }
+    }
+
+    if (best_throughput <= 0.0)
+    {
+        std::cerr << "no trial succeeded" << std::endl;
+        return 1;
+    }
+
+    if (!bobopt::write_config(options.output, bobopt::get_config(base, parameters, best)))
+    {
+        std::cerr << "failed to write configuration: " << options.output << std::endl;
+        return 1;
+    }
+
+    std::cout << "best throughput " << best_throughput << " runs/s, configuration written to " << options.output << std::endl;
+    return 0;
+}
@@ -0,0 +1,261 @@
+#include <benchmarks/bench_runner.hpp>
+
+#include <benchmarks/bench_utils.hpp>
+
+#include <benchmarks/bobox_prolog.hpp>
+#include <bobox_bobolang.hpp>
+#include <bobox_manager.hpp>
+#include <bobox_request.hpp>
+#include <bobox_results.hpp>
+#include <benchmarks/bobox_epilog.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+namespace bobopt
+{
+
+    namespace
+    {
+        /// \brief Measured run of model.
+        struct run_record
+        {
+            bobox::request_result_type result;
+            double wall_time;
+#if defined(BOBOX_STANDIN)
+            bobox::statistics counters;
+#endif
+        };
+
+        const char* result_name(bobox::request_result_type result)
+        {
+            switch (result)
+            {
+            case bobox::RRT_OK:
+                return "OK";
+            case bobox::RRT_ERROR:
+                return "Error";
+            case bobox::RRT_CANCELED:
+                return "Canceled";
+            case bobox::RRT_DEADLOCK:
+                return "Deadlock";
+            case bobox::RRT_MEMORY:
+                return "Memory";
+            case bobox::RRT_TIMEOUT:
+                return "Timeout";
+            default:
+                BOBOX_ASSERT(false);
+                return "Unknown";
+            }
+        }
+
+        /// Nearest-rank percentile of sorted values.
+        double percentile(const std::vector<double>& sorted, double p)
+        {
+            BOBOX_ASSERT(!sorted.empty());
+
+            std::size_t rank = static_cast<std::size_t>(std::ceil(p * static_cast<double>(sorted.size())));
+            if (rank == 0)
+            {
+                rank = 1;
+            }
+
+            return sorted[std::min(rank, sorted.size()) - 1];
+        }
+
+        double median(const std::vector<double>& sorted)
+        {
+            BOBOX_ASSERT(!sorted.empty());
+
+            const std::size_t middle = sorted.size() / 2;
+            return ((sorted.size() % 2) == 1) ? sorted[middle] : (sorted[middle - 1] + sorted[middle]) / 2.0;
+        }
+
+        bool parse_value(const char* arg, const char* name, const char*& value)
+        {
+            const std::size_t length = std::strlen(name);
+            if (std::strncmp(arg, name, length) != 0 || arg[length] != '=')
+            {
+                return false;
+            }
+
+            value = arg + length + 1;
+            return true;
+        }
+
+        bool parse_unsigned(const char* value, unsigned& result)
+        {
+            char* end = nullptr;
+            const unsigned long parsed = std::strtoul(value, &end, 10);
+            if (end == value || *end != '\0')
+            {
+                return false;
+            }
+
+            result = static_cast<unsigned>(parsed);
+            return true;
+        }
+
+        bool parse_real(const char* value, double& result)
+        {
+            char* end = nullptr;
+            const double parsed = std::strtod(value, &end);
+            if (end == value || *end != '\0' || parsed <= 0.0)
+            {
+                return false;
+            }
+
+            result = parsed;
+            return true;
+        }
+
+        run_record run_once(bobox::manager& mng, const bench_description& description, bobox::basic_object_factory& factory)
+        {
+            typedef std::chrono::steady_clock clock_type;
+
+            std::istringstream in(description.model);
+            bobox::request_id_type rqid = mng.create_request(bobox::bobolang::compile(in, &factory));
+
+            const clock_type::time_point start = clock_type::now();
+            mng.run_request(rqid);
+            mng.wait_on_request(rqid);
+            const clock_type::time_point end = clock_type::now();
+
+            run_record record;
+            record.result = mng.get_result(rqid);
+            record.wall_time = std::chrono::duration<double, std::milli>(end - start).count();
+#if defined(BOBOX_STANDIN)
+            record.counters = mng.get_statistics(rqid);
+#endif
+
+            mng.destroy_request(rqid);
+            return record;
+        }
+
+    } // anonymous namespace
+
+    // bench_options implementation.
+    //==========================================================================
+
+    bench_options::bench_options()
+        : scale(bench_get_scale())
+        , runs(5u)
+        , warmup(1u)
+        , threads(0u)
+    {
+    }
+
+    bool bench_parse_options(int argc, char* argv[], bench_options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const char* value = nullptr;
+
+            bool valid = false;
+            if (parse_value(argv[i], "-scale", value))
+            {
+                valid = parse_real(value, options.scale);
+            }
+            else if (parse_value(argv[i], "-runs", value))
+            {
+                valid = parse_unsigned(value, options.runs) && (options.runs > 0);
+            }
+            else if (parse_value(argv[i], "-warmup", value))
+            {
+                valid = parse_unsigned(value, options.warmup);
+            }
+            else if (parse_value(argv[i], "-threads", value))
+            {
+                valid = parse_unsigned(value, options.threads);
+            }
+
+            if (!valid)
+            {
+                std::cerr << "invalid option: " << argv[i] << std::endl;
+                std::cerr << "usage: " << argv[0] << " [-scale=<real>] [-runs=<n>] [-warmup=<n>] [-threads=<n>]" << std::endl;
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // bench_run implementation.
+    //==========================================================================
+
+    int bench_run(const bench_description& description, bobox::basic_object_factory& factory, const bench_options& options)
+    {
+        bench_set_scale(options.scale);
+        bench_calibrate();
+
+        bobox::scheduling_strategy_type strategy = description.strategy;
+        unsigned threads = description.threads;
+        if (options.threads != 0)
+        {
+            threads = options.threads;
+            strategy = (threads == 1) ? bobox::SS_SINGLE_THREADED : bobox::SS_SMP;
+        }
+
+        auto manager_params = new bobox::basic_parameters;
+        manager_params->add_parameter("SchedulingStrategy", strategy);
+        manager_params->add_parameter("OptimalPlevel", bobox::plevel_type(threads));
+        manager_params->add_parameter("BackupThreads", 0u);
+
+        bobox::manager mng((bobox::parameters_ptr_type(manager_params)));
+
+        for (unsigned i = 0; i < options.warmup; ++i)
+        {
+            run_once(mng, description, factory);
+        }
+
+        std::vector<run_record> records;
+        for (unsigned i = 0; i < options.runs; ++i)
+        {
+            records.push_back(run_once(mng, description, factory));
+        }
+
+        bool succeeded = true;
+        std::vector<double> times;
+        for (const auto& record : records)
+        {
+            succeeded = succeeded && (record.result == bobox::RRT_OK);
+            times.push_back(record.wall_time);
+        }
+        std::sort(times.begin(), times.end());
+
+        std::ostream& os = std::cout;
+        os << "{\n";
+        os << "  \"benchmark\": \"" << description.name << "\",\n";
+        os << "  \"scale\": " << options.scale << ",\n";
+        os << "  \"unit_iterations\": " << bench_get_unit_iterations() << ",\n";
+        os << "  \"threads\": " << ((strategy == bobox::SS_SINGLE_THREADED) ? 1u : threads) << ",\n";
+        os << "  \"runs\": [\n";
+        for (std::size_t i = 0; i < records.size(); ++i)
+        {
+            const run_record& record = records[i];
+            os << "    { \"result\": \"" << result_name(record.result) << "\", \"wall_ms\": " << record.wall_time;
+#if defined(BOBOX_STANDIN)
+            os << ", \"tasks\": " << record.counters.tasks;
+            os << ", \"bodies\": " << record.counters.bodies;
+            os << ", \"waits\": " << record.counters.waits;
+            os << ", \"yields\": " << record.counters.yields;
+            os << ", \"envelopes\": " << record.counters.envelopes;
+#endif
+            os << " }" << ((i + 1 < records.size()) ? "," : "") << "\n";
+        }
+        os << "  ],\n";
+        os << "  \"wall_ms\": { \"min\": " << times.front() << ", \"median\": " << median(times) << ", \"p95\": " << percentile(times, 0.95)
+           << ", \"max\": " << times.back() << " },\n";
+        os << "  \"ok\": " << (succeeded ? "true" : "false") << "\n";
+        os << "}" << std::endl;
+
+        return succeeded ? 0 : 1;
+    }
+
+} // bobopt
@@ -0,0 +1,59 @@
+#ifndef BOBOPT_BENCHMARKS_BENCH_RUNNER_HPP_GUARD_
+#define BOBOPT_BENCHMARKS_BENCH_RUNNER_HPP_GUARD_
+
+#include <benchmarks/bobox_prolog.hpp>
+#include <bobox_basic_object_factory.hpp>
+#include <bobox_types.hpp>
+#include <benchmarks/bobox_epilog.hpp>
+
+#include <string>
+
+namespace bobopt
+{
+
+    /// \brief Options of benchmark harness set from command line.
+    ///
+    /// Usage: <benchmark> [-scale=<real>] [-runs=<n>] [-warmup=<n>] [-threads=<n>]
+    struct bench_options
+    {
+        bench_options();
+
+        /// Scale of work units and item counts.
+        double scale;
+        /// Number of measured runs.
+        unsigned runs;
+        /// Number of runs before measurement.
+        unsigned warmup;
+        /// Number of worker threads, 0 means benchmark default.
+        unsigned threads;
+    };
+
+    /// \brief Parse command line options.
+    /// \return False and prints usage on invalid option.
+    bool bench_parse_options(int argc, char* argv[], bench_options& options);
+
+    /// \brief Describes model executed by benchmark.
+    struct bench_description
+    {
+        /// Name of benchmark in report.
+        const char* name;
+        /// Bobolang source of model.
+        std::string model;
+        /// Default scheduling strategy.
+        bobox::scheduling_strategy_type strategy;
+        /// Default number of worker threads.
+        unsigned threads;
+    };
+
+    /// \brief Run model repeatedly and print report in JSON to standard output.
+    ///
+    /// Report contains wall time of each run with its result and scheduling
+    /// counters (stand-in runtime only) and the minimum, median, 95th
+    /// percentile and maximum of wall times.
+    ///
+    /// \return Exit code for \c main, nonzero if any run failed.
+    int bench_run(const bench_description& description, bobox::basic_object_factory& factory, const bench_options& options);
+
+} // bobopt
+
+#endif // guard
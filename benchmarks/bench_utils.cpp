@@ -1,32 +1,122 @@
 #include <benchmarks/bench_utils.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+
 namespace bobopt
 {
 
-    void do_work(std::clock_t ticks)
+    namespace
+    {
+        /// Default scale makes hard work take 2ms.
+        const double DEFAULT_SCALE = 0.002;
+
+        /// Calibration measures at least this long in microseconds.
+        const double CALIBRATION_MIN_TIME = 20000.0;
+        /// Number of measurements, the fastest one is used.
+        const unsigned CALIBRATION_ROUNDS = 5u;
+
+        const unsigned long long LITTLE_WORK_UNITS = 100u;
+        const unsigned long long SOME_WORK_UNITS = 5000u;
+        const unsigned long long HARD_WORK_UNITS = 1000000u;
+
+        /// Sink for results of work loop, compiler can't remove the loop.
+        volatile unsigned long long work_sink = 0;
+
+        double work_scale = DEFAULT_SCALE;
+        double iterations_per_unit = 0.0;
+        std::once_flag calibration_flag;
+
+        /// xorshift steps depend on each other, so loop can't be vectorized
+        /// or replaced by closed formula.
+        unsigned long long work_loop(unsigned long long iterations)
+        {
+            unsigned long long state = 0x9e3779b97f4a7c15ull;
+            for (unsigned long long i = 0; i < iterations; ++i)
+            {
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+            }
+
+            return state;
+        }
+
+        void calibrate()
+        {
+            typedef std::chrono::steady_clock clock_type;
+
+            unsigned long long iterations = 1024u;
+            double best = 0.0;
+
+            for (unsigned round = 0; round < CALIBRATION_ROUNDS;)
+            {
+                const clock_type::time_point start = clock_type::now();
+                work_sink = work_loop(iterations);
+                const double elapsed = std::chrono::duration<double, std::micro>(clock_type::now() - start).count();
+
+                if (elapsed < CALIBRATION_MIN_TIME)
+                {
+                    iterations *= 2;
+                    continue;
+                }
+
+                best = std::max(best, static_cast<double>(iterations) / elapsed);
+                ++round;
+            }
+
+            iterations_per_unit = best;
+        }
+
+    } // anonymous namespace
+
+    void bench_calibrate()
+    {
+        std::call_once(calibration_flag, &calibrate);
+    }
+
+    double bench_get_unit_iterations()
     {
-        const std::clock_t end = std::clock() + ticks;
-        while (std::clock() < end)
-            ;
+        bench_calibrate();
+        return iterations_per_unit;
     }
 
-    static const std::clock_t LITTLE_WORK_TICKS = 100u;
-    static const std::clock_t SOME_WORK_TICKS = 5000u;
-    static const std::clock_t HARD_WORK_TICKS = CLOCKS_PER_SEC;
+    void bench_set_scale(double scale)
+    {
+        work_scale = scale;
+    }
+
+    double bench_get_scale()
+    {
+        return work_scale;
+    }
+
+    unsigned bench_scale_count(unsigned count)
+    {
+        const double scaled = static_cast<double>(count) * work_scale + 0.5;
+        return (scaled < 1.0) ? 1u : static_cast<unsigned>(scaled);
+    }
+
+    void do_work(unsigned long long units)
+    {
+        bench_calibrate();
+        work_sink = work_loop(static_cast<unsigned long long>(static_cast<double>(units) * work_scale * iterations_per_unit));
+    }
 
     void do_little_work()
     {
-        do_work(LITTLE_WORK_TICKS);
+        do_work(LITTLE_WORK_UNITS);
     }
 
     void do_some_work()
     {
-        do_work(SOME_WORK_TICKS);
+        do_work(SOME_WORK_UNITS);
     }
 
     void do_hard_work()
     {
-        do_work(HARD_WORK_TICKS);
+        do_work(HARD_WORK_UNITS);
     }
 
-} // bobopt
\ No newline at end of file
+} // bobopt
@@ -7,8 +7,6 @@
 #include <bobox_envelope.hpp>
 #include <bobox_types.hpp>
 
-#include <ctime>
-
 namespace bobopt
 {
     
@@ -16,15 +14,34 @@ namespace bobopt
     // Benchmarks
     //
 
-    /// \brief Do work for some specific number of ticks.
-    /// \param tick Number of ticks.
-    void do_work(const std::clock_t ticks);
+    /// \brief Calibrate work loop. Measures how many iterations of the work
+    /// loop take one work unit (1 microsecond) on this machine. Called by
+    /// benchmark harness before the first run.
+    void bench_calibrate();
+
+    /// \brief Get number of work loop iterations in one work unit.
+    double bench_get_unit_iterations();
+
+    /// \brief Set scale of all work. Scale 1.0 means that one work unit takes
+    /// 1 microsecond.
+    void bench_set_scale(double scale);
+
+    /// \brief Get scale of all work.
+    double bench_get_scale();
+
+    /// \brief Scale count of items processed by benchmark. Result is at least 1.
+    unsigned bench_scale_count(unsigned count);
+
+    /// \brief Do calibrated work. Work doesn't depend on clock of process, so
+    /// it takes the same time in every thread.
+    /// \param units Number of work units.
+    void do_work(unsigned long long units);
 
-    /// \brief Do work for 100 ticks.
+    /// \brief Do work for 100 units.
     void do_little_work();
-    /// \brief Do work for 5000 ticks.
+    /// \brief Do work for 5000 units.
     void do_some_work();
-    /// \brief Do work for 1 second (CLOCKS_PER_SEC ticks).
+    /// \brief Do work for 1000000 units (1 second with scale 1.0).
     void do_hard_work();
 
     //
@@ -0,0 +1,91 @@
+#include <bobox_basic_box.hpp>
+
+#include <bobox_request.hpp>
+
+namespace bobox
+{
+
+    // box implementation.
+    //==========================================================================
+
+    box::box(const box_parameters_pack& box_params)
+        : node_(box_params.get_node())
+    {
+        BOBOX_ASSERT(node_ != nullptr);
+    }
+
+    box::~box()
+    {
+    }
+
+    void box::init()
+    {
+        init_impl();
+    }
+
+    void box::init_impl()
+    {
+    }
+
+    detail::box_node& box::get_node() const
+    {
+        return *node_;
+    }
+
+    // basic_box implementation.
+    //==========================================================================
+
+    basic_box::basic_box(const box_parameters_pack& box_params)
+        : box(box_params)
+    {
+    }
+
+    basic_box::~basic_box()
+    {
+    }
+
+    void basic_box::prefetch_envelope(input_index_type input)
+    {
+        get_node().prefetch(input.get());
+    }
+
+    envelope_ptr_type basic_box::pop_envelope(input_index_type input)
+    {
+        return get_node().pop(input.get());
+    }
+
+    void basic_box::send_envelope(output_index_type output, envelope_ptr_type envelope)
+    {
+        get_node().send(output.get(), std::move(envelope));
+    }
+
+    void basic_box::send_poisoned(output_index_type output)
+    {
+        send_envelope(output, envelope_ptr_type(envelope::create_poisoned()));
+    }
+
+    envelope* basic_box::allocate(const envelope_descriptor& descriptor, std::size_t capacity)
+    {
+        return new envelope(descriptor, capacity);
+    }
+
+    const envelope_descriptor& basic_box::get_output_descriptor(output_index_type output) const
+    {
+        return get_node().get_output_descriptor(output.get());
+    }
+
+    void basic_box::yield()
+    {
+        get_node().yield();
+    }
+
+    void basic_box::sync_mach_etwas()
+    {
+        sync_body();
+    }
+
+    void basic_box::sync_body()
+    {
+    }
+
+} // bobox
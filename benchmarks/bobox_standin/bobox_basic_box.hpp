@@ -0,0 +1,110 @@
+/// \file bobox_basic_box.hpp File contains definition of the basic box of the
+/// Bobox stand-in runtime.
+///
+/// Box body is executed in its own fiber. Scheduler resumes the fiber when all
+/// prefetched inputs hold an envelope. Fiber is suspended when the body pops
+/// envelope from an empty input or calls \c yield().
+
+#ifndef BOBOPT_BENCHMARKS_BOBOX_STANDIN_BOBOX_BASIC_BOX_HPP_GUARD_
+#define BOBOPT_BENCHMARKS_BOBOX_STANDIN_BOBOX_BASIC_BOX_HPP_GUARD_
+
+#include <bobox_box.hpp>
+#include <bobox_envelope.hpp>
+#include <bobox_types.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace bobox
+{
+
+    class basic_box;
+
+    // box_model:
+    //==========================================================================
+
+    /// \brief Interface of box model registered in object factory. Model
+    /// creates box instances and maps names of inputs and outputs.
+    class box_model
+    {
+    public:
+        virtual ~box_model()
+        {
+        }
+
+        virtual basic_box* create(const box_parameters_pack& box_params) const = 0;
+        virtual box_state_type get_state() const = 0;
+        virtual input_index_type get_input_by_name(const std::string& name) const = 0;
+        virtual output_index_type get_output_by_name(const std::string& name) const = 0;
+    };
+
+    typedef std::shared_ptr<const box_model> box_model_ptr_type;
+
+    // basic_box:
+    //==========================================================================
+
+    /// \brief Base class of user boxes.
+    class basic_box : public box
+    {
+    public:
+        template <typename BoxT, box_state_type StateV>
+        class generic_model;
+
+        explicit basic_box(const box_parameters_pack& box_params);
+        virtual ~basic_box();
+
+        // envelopes:
+        void prefetch_envelope(input_index_type input);
+        envelope_ptr_type pop_envelope(input_index_type input);
+        void send_envelope(output_index_type output, envelope_ptr_type envelope);
+        void send_poisoned(output_index_type output);
+
+        envelope* allocate(const envelope_descriptor& descriptor, std::size_t capacity);
+        const envelope_descriptor& get_output_descriptor(output_index_type output) const;
+
+        // scheduling:
+        void yield();
+
+    protected:
+        virtual void sync_mach_etwas();
+        virtual void sync_body();
+
+    private:
+        friend class detail::box_node;
+    };
+
+    // basic_box::generic_model:
+    //==========================================================================
+
+    /// \brief Model of box type \c BoxT. Expects \c inputs and \c outputs
+    /// structures created by \c BOBOX_BOX_INPUTS_LIST and
+    /// \c BOBOX_BOX_OUTPUTS_LIST macros.
+    template <typename BoxT, box_state_type StateV>
+    class basic_box::generic_model : public box_model
+    {
+    public:
+        virtual basic_box* create(const box_parameters_pack& box_params) const BOBOX_OVERRIDE
+        {
+            return new BoxT(box_params);
+        }
+
+        virtual box_state_type get_state() const BOBOX_OVERRIDE
+        {
+            return StateV;
+        }
+
+        virtual input_index_type get_input_by_name(const std::string& name) const BOBOX_OVERRIDE
+        {
+            return BoxT::inputs::get_input_by_name(name);
+        }
+
+        virtual output_index_type get_output_by_name(const std::string& name) const BOBOX_OVERRIDE
+        {
+            return BoxT::outputs::get_output_by_name(name);
+        }
+    };
+
+} // bobox
+
+#endif // guard
@@ -0,0 +1,92 @@
+/// \file bobox_basic_box_utils.hpp File contains macros to declare inputs and
+/// outputs of boxes in the Bobox stand-in runtime.
+///
+/// Example:
+/// \code
+/// BOBOX_BOX_INPUTS_LIST(left, 0, right, 1);
+/// \endcode
+/// expands to
+/// \code
+/// struct inputs
+/// {
+///     static input_index_type left() { return input_index_type(0); }
+///     static input_index_type right() { return input_index_type(1); }
+///     static input_index_type get_input_by_name(const std::string& name) { ... }
+/// };
+/// \endcode
+///
+/// The getter by name has to be the last member function, the prefetch
+/// optimization method relies on this layout.
+
+#ifndef BOBOPT_BENCHMARKS_BOBOX_STANDIN_BOBOX_BASIC_BOX_UTILS_HPP_GUARD_
+#define BOBOPT_BENCHMARKS_BOBOX_STANDIN_BOBOX_BASIC_BOX_UTILS_HPP_GUARD_
+
+#include <bobox_basic_box.hpp>
+#include <bobox_types.hpp>
+
+#include <string>
+
+// Preprocessor helpers.
+//==============================================================================
+
+#define BOBOX_DETAIL_EXPAND(x) x
+#define BOBOX_DETAIL_CONCAT_IMPL(lhs, rhs) lhs##rhs
+#define BOBOX_DETAIL_CONCAT(lhs, rhs) BOBOX_DETAIL_CONCAT_IMPL(lhs, rhs)
+
+/// Number of (name, index) pairs in arguments. Supports up to 12 pairs.
+#define BOBOX_DETAIL_PAIRS_COUNT(...) \
+    BOBOX_DETAIL_EXPAND(BOBOX_DETAIL_PAIRS_COUNT_IMPL(__VA_ARGS__, 12, x, 11, x, 10, x, 9, x, 8, x, 7, x, 6, x, 5, x, 4, x, 3, x, 2, x, 1, x))
+#define BOBOX_DETAIL_PAIRS_COUNT_IMPL(a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24, n, ...) n
+
+#define BOBOX_DETAIL_PAIRS_1(m, t, n, i) m(t, n, i)
+#define BOBOX_DETAIL_PAIRS_2(m, t, n, i, ...) m(t, n, i) BOBOX_DETAIL_EXPAND(BOBOX_DETAIL_PAIRS_1(m, t, __VA_ARGS__))
+#define BOBOX_DETAIL_PAIRS_3(m, t, n, i, ...) m(t, n, i) BOBOX_DETAIL_EXPAND(BOBOX_DETAIL_PAIRS_2(m, t, __VA_ARGS__))
+#define BOBOX_DETAIL_PAIRS_4(m, t, n, i, ...) m(t, n, i) BOBOX_DETAIL_EXPAND(BOBOX_DETAIL_PAIRS_3(m, t, __VA_ARGS__))
+#define BOBOX_DETAIL_PAIRS_5(m, t, n, i, ...) m(t, n, i) BOBOX_DETAIL_EXPAND(BOBOX_DETAIL_PAIRS_4(m, t, __VA_ARGS__))
+#define BOBOX_DETAIL_PAIRS_6(m, t, n, i, ...) m(t, n, i) BOBOX_DETAIL_EXPAND(BOBOX_DETAIL_PAIRS_5(m, t, __VA_ARGS__))
+#define BOBOX_DETAIL_PAIRS_7(m, t, n, i, ...) m(t, n, i) BOBOX_DETAIL_EXPAND(BOBOX_DETAIL_PAIRS_6(m, t, __VA_ARGS__))
+#define BOBOX_DETAIL_PAIRS_8(m, t, n, i, ...) m(t, n, i) BOBOX_DETAIL_EXPAND(BOBOX_DETAIL_PAIRS_7(m, t, __VA_ARGS__))
+#define BOBOX_DETAIL_PAIRS_9(m, t, n, i, ...) m(t, n, i) BOBOX_DETAIL_EXPAND(BOBOX_DETAIL_PAIRS_8(m, t, __VA_ARGS__))
+#define BOBOX_DETAIL_PAIRS_10(m, t, n, i, ...) m(t, n, i) BOBOX_DETAIL_EXPAND(BOBOX_DETAIL_PAIRS_9(m, t, __VA_ARGS__))
+#define BOBOX_DETAIL_PAIRS_11(m, t, n, i, ...) m(t, n, i) BOBOX_DETAIL_EXPAND(BOBOX_DETAIL_PAIRS_10(m, t, __VA_ARGS__))
+#define BOBOX_DETAIL_PAIRS_12(m, t, n, i, ...) m(t, n, i) BOBOX_DETAIL_EXPAND(BOBOX_DETAIL_PAIRS_11(m, t, __VA_ARGS__))
+
+/// Apply macro \c m(t, name, index) on each (name, index) pair.
+#define BOBOX_DETAIL_FOR_EACH_PAIR(m, t, ...) \
+    BOBOX_DETAIL_EXPAND(BOBOX_DETAIL_CONCAT(BOBOX_DETAIL_PAIRS_, BOBOX_DETAIL_PAIRS_COUNT(__VA_ARGS__))(m, t, __VA_ARGS__))
+
+#define BOBOX_DETAIL_INDEX_GETTER(type, name, index) \
+    static type name() \
+    { \
+        return type(index); \
+    }
+
+#define BOBOX_DETAIL_INDEX_LOOKUP(type, name, index) \
+    if (bobox_name == #name) \
+    { \
+        return type(index); \
+    }
+
+#define BOBOX_DETAIL_INDEX_LIST(struct_name, type, getter, ...) \
+    struct struct_name \
+    { \
+        BOBOX_DETAIL_FOR_EACH_PAIR(BOBOX_DETAIL_INDEX_GETTER, type, __VA_ARGS__) \
+        static type getter(const std::string& bobox_name) \
+        { \
+            BOBOX_DETAIL_FOR_EACH_PAIR(BOBOX_DETAIL_INDEX_LOOKUP, type, __VA_ARGS__) \
+            return type(); \
+        } \
+    }
+
+// Box macros.
+//==============================================================================
+
+/// \def BOBOX_BOX_INPUTS_LIST(...)
+/// Declare \c inputs structure from (name, index) pairs.
+#define BOBOX_BOX_INPUTS_LIST(...) BOBOX_DETAIL_INDEX_LIST(inputs, input_index_type, get_input_by_name, __VA_ARGS__)
+
+/// \def BOBOX_BOX_OUTPUTS_LIST(...)
+/// Declare \c outputs structure from (name, index) pairs.
+#define BOBOX_BOX_OUTPUTS_LIST(...) BOBOX_DETAIL_INDEX_LIST(outputs, output_index_type, get_output_by_name, __VA_ARGS__)
+
+#endif // guard
@@ -0,0 +1,77 @@
+/// \file bobox_basic_object_factory.hpp File contains definition of object
+/// factory in the Bobox stand-in runtime.
+
+#ifndef BOBOPT_BENCHMARKS_BOBOX_STANDIN_BOBOX_BASIC_OBJECT_FACTORY_HPP_GUARD_
+#define BOBOPT_BENCHMARKS_BOBOX_STANDIN_BOBOX_BASIC_OBJECT_FACTORY_HPP_GUARD_
+
+#include <bobox_basic_box.hpp>
+#include <bobox_types.hpp>
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace bobox
+{
+
+    class runtime;
+
+    /// \brief Registry of box models and column types used by Bobolang
+    /// compiler to instantiate models.
+    class basic_object_factory
+    {
+    public:
+        virtual ~basic_object_factory()
+        {
+        }
+
+        /// \brief Register box model under name used in Bobolang.
+        template <typename ModelT>
+        void register_box(const box_model_tid_type& tid)
+        {
+            models_[tid.get()] = std::make_shared<ModelT>();
+        }
+
+        /// \brief Register column type under name used in Bobolang.
+        template <typename T>
+        void register_type(const type_tid_type& tid)
+        {
+            types_[tid.get()] = sizeof(T);
+        }
+
+        /// \brief Find box model, returns empty pointer for unknown name.
+        box_model_ptr_type find_box_model(const std::string& name) const
+        {
+            auto found = models_.find(name);
+            if (found == models_.end())
+            {
+                return box_model_ptr_type();
+            }
+
+            return found->second;
+        }
+
+        /// \brief Find size of registered type.
+        bool find_type_size(const std::string& name, std::size_t& size) const
+        {
+            auto found = types_.find(name);
+            if (found == types_.end())
+            {
+                return false;
+            }
+
+            size = found->second;
+            return true;
+        }
+
+        virtual runtime* get_runtime() = 0;
+
+    private:
+        std::map<std::string, box_model_ptr_type> models_;
+        std::map<std::string, std::size_t> types_;
+    };
+
+} // bobox
+
+#endif // guard
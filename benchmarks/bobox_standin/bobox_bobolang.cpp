@@ -0,0 +1,372 @@
+#include <bobox_bobolang.hpp>
+
+#include <bobox_basic_object_factory.hpp>
+
+#include <cctype>
+#include <map>
+
+namespace bobox
+{
+
+    // bobolang_compiler:
+    //==========================================================================
+
+    /// \brief Recursive descent parser of Bobolang subset.
+    class bobolang_compiler
+    {
+    public:
+        bobolang_compiler(std::istream& in, basic_object_factory* factory)
+            : in_(in)
+            , factory_(factory)
+            , token_()
+            , line_(1)
+            , model_(std::make_shared<model>())
+            , names_()
+        {
+        }
+
+        model_ptr_type compile()
+        {
+            next();
+            expect_identifier("model");
+            parse_identifier();
+            parse_signature();
+            parse_signature();
+            expect("{");
+
+            while (token_ != "}")
+            {
+                parse_statement();
+            }
+
+            expect("}");
+            if (!token_.empty())
+            {
+                error("unexpected '" + token_ + "' after model");
+            }
+
+            return model_;
+        }
+
+    private:
+        typedef std::vector<envelope_descriptor> descriptors_type;
+
+        // lexer:
+
+        void next()
+        {
+            token_.clear();
+
+            int c = in_.get();
+            while (c != EOF && std::isspace(c))
+            {
+                if (c == '\n')
+                {
+                    ++line_;
+                }
+                c = in_.get();
+            }
+
+            if (c == EOF)
+            {
+                return;
+            }
+
+            token_.push_back(static_cast<char>(c));
+            if (std::isalnum(c) || c == '_')
+            {
+                while (std::isalnum(in_.peek()) || in_.peek() == '_')
+                {
+                    token_.push_back(static_cast<char>(in_.get()));
+                }
+            }
+            else if (c == '-' && in_.peek() == '>')
+            {
+                token_.push_back(static_cast<char>(in_.get()));
+            }
+        }
+
+        void error(const std::string& message) const
+        {
+            std::ostringstream os;
+            os << "line " << line_ << ": " << message;
+            throw bobolang_error(os.str());
+        }
+
+        void expect(const char* token)
+        {
+            if (token_ != token)
+            {
+                error(std::string("expected '") + token + "', got '" + token_ + "'");
+            }
+
+            next();
+        }
+
+        void expect_identifier(const char* identifier)
+        {
+            if (token_ != identifier)
+            {
+                error(std::string("expected '") + identifier + "', got '" + token_ + "'");
+            }
+
+            next();
+        }
+
+        bool is_identifier() const
+        {
+            return !token_.empty() && (std::isalpha(static_cast<unsigned char>(token_[0])) || token_[0] == '_');
+        }
+
+        bool is_number() const
+        {
+            return !token_.empty() && std::isdigit(static_cast<unsigned char>(token_[0]));
+        }
+
+        std::string parse_identifier()
+        {
+            if (!is_identifier())
+            {
+                error("expected identifier, got '" + token_ + "'");
+            }
+
+            std::string result = token_;
+            next();
+            return result;
+        }
+
+        unsigned parse_number()
+        {
+            if (!is_number())
+            {
+                error("expected number, got '" + token_ + "'");
+            }
+
+            unsigned result = static_cast<unsigned>(std::stoul(token_));
+            next();
+            return result;
+        }
+
+        // grammar:
+
+        /// signature: '<' [envelope {',' envelope}] '>'
+        /// envelope: '(' [type {',' type}] ')'
+        descriptors_type parse_signature()
+        {
+            descriptors_type result;
+
+            expect("<");
+            while (token_ == "(")
+            {
+                next();
+
+                envelope_descriptor::columns_type columns;
+                while (token_ != ")")
+                {
+                    std::string type = parse_identifier();
+
+                    std::size_t size = 0;
+                    if (!factory_->find_type_size(type, size))
+                    {
+                        error("unknown type '" + type + "'");
+                    }
+
+                    columns.push_back(size);
+                    if (token_ == ",")
+                    {
+                        next();
+                    }
+                }
+                expect(")");
+
+                result.push_back(envelope_descriptor(std::move(columns)));
+                if (token_ == ",")
+                {
+                    next();
+                }
+            }
+            expect(">");
+
+            return result;
+        }
+
+        void parse_statement()
+        {
+            if (token_ == "input")
+            {
+                parse_connection();
+                return;
+            }
+
+            std::string name = parse_identifier();
+            if (token_ == "<")
+            {
+                parse_declaration(name);
+            }
+            else
+            {
+                parse_connection_from(name);
+            }
+        }
+
+        /// declaration: Type signature signature name {',' name} ';'
+        void parse_declaration(const std::string& type)
+        {
+            box_model_ptr_type box_model = factory_->find_box_model(type);
+            if (!box_model)
+            {
+                error("unknown box '" + type + "'");
+            }
+
+            descriptors_type inputs = parse_signature();
+            descriptors_type outputs = parse_signature();
+
+            for (;;)
+            {
+                model::box_declaration declaration;
+                declaration.name = parse_identifier();
+                declaration.box_model = box_model;
+                declaration.inputs = inputs;
+                declaration.outputs = outputs;
+
+                if (!names_.insert(std::make_pair(declaration.name, model_->boxes_.size())).second)
+                {
+                    error("redeclaration of '" + declaration.name + "'");
+                }
+                model_->boxes_.push_back(std::move(declaration));
+
+                if (token_ != ",")
+                {
+                    break;
+                }
+                next();
+            }
+
+            expect(";");
+        }
+
+        /// connection: source '->' destination ';'
+        /// source: 'input' | name ['[' number ']']
+        /// destination: 'output' | ['[' (number | input_name) ']'] name
+        void parse_connection()
+        {
+            expect_identifier("input");
+
+            model::endpoint from;
+            from.box = model::endpoint::EXTERNAL;
+            from.index = 0;
+            parse_destination(from);
+        }
+
+        void parse_connection_from(const std::string& name)
+        {
+            model::endpoint from;
+            from.box = find_box(name);
+            from.index = 0;
+
+            if (token_ == "[")
+            {
+                next();
+                from.index = parse_number();
+                expect("]");
+            }
+
+            if (from.index >= model_->boxes_[from.box].outputs.size())
+            {
+                error("box '" + name + "' has no such output");
+            }
+
+            parse_destination(from);
+        }
+
+        void parse_destination(const model::endpoint& from)
+        {
+            expect("->");
+
+            std::string input;
+            if (token_ == "[")
+            {
+                next();
+                input = token_;
+                next();
+                expect("]");
+            }
+
+            model::endpoint to;
+            to.index = 0;
+
+            std::string name = parse_identifier();
+            if (name == "output")
+            {
+                to.box = model::endpoint::EXTERNAL;
+            }
+            else
+            {
+                to.box = find_box(name);
+
+                const model::box_declaration& declaration = model_->boxes_[to.box];
+                if (!input.empty())
+                {
+                    if (std::isdigit(static_cast<unsigned char>(input[0])))
+                    {
+                        to.index = static_cast<unsigned>(std::stoul(input));
+                    }
+                    else
+                    {
+                        input_index_type index = declaration.box_model->get_input_by_name(input);
+                        if (!index.valid())
+                        {
+                            error("box '" + name + "' has no input '" + input + "'");
+                        }
+                        to.index = index.get();
+                    }
+                }
+
+                if (to.index >= declaration.inputs.size())
+                {
+                    error("box '" + name + "' has no such input");
+                }
+            }
+
+            expect(";");
+
+            model::connection connection;
+            connection.from = from;
+            connection.to = to;
+            model_->connections_.push_back(connection);
+        }
+
+        std::size_t find_box(const std::string& name) const
+        {
+            auto found = names_.find(name);
+            if (found == names_.end())
+            {
+                error("unknown box instance '" + name + "'");
+            }
+
+            return found->second;
+        }
+
+        std::istream& in_;
+        basic_object_factory* factory_;
+        std::string token_;
+        unsigned line_;
+        std::shared_ptr<model> model_;
+        std::map<std::string, std::size_t> names_;
+    };
+
+    // bobolang:
+    //==========================================================================
+
+    namespace bobolang
+    {
+
+        model_ptr_type compile(std::istream& in, basic_object_factory* factory)
+        {
+            bobolang_compiler compiler(in, factory);
+            return compiler.compile();
+        }
+
+    } // bobolang
+
+} // bobox
@@ -0,0 +1,113 @@
+/// \file bobox_bobolang.hpp File contains compiler of the Bobolang subset
+/// supported by the Bobox stand-in runtime.
+///
+/// Supported syntax:
+/// \code
+/// model main<()><()>
+/// {
+///     Type<(in_column, ...), ...><(out_column, ...), ...> name, ...;
+///     input -> name;
+///     name[output] -> [input]name;
+///     name[output] -> output;
+/// }
+/// \endcode
+/// Output index is numeric, input is either numeric or name of input declared
+/// by the box. Both default to 0.
+
+#ifndef BOBOPT_BENCHMARKS_BOBOX_STANDIN_BOBOX_BOBOLANG_HPP_GUARD_
+#define BOBOPT_BENCHMARKS_BOBOX_STANDIN_BOBOX_BOBOLANG_HPP_GUARD_
+
+#include <bobox_basic_box.hpp>
+#include <bobox_envelope.hpp>
+#include <bobox_types.hpp>
+
+#include <istream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace bobox
+{
+
+    class basic_object_factory;
+
+    // model:
+    //==========================================================================
+
+    /// \brief Compiled Bobolang model, list of box instances and connections.
+    class model
+    {
+    public:
+        /// \brief Single box instance.
+        struct box_declaration
+        {
+            std::string name;
+            box_model_ptr_type box_model;
+            std::vector<envelope_descriptor> inputs;
+            std::vector<envelope_descriptor> outputs;
+        };
+
+        /// \brief Endpoint of connection. Box \c EXTERNAL stands for model
+        /// input or output.
+        struct endpoint
+        {
+            static const std::size_t EXTERNAL = static_cast<std::size_t>(-1);
+
+            std::size_t box;
+            unsigned index;
+        };
+
+        /// \brief Connection of box output to box input.
+        struct connection
+        {
+            endpoint from;
+            endpoint to;
+        };
+
+        typedef std::vector<box_declaration> boxes_type;
+        typedef std::vector<connection> connections_type;
+
+        const boxes_type& get_boxes() const
+        {
+            return boxes_;
+        }
+
+        const connections_type& get_connections() const
+        {
+            return connections_;
+        }
+
+    private:
+        friend class bobolang_compiler;
+
+        boxes_type boxes_;
+        connections_type connections_;
+    };
+
+    typedef std::shared_ptr<const model> model_ptr_type;
+
+    /// \brief Error in Bobolang source.
+    class bobolang_error : public std::runtime_error
+    {
+    public:
+        explicit bobolang_error(const std::string& message)
+            : std::runtime_error("bobolang: " + message)
+        {
+        }
+    };
+
+    namespace bobolang
+    {
+
+        /// \brief Compile model from stream. Box models and types are looked
+        /// up in factory.
+        /// \throw bobolang_error Source is not valid.
+        model_ptr_type compile(std::istream& in, basic_object_factory* factory);
+
+    } // bobolang
+
+} // bobox
+
+#endif // guard
@@ -0,0 +1,71 @@
+/// \file bobox_box.hpp File contains definition of the base class of all boxes
+/// in the Bobox stand-in runtime.
+
+#ifndef BOBOPT_BENCHMARKS_BOBOX_STANDIN_BOBOX_BOX_HPP_GUARD_
+#define BOBOPT_BENCHMARKS_BOBOX_STANDIN_BOBOX_BOX_HPP_GUARD_
+
+#include <bobox_types.hpp>
+
+namespace bobox
+{
+
+    // forward declarations:
+    namespace detail
+    {
+        class box_node;
+    }
+
+    // box_parameters_pack:
+    //==========================================================================
+
+    /// \brief Opaque parameters passed by runtime to box constructor.
+    class box_parameters_pack
+    {
+    public:
+        explicit box_parameters_pack(detail::box_node* node)
+            : node_(node)
+        {
+        }
+
+        detail::box_node* get_node() const
+        {
+            return node_;
+        }
+
+    private:
+        detail::box_node* node_;
+    };
+
+    // box:
+    //==========================================================================
+
+    /// \brief Base class of all boxes. Handles only box initialization.
+    class box
+    {
+    public:
+        typedef bobox::input_index_type input_index_type;
+        typedef bobox::output_index_type output_index_type;
+        typedef bobox::column_index_type column_index_type;
+        typedef bobox::box_parameters_pack box_parameters_pack;
+
+        explicit box(const box_parameters_pack& box_params);
+        virtual ~box();
+
+        /// \brief Called by runtime once before the first execution.
+        void init();
+
+    protected:
+        virtual void init_impl();
+
+        detail::box_node& get_node() const;
+
+    private:
+        box(const box&);
+        box& operator=(const box&);
+
+        detail::box_node* node_;
+    };
+
+} // bobox
+
+#endif // guard
@@ -0,0 +1,51 @@
+/// \file bobox_column.hpp File contains definition of envelope column for the
+/// Bobox stand-in runtime.
+
+#ifndef BOBOPT_BENCHMARKS_BOBOX_STANDIN_BOBOX_COLUMN_HPP_GUARD_
+#define BOBOPT_BENCHMARKS_BOBOX_STANDIN_BOBOX_COLUMN_HPP_GUARD_
+
+#include <bobox_types.hpp>
+
+#include <cstddef>
+#include <memory>
+
+namespace bobox
+{
+
+    /// \brief Single column of envelope. Continuous memory for \c capacity
+    /// elements of the same size.
+    class column
+    {
+    public:
+        column(std::size_t element_size, std::size_t capacity)
+            : element_size_(element_size)
+            , data_(new char[(element_size * capacity) + 1])
+        {
+        }
+
+        /// \brief Typed access to column data.
+        template <typename T>
+        T* get_data() const
+        {
+            return static_cast<T*>(get_raw_data());
+        }
+
+        /// \brief Untyped access to column data.
+        void* get_raw_data() const
+        {
+            return data_.get();
+        }
+
+        std::size_t get_element_size() const
+        {
+            return element_size_;
+        }
+
+    private:
+        std::size_t element_size_;
+        std::unique_ptr<char[]> data_;
+    };
+
+} // bobox
+
+#endif // guard
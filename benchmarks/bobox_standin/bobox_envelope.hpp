@@ -0,0 +1,121 @@
+/// \file bobox_envelope.hpp File contains definition of envelope for the Bobox
+/// stand-in runtime.
+
+#ifndef BOBOPT_BENCHMARKS_BOBOX_STANDIN_BOBOX_ENVELOPE_HPP_GUARD_
+#define BOBOPT_BENCHMARKS_BOBOX_STANDIN_BOBOX_ENVELOPE_HPP_GUARD_
+
+#include <bobox_column.hpp>
+#include <bobox_types.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace bobox
+{
+
+    // envelope_descriptor:
+    //==========================================================================
+
+    /// \brief Layout of envelopes sent through single output. Holds size of
+    /// element for each column.
+    class envelope_descriptor
+    {
+    public:
+        typedef std::vector<std::size_t> columns_type;
+
+        envelope_descriptor()
+            : columns_()
+        {
+        }
+
+        explicit envelope_descriptor(columns_type columns)
+            : columns_(std::move(columns))
+        {
+        }
+
+        const columns_type& get_columns() const
+        {
+            return columns_;
+        }
+
+    private:
+        columns_type columns_;
+    };
+
+    // envelope:
+    //==========================================================================
+
+    /// \brief Unit of data passed between boxes. Poisoned envelope has no
+    /// columns and marks the end of stream.
+    class envelope
+    {
+    public:
+        envelope(const envelope_descriptor& descriptor, std::size_t capacity)
+            : poisoned_(false)
+            , size_(0)
+            , capacity_(capacity)
+            , columns_()
+        {
+            columns_.reserve(descriptor.get_columns().size());
+            for (auto element_size : descriptor.get_columns())
+            {
+                columns_.emplace_back(element_size, capacity);
+            }
+        }
+
+        /// \brief Create envelope that marks the end of stream.
+        static envelope* create_poisoned()
+        {
+            envelope* result = new envelope(envelope_descriptor(), 0);
+            result->poisoned_ = true;
+            return result;
+        }
+
+        bool is_poisoned() const
+        {
+            return poisoned_;
+        }
+
+        std::size_t get_size() const
+        {
+            return size_;
+        }
+
+        void set_size(std::size_t size)
+        {
+            BOBOX_ASSERT(size <= capacity_);
+            size_ = size;
+        }
+
+        std::size_t get_capacity() const
+        {
+            return capacity_;
+        }
+
+        std::size_t get_columns_count() const
+        {
+            return columns_.size();
+        }
+
+        const column& get_column(column_index_type index) const
+        {
+            BOBOX_ASSERT(index.get() < columns_.size());
+            return columns_[index.get()];
+        }
+
+    private:
+        envelope(const envelope&);
+        envelope& operator=(const envelope&);
+
+        bool poisoned_;
+        std::size_t size_;
+        std::size_t capacity_;
+        std::vector<column> columns_;
+    };
+
+    typedef std::shared_ptr<envelope> envelope_ptr_type;
+
+} // bobox
+
+#endif // guard
@@ -0,0 +1,146 @@
+#include <bobox_fiber.hpp>
+
+#include <bobox_types.hpp>
+
+#include <cstdint>
+#include <cstdlib>
+
+#if defined(_WIN32)
+#   include <windows.h>
+#else
+#   include <ucontext.h>
+#endif
+
+namespace bobox
+{
+    namespace detail
+    {
+
+#if defined(_WIN32)
+
+        // Windows fibers.
+        //======================================================================
+
+        struct fiber::impl
+        {
+            static VOID CALLBACK start(LPVOID parameter)
+            {
+                fiber* self = static_cast<fiber*>(parameter);
+                self->entry_(self->argument_);
+                BOBOX_ASSERT(false && "fiber entry returned");
+                std::abort();
+            }
+
+            LPVOID handle;
+            LPVOID caller;
+        };
+
+        fiber::thread_scope::thread_scope()
+        {
+            ConvertThreadToFiber(nullptr);
+        }
+
+        fiber::thread_scope::~thread_scope()
+        {
+            ConvertFiberToThread();
+        }
+
+        fiber::fiber(entry_type entry, void* argument, std::size_t stack_size)
+            : entry_(entry)
+            , argument_(argument)
+            , impl_(new impl)
+        {
+            impl_->handle = CreateFiber(stack_size, &impl::start, this);
+            impl_->caller = nullptr;
+            if (impl_->handle == nullptr)
+            {
+                std::abort();
+            }
+        }
+
+        fiber::~fiber()
+        {
+            DeleteFiber(impl_->handle);
+        }
+
+        void fiber::resume()
+        {
+            impl_->caller = GetCurrentFiber();
+            SwitchToFiber(impl_->handle);
+        }
+
+        void fiber::suspend()
+        {
+            SwitchToFiber(impl_->caller);
+        }
+
+#else
+
+        // POSIX ucontext.
+        //======================================================================
+
+        struct fiber::impl
+        {
+            /// makecontext passes only int arguments, pointer is split in two.
+            static void start(unsigned int high, unsigned int low)
+            {
+                const std::uintptr_t address = (static_cast<std::uintptr_t>(high) << 16 << 16) | static_cast<std::uintptr_t>(low);
+                fiber* self = reinterpret_cast<fiber*>(address);
+                self->entry_(self->argument_);
+                BOBOX_ASSERT(false && "fiber entry returned");
+                std::abort();
+            }
+
+            ucontext_t context;
+            ucontext_t caller;
+            std::unique_ptr<char[]> stack;
+        };
+
+        fiber::thread_scope::thread_scope()
+        {
+        }
+
+        fiber::thread_scope::~thread_scope()
+        {
+        }
+
+        fiber::fiber(entry_type entry, void* argument, std::size_t stack_size)
+            : entry_(entry)
+            , argument_(argument)
+            , impl_(new impl)
+        {
+            impl_->stack.reset(new char[stack_size]);
+
+            if (getcontext(&impl_->context) != 0)
+            {
+                std::abort();
+            }
+
+            impl_->context.uc_stack.ss_sp = impl_->stack.get();
+            impl_->context.uc_stack.ss_size = stack_size;
+            impl_->context.uc_link = nullptr;
+
+            const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(this);
+            const unsigned int high = static_cast<unsigned int>(address >> 16 >> 16);
+            const unsigned int low = static_cast<unsigned int>(address & 0xffffffffu);
+            makecontext(&impl_->context, reinterpret_cast<void (*)()>(&impl::start), 2, high, low);
+        }
+
+        fiber::~fiber()
+        {
+        }
+
+        void fiber::resume()
+        {
+            swapcontext(&impl_->caller, &impl_->context);
+        }
+
+        void fiber::suspend()
+        {
+            swapcontext(&impl_->context, &impl_->caller);
+        }
+
+#endif
+
+    } // detail
+} // bobox
@@ -0,0 +1,65 @@
+/// \file bobox_fiber.hpp File contains definition of fiber used to execute box
+/// bodies in the Bobox stand-in runtime.
+
+#ifndef BOBOPT_BENCHMARKS_BOBOX_STANDIN_BOBOX_FIBER_HPP_GUARD_
+#define BOBOPT_BENCHMARKS_BOBOX_STANDIN_BOBOX_FIBER_HPP_GUARD_
+
+#include <cstddef>
+#include <memory>
+
+namespace bobox
+{
+    namespace detail
+    {
+
+        /// \brief Cooperative execution context with its own stack.
+        ///
+        /// Fiber is resumed by worker thread and runs until it suspends
+        /// itself. Fiber can be resumed by different thread than the one which
+        /// resumed it before. Entry function must never return.
+        class fiber
+        {
+        public:
+            typedef void (*entry_type)(void* argument);
+
+            /// \brief Converts worker thread to be able to resume fibers.
+            class thread_scope
+            {
+            public:
+                thread_scope();
+                ~thread_scope();
+
+            private:
+                thread_scope(const thread_scope&);
+                thread_scope& operator=(const thread_scope&);
+            };
+
+            static const std::size_t DEFAULT_STACK_SIZE = 256u * 1024u;
+
+            fiber(entry_type entry, void* argument, std::size_t stack_size = DEFAULT_STACK_SIZE);
+            ~fiber();
+
+            /// \brief Switch from calling thread to fiber.
+            void resume();
+
+            /// \brief Switch from fiber back to the thread which resumed it.
+            /// Must be called from fiber itself.
+            void suspend();
+
+        private:
+            fiber(const fiber&);
+            fiber& operator=(const fiber&);
+
+            struct impl;
+
+            entry_type entry_;
+            void* argument_;
+            std::unique_ptr<impl> impl_;
+
+            friend struct impl;
+        };
+
+    } // detail
+} // bobox
+
+#endif // guard
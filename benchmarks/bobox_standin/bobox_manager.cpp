@@ -0,0 +1,71 @@
+#include <bobox_manager.hpp>
+
+#include <stdexcept>
+
+namespace bobox
+{
+
+    manager::manager(const parameters_ptr_type& parameters)
+        : threads_count_(1)
+        , next_id_(1)
+        , requests_()
+    {
+        if (parameters && parameters->get_parameter("SchedulingStrategy", SS_SINGLE_THREADED) == SS_SMP)
+        {
+            threads_count_ = static_cast<unsigned>(parameters->get_parameter("OptimalPlevel", 1));
+        }
+
+        if (threads_count_ == 0)
+        {
+            threads_count_ = 1;
+        }
+    }
+
+    manager::~manager()
+    {
+    }
+
+    request_id_type manager::create_request(const model_ptr_type& request_model)
+    {
+        request_id_type rqid = next_id_++;
+        requests_[rqid].reset(new detail::request(request_model, threads_count_));
+        return rqid;
+    }
+
+    void manager::run_request(request_id_type rqid)
+    {
+        find_request(rqid).run();
+    }
+
+    void manager::wait_on_request(request_id_type rqid)
+    {
+        find_request(rqid).wait();
+    }
+
+    request_result_type manager::get_result(request_id_type rqid) const
+    {
+        return find_request(rqid).get_result();
+    }
+
+    void manager::destroy_request(request_id_type rqid)
+    {
+        requests_.erase(rqid);
+    }
+
+    statistics manager::get_statistics(request_id_type rqid) const
+    {
+        return find_request(rqid).get_statistics();
+    }
+
+    detail::request& manager::find_request(request_id_type rqid) const
+    {
+        auto found = requests_.find(rqid);
+        if (found == requests_.end())
+        {
+            throw std::out_of_range("bobox: unknown request");
+        }
+
+        return *found->second;
+    }
+
+} // bobox
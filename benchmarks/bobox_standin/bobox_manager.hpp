@@ -0,0 +1,54 @@
+/// \file bobox_manager.hpp File contains definition of manager in the Bobox
+/// stand-in runtime.
+
+#ifndef BOBOPT_BENCHMARKS_BOBOX_STANDIN_BOBOX_MANAGER_HPP_GUARD_
+#define BOBOPT_BENCHMARKS_BOBOX_STANDIN_BOBOX_MANAGER_HPP_GUARD_
+
+#include <bobox_bobolang.hpp>
+#include <bobox_parameters.hpp>
+#include <bobox_request.hpp>
+#include <bobox_results.hpp>
+#include <bobox_types.hpp>
+
+#include <map>
+#include <memory>
+
+namespace bobox
+{
+
+    /// \brief Manager creates and executes requests.
+    ///
+    /// Recognized parameters:
+    /// - \c SchedulingStrategy: \c SS_SINGLE_THREADED runs one worker,
+    ///   \c SS_SMP runs \c OptimalPlevel workers.
+    /// - \c OptimalPlevel: number of workers for \c SS_SMP (default 1).
+    /// - \c BackupThreads: accepted and ignored.
+    class manager
+    {
+    public:
+        explicit manager(const parameters_ptr_type& parameters);
+        ~manager();
+
+        request_id_type create_request(const model_ptr_type& request_model);
+        void run_request(request_id_type rqid);
+        void wait_on_request(request_id_type rqid);
+        request_result_type get_result(request_id_type rqid) const;
+        void destroy_request(request_id_type rqid);
+
+        /// \brief Scheduling counters of request, stand-in extension.
+        statistics get_statistics(request_id_type rqid) const;
+
+    private:
+        manager(const manager&);
+        manager& operator=(const manager&);
+
+        detail::request& find_request(request_id_type rqid) const;
+
+        unsigned threads_count_;
+        request_id_type next_id_;
+        std::map<request_id_type, std::unique_ptr<detail::request>> requests_;
+    };
+
+} // bobox
+
+#endif // guard
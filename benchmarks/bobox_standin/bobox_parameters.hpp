@@ -0,0 +1,46 @@
+/// \file bobox_parameters.hpp File contains definition of manager parameters
+/// in the Bobox stand-in runtime.
+
+#ifndef BOBOPT_BENCHMARKS_BOBOX_STANDIN_BOBOX_PARAMETERS_HPP_GUARD_
+#define BOBOPT_BENCHMARKS_BOBOX_STANDIN_BOBOX_PARAMETERS_HPP_GUARD_
+
+#include <bobox_types.hpp>
+
+#include <map>
+#include <memory>
+#include <string>
+
+namespace bobox
+{
+
+    /// \brief Named numeric parameters. All values used by benchmarks are
+    /// enumerations or unsigned integers.
+    class basic_parameters
+    {
+    public:
+        template <typename T>
+        void add_parameter(const std::string& name, T value)
+        {
+            values_[name] = static_cast<unsigned long long>(value);
+        }
+
+        unsigned long long get_parameter(const std::string& name, unsigned long long default_value) const
+        {
+            auto found = values_.find(name);
+            if (found == values_.end())
+            {
+                return default_value;
+            }
+
+            return found->second;
+        }
+
+    private:
+        std::map<std::string, unsigned long long> values_;
+    };
+
+    typedef std::shared_ptr<basic_parameters> parameters_ptr_type;
+
+} // bobox
+
+#endif // guard
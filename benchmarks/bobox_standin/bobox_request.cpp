@@ -0,0 +1,401 @@
+#include <bobox_request.hpp>
+
+#include <exception>
+
+namespace bobox
+{
+    namespace detail
+    {
+
+        // box_node implementation.
+        //======================================================================
+
+        box_node::box_node(request& owner, const model::box_declaration& declaration)
+            : request_(owner)
+            , inputs_(declaration.inputs.size())
+            , outputs_(declaration.outputs.size())
+            , box_()
+            , fiber_(&box_node::fiber_entry, this)
+            , state_(NS_IDLE)
+            , reason_(SR_FINISHED)
+            , waiting_input_(0)
+        {
+            for (std::size_t i = 0; i < outputs_.size(); ++i)
+            {
+                outputs_[i].descriptor = declaration.outputs[i];
+            }
+
+            box_.reset(declaration.box_model->create(box_parameters_pack(this)));
+        }
+
+        box_node::~box_node()
+        {
+        }
+
+        void box_node::connect(unsigned output, box_node* target, unsigned input)
+        {
+            BOBOX_ASSERT(output < outputs_.size());
+
+            output_slot& slot = outputs_[output];
+            slot.target = target;
+            slot.input = input;
+            slot.connected = true;
+        }
+
+        void box_node::init()
+        {
+            box_->init();
+        }
+
+        void box_node::prefetch(unsigned input)
+        {
+            BOBOX_ASSERT(input < inputs_.size());
+
+            std::lock_guard<std::mutex> lock(request_.get_mutex());
+            inputs_[input].requested = true;
+        }
+
+        envelope_ptr_type box_node::pop(unsigned input)
+        {
+            BOBOX_ASSERT(input < inputs_.size());
+
+            for (;;)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(request_.get_mutex());
+
+                    input_slot& slot = inputs_[input];
+                    if (!slot.envelopes.empty())
+                    {
+                        envelope_ptr_type result = std::move(slot.envelopes.front());
+                        slot.envelopes.pop_front();
+                        slot.requested = false;
+                        return result;
+                    }
+
+                    slot.requested = true;
+                    waiting_input_ = input;
+                    ++request_.get_statistics_locked().waits;
+                }
+
+                suspend(SR_WAITING);
+            }
+        }
+
+        void box_node::send(unsigned output, envelope_ptr_type envelope)
+        {
+            BOBOX_ASSERT(output < outputs_.size());
+
+            std::lock_guard<std::mutex> lock(request_.get_mutex());
+            ++request_.get_statistics_locked().envelopes;
+
+            const output_slot& slot = outputs_[output];
+            if (!slot.connected)
+            {
+                return;
+            }
+
+            if (slot.target == nullptr)
+            {
+                request_.deliver_output(std::move(envelope));
+            }
+            else
+            {
+                slot.target->deliver(slot.input, std::move(envelope));
+            }
+        }
+
+        void box_node::yield()
+        {
+            {
+                std::lock_guard<std::mutex> lock(request_.get_mutex());
+                ++request_.get_statistics_locked().yields;
+            }
+
+            suspend(SR_YIELDED);
+        }
+
+        const envelope_descriptor& box_node::get_output_descriptor(unsigned output) const
+        {
+            BOBOX_ASSERT(output < outputs_.size());
+            return outputs_[output].descriptor;
+        }
+
+        void box_node::deliver(unsigned input, envelope_ptr_type envelope)
+        {
+            BOBOX_ASSERT(input < inputs_.size());
+            inputs_[input].envelopes.push_back(std::move(envelope));
+
+            if ((state_ == NS_IDLE && ready_to_start()) || (state_ == NS_WAITING && waiting_input_ == input))
+            {
+                schedule();
+            }
+        }
+
+        void box_node::after_run()
+        {
+            switch (reason_)
+            {
+            case SR_FINISHED:
+                ++request_.get_statistics_locked().bodies;
+                state_ = NS_IDLE;
+                if (ready_to_start())
+                {
+                    schedule();
+                }
+                break;
+
+            case SR_WAITING:
+                if (inputs_[waiting_input_].envelopes.empty())
+                {
+                    state_ = NS_WAITING;
+                }
+                else
+                {
+                    schedule();
+                }
+                break;
+
+            case SR_YIELDED:
+                schedule();
+                break;
+
+            default:
+                BOBOX_ASSERT(false);
+                break;
+            }
+        }
+
+        void box_node::run()
+        {
+            fiber_.resume();
+        }
+
+        void box_node::fiber_entry(void* argument)
+        {
+            static_cast<box_node*>(argument)->fiber_main();
+        }
+
+        void box_node::fiber_main()
+        {
+            for (;;)
+            {
+                try
+                {
+                    box_->sync_mach_etwas();
+                }
+                catch (...)
+                {
+                    request_.report_error();
+                }
+
+                suspend(SR_FINISHED);
+            }
+        }
+
+        void box_node::suspend(suspend_reasons reason)
+        {
+            reason_ = reason;
+            fiber_.suspend();
+        }
+
+        /// Box is started when all requested inputs hold an envelope. Empty
+        /// box is never started, there would be nothing to process.
+        bool box_node::ready_to_start() const
+        {
+            bool any = false;
+            for (const auto& slot : inputs_)
+            {
+                if (slot.envelopes.empty())
+                {
+                    if (slot.requested)
+                    {
+                        return false;
+                    }
+                }
+                else
+                {
+                    any = true;
+                }
+            }
+
+            return any;
+        }
+
+        void box_node::schedule()
+        {
+            state_ = NS_SCHEDULED;
+            request_.enqueue(this);
+        }
+
+        // request implementation.
+        //======================================================================
+
+        request::request(const model_ptr_type& request_model, unsigned threads_count)
+            : model_(request_model)
+            , nodes_()
+            , threads_count_((threads_count == 0) ? 1 : threads_count)
+            , threads_()
+            , mutex_()
+            , condition_()
+            , ready_()
+            , running_(0)
+            , output_poisoned_(false)
+            , failed_(false)
+            , statistics_()
+        {
+            for (const auto& declaration : model_->get_boxes())
+            {
+                nodes_.emplace_back(new box_node(*this, declaration));
+            }
+
+            for (const auto& connection : model_->get_connections())
+            {
+                if (connection.from.box == model::endpoint::EXTERNAL)
+                {
+                    continue;
+                }
+
+                box_node* target = (connection.to.box == model::endpoint::EXTERNAL) ? nullptr : nodes_[connection.to.box].get();
+                nodes_[connection.from.box]->connect(connection.from.index, target, connection.to.index);
+            }
+        }
+
+        request::~request()
+        {
+            wait();
+        }
+
+        void request::run()
+        {
+            for (auto& node : nodes_)
+            {
+                node->init();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                for (const auto& connection : model_->get_connections())
+                {
+                    if (connection.from.box != model::endpoint::EXTERNAL)
+                    {
+                        continue;
+                    }
+
+                    envelope_ptr_type poisoned(envelope::create_poisoned());
+                    if (connection.to.box == model::endpoint::EXTERNAL)
+                    {
+                        deliver_output(std::move(poisoned));
+                    }
+                    else
+                    {
+                        nodes_[connection.to.box]->deliver(connection.to.index, std::move(poisoned));
+                    }
+                }
+            }
+
+            for (unsigned i = 0; i < threads_count_; ++i)
+            {
+                threads_.emplace_back(&request::worker, this);
+            }
+        }
+
+        void request::wait()
+        {
+            for (auto& thread : threads_)
+            {
+                thread.join();
+            }
+
+            threads_.clear();
+        }
+
+        request_result_type request::get_result() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            if (failed_)
+            {
+                return RRT_ERROR;
+            }
+
+            return output_poisoned_ ? RRT_OK : RRT_DEADLOCK;
+        }
+
+        statistics request::get_statistics() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return statistics_;
+        }
+
+        std::mutex& request::get_mutex()
+        {
+            return mutex_;
+        }
+
+        statistics& request::get_statistics_locked()
+        {
+            return statistics_;
+        }
+
+        void request::enqueue(box_node* node)
+        {
+            ready_.push_back(node);
+            condition_.notify_one();
+        }
+
+        void request::deliver_output(envelope_ptr_type envelope)
+        {
+            if (envelope->is_poisoned())
+            {
+                output_poisoned_ = true;
+            }
+        }
+
+        void request::report_error()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            failed_ = true;
+        }
+
+        /// Workers exit when there is nothing to schedule and no node is
+        /// running, i.e. the model either finished or deadlocked.
+        void request::worker()
+        {
+            fiber::thread_scope scope;
+
+            std::unique_lock<std::mutex> lock(mutex_);
+            for (;;)
+            {
+                while (ready_.empty() && running_ != 0)
+                {
+                    condition_.wait(lock);
+                }
+
+                if (ready_.empty())
+                {
+                    condition_.notify_all();
+                    return;
+                }
+
+                box_node* node = ready_.front();
+                ready_.pop_front();
+                ++running_;
+                ++statistics_.tasks;
+
+                lock.unlock();
+                node->run();
+                lock.lock();
+
+                --running_;
+                node->after_run();
+
+                if (ready_.empty() && running_ == 0)
+                {
+                    condition_.notify_all();
+                }
+            }
+        }
+
+    } // detail
+} // bobox
@@ -0,0 +1,199 @@
+/// \file bobox_request.hpp File contains definition of request execution in
+/// the Bobox stand-in runtime.
+///
+/// Request owns one node for each box instance of the model. Nodes are
+/// scheduled by worker threads from a single ready queue protected by a
+/// single mutex. Box body runs in fiber of its node, so \c pop_envelope() on
+/// empty input and \c yield() suspend only the body, not the worker thread.
+
+#ifndef BOBOPT_BENCHMARKS_BOBOX_STANDIN_BOBOX_REQUEST_HPP_GUARD_
+#define BOBOPT_BENCHMARKS_BOBOX_STANDIN_BOBOX_REQUEST_HPP_GUARD_
+
+#include <bobox_basic_box.hpp>
+#include <bobox_bobolang.hpp>
+#include <bobox_envelope.hpp>
+#include <bobox_fiber.hpp>
+#include <bobox_results.hpp>
+#include <bobox_types.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bobox
+{
+
+    // statistics:
+    //==========================================================================
+
+    /// \brief Scheduling counters of single request. Not part of the Bobox
+    /// API, available only when \c BOBOX_STANDIN is defined.
+    struct statistics
+    {
+        statistics()
+            : tasks(0)
+            , bodies(0)
+            , waits(0)
+            , yields(0)
+            , envelopes(0)
+        {
+        }
+
+        /// Number of fiber resumes by workers.
+        unsigned long long tasks;
+        /// Number of finished box bodies.
+        unsigned long long bodies;
+        /// Number of suspensions on empty input.
+        unsigned long long waits;
+        /// Number of calls of \c yield().
+        unsigned long long yields;
+        /// Number of sent envelopes, including poisoned.
+        unsigned long long envelopes;
+    };
+
+    namespace detail
+    {
+
+        class request;
+
+        // box_node:
+        //======================================================================
+
+        /// \brief Runtime state of single box instance.
+        class box_node
+        {
+        public:
+            box_node(request& owner, const model::box_declaration& declaration);
+            ~box_node();
+
+            // wiring (before run):
+            void connect(unsigned output, box_node* target, unsigned input);
+            void init();
+
+            // called by box body from fiber:
+            void prefetch(unsigned input);
+            envelope_ptr_type pop(unsigned input);
+            void send(unsigned output, envelope_ptr_type envelope);
+            void yield();
+            const envelope_descriptor& get_output_descriptor(unsigned output) const;
+
+            // called by scheduler, request lock must be held:
+            void deliver(unsigned input, envelope_ptr_type envelope);
+            void after_run();
+
+            // called by scheduler without lock:
+            void run();
+
+        private:
+            /// Node stays scheduled while it runs, deliveries to running node
+            /// are handled in \c after_run().
+            enum states
+            {
+                NS_IDLE,
+                NS_SCHEDULED,
+                NS_WAITING
+            };
+
+            enum suspend_reasons
+            {
+                SR_FINISHED,
+                SR_WAITING,
+                SR_YIELDED
+            };
+
+            struct input_slot
+            {
+                input_slot()
+                    : envelopes()
+                    , requested(false)
+                {
+                }
+
+                std::deque<envelope_ptr_type> envelopes;
+                bool requested;
+            };
+
+            struct output_slot
+            {
+                output_slot()
+                    : descriptor()
+                    , target(nullptr)
+                    , input(0)
+                    , connected(false)
+                {
+                }
+
+                envelope_descriptor descriptor;
+                box_node* target;
+                unsigned input;
+                bool connected;
+            };
+
+            static void fiber_entry(void* argument);
+            void fiber_main();
+            void suspend(suspend_reasons reason);
+
+            bool ready_to_start() const;
+            void schedule();
+
+            request& request_;
+            std::vector<input_slot> inputs_;
+            std::vector<output_slot> outputs_;
+            std::unique_ptr<basic_box> box_;
+            fiber fiber_;
+            states state_;
+            suspend_reasons reason_;
+            unsigned waiting_input_;
+        };
+
+        // request:
+        //======================================================================
+
+        /// \brief Single execution of model.
+        class request
+        {
+        public:
+            request(const model_ptr_type& request_model, unsigned threads_count);
+            ~request();
+
+            void run();
+            void wait();
+
+            request_result_type get_result() const;
+            statistics get_statistics() const;
+
+            // used by nodes:
+            std::mutex& get_mutex();
+            statistics& get_statistics_locked();
+            void enqueue(box_node* node);
+            void deliver_output(envelope_ptr_type envelope);
+            void report_error();
+
+        private:
+            request(const request&);
+            request& operator=(const request&);
+
+            void worker();
+
+            model_ptr_type model_;
+            std::vector<std::unique_ptr<box_node>> nodes_;
+            unsigned threads_count_;
+            std::vector<std::thread> threads_;
+
+            mutable std::mutex mutex_;
+            std::condition_variable condition_;
+            std::deque<box_node*> ready_;
+            unsigned running_;
+            bool output_poisoned_;
+            bool failed_;
+            statistics statistics_;
+        };
+
+    } // detail
+
+} // bobox
+
+#endif // guard
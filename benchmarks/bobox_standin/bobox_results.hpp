@@ -0,0 +1,23 @@
+/// \file bobox_results.hpp File contains definition of request results in the
+/// Bobox stand-in runtime.
+
+#ifndef BOBOPT_BENCHMARKS_BOBOX_STANDIN_BOBOX_RESULTS_HPP_GUARD_
+#define BOBOPT_BENCHMARKS_BOBOX_STANDIN_BOBOX_RESULTS_HPP_GUARD_
+
+namespace bobox
+{
+
+    /// \brief Result of finished request.
+    enum request_result_type
+    {
+        RRT_OK,
+        RRT_ERROR,
+        RRT_CANCELED,
+        RRT_DEADLOCK,
+        RRT_MEMORY,
+        RRT_TIMEOUT
+    };
+
+} // bobox
+
+#endif // guard
@@ -0,0 +1,32 @@
+/// \file bobox_runtime.hpp File contains definition of runtime in the Bobox
+/// stand-in runtime.
+
+#ifndef BOBOPT_BENCHMARKS_BOBOX_STANDIN_BOBOX_RUNTIME_HPP_GUARD_
+#define BOBOPT_BENCHMARKS_BOBOX_STANDIN_BOBOX_RUNTIME_HPP_GUARD_
+
+#include <bobox_types.hpp>
+
+namespace bobox
+{
+
+    /// \brief Runtime is initialized by client, usually registration of box
+    /// models and types happens in \c init_impl().
+    class runtime
+    {
+    public:
+        virtual ~runtime()
+        {
+        }
+
+        void init()
+        {
+            init_impl();
+        }
+
+    protected:
+        virtual void init_impl() = 0;
+    };
+
+} // bobox
+
+#endif // guard
@@ -0,0 +1,167 @@
+/// \file bobox_types.hpp File contains basic types of the Bobox stand-in
+/// runtime.
+///
+/// The stand-in runtime implements only the subset of the Bobox framework API
+/// used by the benchmarks. It allows to build and run benchmarks, optimized
+/// and unoptimized, on any machine without Bobox, ulibpp and numa libraries.
+
+#ifndef BOBOPT_BENCHMARKS_BOBOX_STANDIN_BOBOX_TYPES_HPP_GUARD_
+#define BOBOPT_BENCHMARKS_BOBOX_STANDIN_BOBOX_TYPES_HPP_GUARD_
+
+#include <cassert>
+#include <string>
+#include <utility>
+
+/// \def BOBOX_STANDIN
+/// Defined when code is compiled against the stand-in runtime.
+#define BOBOX_STANDIN 1
+
+/// \def BOBOX_OVERRIDE
+/// Replacement for C++11 \c override.
+#define BOBOX_OVERRIDE override
+
+/// \def BOBOX_ASSERT
+/// Expression is evaluated even in release builds, benchmarks pop envelopes
+/// inside of assertions.
+#if defined(BOBOX_DEBUG)
+#   define BOBOX_ASSERT(condition) assert(condition)
+#else
+#   define BOBOX_ASSERT(condition) (void)(condition)
+#endif
+
+namespace bobox
+{
+
+    // generic_distinctizer:
+    //==========================================================================
+
+    /// \brief Strongly typed index. Tag distinguishes inputs, outputs and
+    /// columns so they can't be mixed up.
+    template <typename Tag>
+    class generic_distinctizer
+    {
+    public:
+        typedef unsigned value_type;
+
+        generic_distinctizer()
+            : value_(invalid_value())
+        {
+        }
+
+        explicit generic_distinctizer(value_type value)
+            : value_(value)
+        {
+        }
+
+        value_type get() const
+        {
+            return value_;
+        }
+
+        bool valid() const
+        {
+            return (value_ != invalid_value());
+        }
+
+        bool operator==(const generic_distinctizer& rhs) const
+        {
+            return (value_ == rhs.value_);
+        }
+
+        bool operator!=(const generic_distinctizer& rhs) const
+        {
+            return (value_ != rhs.value_);
+        }
+
+        bool operator<(const generic_distinctizer& rhs) const
+        {
+            return (value_ < rhs.value_);
+        }
+
+        static value_type invalid_value()
+        {
+            return static_cast<value_type>(-1);
+        }
+
+    private:
+        value_type value_;
+    };
+
+    struct input_tag
+    {
+    };
+
+    struct output_tag
+    {
+    };
+
+    struct column_tag
+    {
+    };
+
+    typedef generic_distinctizer<input_tag> input_index_type;
+    typedef generic_distinctizer<output_tag> output_index_type;
+    typedef generic_distinctizer<column_tag> column_index_type;
+
+    // generic_tid:
+    //==========================================================================
+
+    /// \brief Strongly typed textual identifier used for registration of
+    /// box models and types in object factory.
+    template <typename Tag>
+    class generic_tid
+    {
+    public:
+        explicit generic_tid(std::string name)
+            : name_(std::move(name))
+        {
+        }
+
+        const std::string& get() const
+        {
+            return name_;
+        }
+
+        bool operator<(const generic_tid& rhs) const
+        {
+            return (name_ < rhs.name_);
+        }
+
+    private:
+        std::string name_;
+    };
+
+    struct box_model_tag
+    {
+    };
+
+    struct type_tag
+    {
+    };
+
+    typedef generic_tid<box_model_tag> box_model_tid_type;
+    typedef generic_tid<type_tag> type_tid_type;
+
+    // Plain types.
+    //==========================================================================
+
+    typedef unsigned plevel_type;
+    typedef unsigned long request_id_type;
+
+    /// \brief State of box between executions.
+    enum box_state_type
+    {
+        BST_STATEFUL,
+        BST_STATELESS
+    };
+
+    /// \brief Scheduling strategy of manager.
+    enum scheduling_strategy_type
+    {
+        SS_SINGLE_THREADED,
+        SS_SMP
+    };
+
+} // bobox
+
+#endif // guard
@@ -0,0 +1,59 @@
+# Self-benchmark of the optimizer over synthetic corpora.
+#
+# Variables:
+#   GENERATOR - Path to bobopt_gen_corpus.
+#   BOBOPT - Path to bobopt.
+#   OUTPUT_DIR - Directory for generated corpora and statistics.
+#   INCLUDE_DIRS - Include directories for compilation database.
+#   CONFIGS - List of corpus configurations "files:boxes:inputs:loops:branches".
+#   GEN_COMPILE_COMMANDS - Path to gen_compile_commands.cmake.
+#
+# Each configuration is generated into its own directory and optimized in
+# build mode. Statistics of bobopt (time and peak RSS per phase and method)
+# are saved to stats.json in that directory.
+
+separate_arguments(CONFIGS)
+
+foreach (config ${CONFIGS})
+	string(REPLACE ":" ";" values ${config})
+	list(LENGTH values values_count)
+	if (NOT values_count EQUAL 5)
+		message(FATAL_ERROR "Invalid corpus configuration: ${config}")
+	endif ()
+
+	list(GET values 0 files)
+	list(GET values 1 boxes)
+	list(GET values 2 inputs)
+	list(GET values 3 loops)
+	list(GET values 4 branches)
+
+	set(corpus_DIR ${OUTPUT_DIR}/f${files}_b${boxes}_i${inputs}_l${loops}_br${branches})
+	file(REMOVE_RECURSE ${corpus_DIR})
+	file(MAKE_DIRECTORY ${corpus_DIR})
+
+	execute_process(COMMAND ${GENERATOR} -output=${corpus_DIR} -files=${files} -boxes=${boxes} -inputs=${inputs} -loops=${loops} -branches=${branches}
+		RESULT_VARIABLE generator_RESULT)
+	if (NOT generator_RESULT EQUAL 0)
+		message(FATAL_ERROR "Failed to generate corpus ${config}")
+	endif ()
+
+	file(GLOB corpus_SOURCES ${corpus_DIR}/*.cpp)
+
+	# compilation database
+	set(OPTIMIZED_DIR ${corpus_DIR})
+	set(OPTIMIZED_SOURCES ${corpus_SOURCES})
+	set(COMPILATION_DATABASE ${corpus_DIR}/compile_commands.json)
+	include(${GEN_COMPILE_COMMANDS})
+
+	set(stats_FILE ${corpus_DIR}/stats.json)
+	file(REMOVE ${stats_FILE})
+	execute_process(COMMAND ${BOBOPT} -build -stats-file=${stats_FILE} ${corpus_SOURCES}
+		WORKING_DIRECTORY ${corpus_DIR}
+		RESULT_VARIABLE bobopt_RESULT)
+	if (NOT bobopt_RESULT EQUAL 0 OR NOT EXISTS ${stats_FILE})
+		message(FATAL_ERROR "bobopt failed on corpus ${config}")
+	endif ()
+
+	file(READ ${stats_FILE} stats)
+	message(STATUS "Corpus ${config} (files:boxes:inputs:loops:branches):\n${stats}")
+endforeach ()
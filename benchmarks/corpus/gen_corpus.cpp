@@ -0,0 +1,241 @@
+/// \file gen_corpus.cpp Generator of synthetic box sources to measure how the
+/// optimizer scales.
+///
+/// Usage: bobopt_gen_corpus -output=<dir> [-files=<n>] [-boxes=<n>]
+///        [-inputs=<n>] [-loops=<n>] [-branches=<n>]
+///
+/// Generates files corpus_<i>.cpp into output directory. Every file contains
+/// \c boxes boxes with \c inputs inputs, body of each box has \c loops nested
+/// loops with \c branches branches in the innermost loop. Sources include only
+/// headers of the Bobox stand-in runtime, so they parse without Bobox.
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace bobopt
+{
+
+    /// \brief Parameters of generated corpus.
+    struct corpus_options
+    {
+        corpus_options()
+            : output()
+            , files(1)
+            , boxes(1)
+            , inputs(1)
+            , loops(1)
+            , branches(1)
+        {
+        }
+
+        std::string output;
+        unsigned files;
+        unsigned boxes;
+        unsigned inputs;
+        unsigned loops;
+        unsigned branches;
+    };
+
+    /// Input lists are limited by Bobox macros.
+    static const unsigned MAX_INPUTS = 12u;
+
+    static bool parse_unsigned(const char* arg, const char* name, unsigned& value)
+    {
+        const std::size_t length = std::strlen(name);
+        if ((std::strncmp(arg, name, length) != 0) || (arg[length] != '='))
+        {
+            return false;
+        }
+
+        char* end = nullptr;
+        value = static_cast<unsigned>(std::strtoul(arg + length + 1, &end, 10));
+        return (end != arg + length + 1) && (*end == '\0');
+    }
+
+    static bool parse_options(int argc, char* argv[], corpus_options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const char* arg = argv[i];
+            if (std::strncmp(arg, "-output=", 8) == 0)
+            {
+                options.output = arg + 8;
+            }
+            else if (!parse_unsigned(arg, "-files", options.files) && !parse_unsigned(arg, "-boxes", options.boxes) &&
+                     !parse_unsigned(arg, "-inputs", options.inputs) && !parse_unsigned(arg, "-loops", options.loops) &&
+                     !parse_unsigned(arg, "-branches", options.branches))
+            {
+                std::cerr << "invalid option: " << arg << std::endl;
+                return false;
+            }
+        }
+
+        if (options.output.empty())
+        {
+            std::cerr << "missing -output=<dir>" << std::endl;
+            return false;
+        }
+
+        if ((options.inputs == 0) || (options.inputs > MAX_INPUTS))
+        {
+            std::cerr << "number of inputs must be in range 1-" << MAX_INPUTS << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    static std::string indent(unsigned level)
+    {
+        return std::string(4 * level, ' ');
+    }
+
+    /// \brief Write innermost loop body, chain of if-else branches.
+    static void write_branches(std::ostream& os, const corpus_options& options, unsigned level)
+    {
+        const std::string loop_var = "i" + std::to_string(options.loops - 1);
+
+        for (unsigned b = 0; b < options.branches; ++b)
+        {
+            if (b + 1 < options.branches)
+            {
+                os << indent(level) << ((b != 0) ? "else " : "") << "if ((" << loop_var << " % " << options.branches << "u) == " << b << "u)\n";
+            }
+            else if (b != 0)
+            {
+                os << indent(level) << "else\n";
+            }
+
+            os << indent(level) << "{\n";
+            os << indent(level + 1) << "corpus_work(" << loop_var << " + " << b << "u);\n";
+            os << indent(level) << "}\n";
+        }
+    }
+
+    static void write_box(std::ostream& os, const corpus_options& options, unsigned file, unsigned box)
+    {
+        std::ostringstream name_stream;
+        name_stream << "box_" << file << '_' << box;
+        const std::string name = name_stream.str();
+
+        os << "    class " << name << " : public bobox::basic_box\n";
+        os << "    {\n";
+        os << "    public:\n";
+        os << "        typedef generic_model<" << name << ", bobox::BST_STATELESS> model;\n\n";
+
+        os << "        BOBOX_BOX_INPUTS_LIST(";
+        for (unsigned i = 0; i < options.inputs; ++i)
+        {
+            os << ((i == 0) ? "" : ", ") << "in" << i << ", " << i;
+        }
+        os << ");\n";
+        os << "        BOBOX_BOX_OUTPUTS_LIST(main, 0);\n\n";
+
+        os << "        " << name << "(const box_parameters_pack& box_params)\n";
+        os << "            : bobox::basic_box(box_params)\n";
+        os << "        {\n";
+        os << "        }\n\n";
+
+        os << "        virtual void sync_body() BOBOX_OVERRIDE\n";
+        os << "        {\n";
+        for (unsigned i = 0; i < options.inputs; ++i)
+        {
+            os << "            auto env" << i << " = pop_envelope(inputs::in" << i << "());\n";
+        }
+
+        os << "            if (";
+        for (unsigned i = 0; i < options.inputs; ++i)
+        {
+            os << ((i == 0) ? "" : " || ") << "env" << i << "->is_poisoned()";
+        }
+        os << ")\n";
+        os << "            {\n";
+        os << "                send_poisoned(outputs::main());\n";
+        os << "                return;\n";
+        os << "            }\n\n";
+
+        unsigned level = 3;
+        for (unsigned l = 0; l < options.loops; ++l)
+        {
+            os << indent(level) << "for (unsigned i" << l << " = 0u; i" << l << " < CORPUS_LOOP_SIZE; ++i" << l << ")\n";
+            os << indent(level) << "{\n";
+            ++level;
+        }
+
+        if (options.loops == 0)
+        {
+            os << indent(level) << "const unsigned i0 = 0u;\n";
+            corpus_options single = options;
+            single.loops = 1;
+            write_branches(os, single, level);
+        }
+        else
+        {
+            write_branches(os, options, level);
+        }
+
+        for (unsigned l = 0; l < options.loops; ++l)
+        {
+            --level;
+            os << indent(level) << "}\n";
+        }
+
+        os << "        }\n";
+        os << "    };\n";
+    }
+
+    static bool write_file(const corpus_options& options, unsigned file)
+    {
+        std::ostringstream path;
+        path << options.output << "/corpus_" << file << ".cpp";
+
+        std::ofstream os(path.str());
+        if (!os)
+        {
+            std::cerr << "failed to create file: " << path.str() << std::endl;
+            return false;
+        }
+
+        os << "// Generated by bobopt_gen_corpus, do not edit.\n\n";
+        os << "#include <bobox_basic_box.hpp>\n";
+        os << "#include <bobox_basic_box_utils.hpp>\n\n";
+        os << "namespace corpus\n";
+        os << "{\n";
+        os << "    static const unsigned CORPUS_LOOP_SIZE = 16u;\n\n";
+        os << "    void corpus_work(unsigned value);\n";
+
+        for (unsigned box = 0; box < options.boxes; ++box)
+        {
+            os << "\n";
+            write_box(os, options, file, box);
+        }
+
+        os << "\n} // corpus\n";
+
+        return static_cast<bool>(os);
+    }
+
+} // bobopt
+
+int main(int argc, char* argv[])
+{
+    bobopt::corpus_options options;
+    if (!bobopt::parse_options(argc, argv, options))
+    {
+        return 2;
+    }
+
+    for (unsigned file = 0; file < options.files; ++file)
+    {
+        if (!bobopt::write_file(options, file))
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -36,7 +36,8 @@ namespace bobopt
 
             BOBOX_ASSERT(pop_envelope(inputs::main())->is_poisoned());
 
-            for (unsigned i = 0u; i <= TEST_SIZE; ++i)
+            const unsigned count = bench_scale_count(TEST_SIZE);
+            for (unsigned i = 0u; i <= count; ++i)
             {
                 bench_send_envelope(this, outputs::main(), i);
             }
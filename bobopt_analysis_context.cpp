@@ -0,0 +1,212 @@
+#include <bobopt_analysis_context.hpp>
+
+#include <bobopt_debug.hpp>
+#include <bobopt_time_report.hpp>
+#include <bobopt_utils.hpp>
+#include <clang/bobopt_clang_utils.hpp>
+
+#include <clang/bobopt_clang_prolog.hpp>
+#include "llvm/Support/Casting.h"
+#include "clang/AST/DeclCXX.h"
+#include "clang/AST/ParentMap.h"
+#include "clang/AST/Stmt.h"
+#include "clang/Analysis/CFG.h"
+#include "clang/Basic/SourceManager.h"
+#include <clang/bobopt_clang_epilog.hpp>
+
+#include BOBOPT_INLINE_IN_SOURCE(bobopt_analysis_context.inl)
+
+using namespace clang;
+
+namespace bobopt
+{
+
+    // method_context:
+    //==========================================================================
+
+    method_context::method_context(FunctionDecl* function)
+        : function_(function)
+        , body_(nullptr)
+        , cfg_built_(false)
+        , cfg_()
+        , parent_map_()
+        , calls_()
+        , block_costs_()
+    {
+        BOBOPT_ASSERT(function_ != nullptr);
+
+        if (function_->hasBody())
+        {
+            body_ = llvm::dyn_cast_or_null<CompoundStmt>(function_->getBody());
+        }
+    }
+
+    method_context::~method_context()
+    {
+    }
+
+    /// \brief CFG of function body, \c nullptr if it can't be built.
+    const CFG* method_context::get_cfg()
+    {
+        if (cfg_built_)
+        {
+            return cfg_.get();
+        }
+
+        cfg_built_ = true;
+        if (body_ == nullptr)
+        {
+            return nullptr;
+        }
+
+        scoped_timer timer("CFG build");
+
+        CFG::BuildOptions options;
+        cfg_ = std::unique_ptr<CFG>(CFG::buildCFG(function_, body_, &function_->getASTContext(), options));
+        return cfg_.get();
+    }
+
+    /// \brief Map from statements of body to their parents.
+    const ParentMap& method_context::get_parent_map()
+    {
+        BOBOPT_ASSERT(body_ != nullptr);
+
+        if (parent_map_ == nullptr)
+        {
+            parent_map_ = make_unique<ParentMap>(body_);
+        }
+
+        return *parent_map_;
+    }
+
+    /// \brief All call expressions in body in order of their appearance.
+    const method_context::calls_type& method_context::get_calls()
+    {
+        if (calls_ == nullptr)
+        {
+            calls_ = make_unique<calls_type>();
+            if (body_ != nullptr)
+            {
+                nodes_collector<CallExpr> collector;
+                collector.TraverseStmt(body_);
+                calls_->assign(collector.nodes_begin(), collector.nodes_end());
+            }
+        }
+
+        return *calls_;
+    }
+
+    /// \brief Cost of CFG block computed once by given function.
+    ///
+    /// Cache is indexed only by block, all callers have to use the same cost
+    /// function.
+    const method_context::block_cost& method_context::get_block_cost(const CFGBlock& block, block_cost_function compute)
+    {
+        BOBOPT_ASSERT(compute != nullptr);
+
+        auto it = block_costs_.find(block.getBlockID());
+        if (it == block_costs_.end())
+        {
+            it = block_costs_.insert(std::make_pair(block.getBlockID(), compute(block))).first;
+        }
+
+        return it->second;
+    }
+
+    /// \brief Tests whether statement is ancestor statement or it is nested in it.
+    bool method_context::contains(const Stmt* ancestor, const Stmt* stmt)
+    {
+        if ((ancestor == nullptr) || (stmt == nullptr))
+        {
+            return false;
+        }
+
+        const ParentMap& parent_map = get_parent_map();
+        for (; stmt != nullptr; stmt = parent_map.getParent(stmt))
+        {
+            if (stmt == ancestor)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // box_context:
+    //==========================================================================
+
+    box_context::box_context(CXXRecordDecl* box, SourceManager& sm)
+        : box_(box)
+        , sm_(sm)
+        , style_()
+        , line_detected_(false)
+        , method_detected_(false)
+        , endl_detected_(false)
+        , methods_()
+        , functor_complexities_()
+    {
+        BOBOPT_ASSERT(box_ != nullptr);
+    }
+
+    box_context::~box_context()
+    {
+    }
+
+    /// \brief Single level of indentation used in box.
+    const std::string& box_context::get_line_indent()
+    {
+        if (!line_detected_)
+        {
+            style_.line_ = detect_line_indent(sm_, box_);
+            line_detected_ = true;
+        }
+
+        return style_.line_;
+    }
+
+    /// \brief Indentation of member function declarations in box.
+    const std::string& box_context::get_method_indent()
+    {
+        if (!method_detected_)
+        {
+            style_.method_ = detect_method_decl_indent(sm_, box_);
+            method_detected_ = true;
+        }
+
+        return style_.method_;
+    }
+
+    /// \brief Line ending used in box.
+    const std::string& box_context::get_line_end()
+    {
+        if (!endl_detected_)
+        {
+            style_.endl_ = detect_line_end(sm_, box_);
+            endl_detected_ = true;
+        }
+
+        return style_.endl_;
+    }
+
+    /// \brief Context of member function of box, created on first request.
+    method_context& box_context::get_method_context(CXXMethodDecl* method)
+    {
+        BOBOPT_ASSERT(method != nullptr);
+
+        auto& result = methods_[method];
+        if (result == nullptr)
+        {
+            result = make_unique<method_context>(method);
+        }
+
+        return *result;
+    }
+
+    /// \brief Complexity of functors computed by optimization methods, every functor is analyzed once per box.
+    box_context::complexities_type& box_context::get_functor_complexities()
+    {
+        return functor_complexities_;
+    }
+
+} // namespace
@@ -0,0 +1,131 @@
+/// \file bobopt_analysis_context.hpp File contains definition of analysis
+/// context shared by optimization methods.
+///
+/// Optimizer creates context for every box before it applies optimization
+/// methods and destroys it afterwards. Everything in context is computed
+/// lazily on first request, so methods pay only for what some of them uses
+/// and nothing is computed twice.
+
+#ifndef BOBOPT_ANALYSIS_CONTEXT_HPP_GUARD_
+#define BOBOPT_ANALYSIS_CONTEXT_HPP_GUARD_
+
+#include <bobopt_inline.hpp>
+#include <bobopt_macros.hpp>
+#include <bobopt_text_utils.hpp>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// forward declarations:
+namespace clang
+{
+    class CallExpr;
+    class CFG;
+    class CFGBlock;
+    class CompoundStmt;
+    class CXXMethodDecl;
+    class CXXRecordDecl;
+    class FunctionDecl;
+    class ParentMap;
+    class SourceManager;
+    class Stmt;
+}
+
+namespace bobopt
+{
+
+    // method_context:
+    //==========================================================================
+
+    /// \brief Analysis data of single member function, or of function it executes,
+    /// e.g., functor of standard algorithm.
+    class method_context
+    {
+    public:
+        /// \brief Cost of single CFG block.
+        struct block_cost
+        {
+            unsigned complexity;
+            /// \brief Block contains call to Bobox yield().
+            bool yield;
+        };
+
+        /// \brief Function computing cost of block for cache in context.
+        typedef block_cost (*block_cost_function)(const clang::CFGBlock& block);
+
+        typedef std::vector<clang::CallExpr*> calls_type;
+
+        explicit method_context(clang::FunctionDecl* function);
+        ~method_context();
+
+        clang::FunctionDecl* get_function() const;
+        clang::CompoundStmt* get_body() const;
+
+        const clang::CFG* get_cfg();
+        const clang::ParentMap& get_parent_map();
+        const calls_type& get_calls();
+        const block_cost& get_block_cost(const clang::CFGBlock& block, block_cost_function compute);
+
+        bool contains(const clang::Stmt* ancestor, const clang::Stmt* stmt);
+
+    private:
+        BOBOPT_NONCOPYMOVABLE(method_context);
+
+        clang::FunctionDecl* function_;
+        clang::CompoundStmt* body_;
+
+        bool cfg_built_;
+        std::unique_ptr<clang::CFG> cfg_;
+        std::unique_ptr<clang::ParentMap> parent_map_;
+        std::unique_ptr<calls_type> calls_;
+        std::unordered_map<unsigned, block_cost> block_costs_;
+    };
+
+    // box_context:
+    //==========================================================================
+
+    /// \brief Analysis data of single box and its member functions.
+    class box_context
+    {
+    public:
+        /// \brief Complexity of functions executed by member functions, e.g., functors of standard algorithms.
+        typedef std::map<const clang::FunctionDecl*, unsigned> complexities_type;
+
+        box_context(clang::CXXRecordDecl* box, clang::SourceManager& sm);
+        ~box_context();
+
+        clang::CXXRecordDecl* get_box() const;
+
+        const std::string& get_line_indent();
+        const std::string& get_method_indent();
+        const std::string& get_line_end();
+
+        method_context& get_method_context(clang::CXXMethodDecl* method);
+        complexities_type& get_functor_complexities();
+
+    private:
+        BOBOPT_NONCOPYMOVABLE(box_context);
+
+        typedef std::map<const clang::CXXMethodDecl*, std::unique_ptr<method_context> > methods_type;
+
+        clang::CXXRecordDecl* box_;
+        clang::SourceManager& sm_;
+
+        /// \brief Style is detected by parts, not every box has member functions to detect method indent from.
+        document_indent style_;
+        bool line_detected_;
+        bool method_detected_;
+        bool endl_detected_;
+
+        methods_type methods_;
+        complexities_type functor_complexities_;
+    };
+
+} // namespace
+
+#include BOBOPT_INLINE_IN_HEADER(bobopt_analysis_context.inl)
+
+#endif // guard
@@ -0,0 +1,26 @@
+namespace bobopt
+{
+
+    // method_context:
+    //==========================================================================
+
+    BOBOPT_INLINE clang::FunctionDecl* method_context::get_function() const
+    {
+        return function_;
+    }
+
+    /// \brief Body of function, \c nullptr if it is not compound statement.
+    BOBOPT_INLINE clang::CompoundStmt* method_context::get_body() const
+    {
+        return body_;
+    }
+
+    // box_context:
+    //==========================================================================
+
+    BOBOPT_INLINE clang::CXXRecordDecl* box_context::get_box() const
+    {
+        return box_;
+    }
+
+} // namespace
@@ -0,0 +1,43 @@
+#include <bobopt_budget.hpp>
+
+#include BOBOPT_INLINE_IN_SOURCE(bobopt_budget.inl)
+
+namespace bobopt
+{
+
+    // analysis_budget implementation.
+    //==========================================================================
+
+    /// \brief Start measuring wall time of analysis.
+    ///
+    /// \param max_steps Maximal number of steps, zero for unlimited.
+    /// \param max_time_ms Maximal wall time in milliseconds, zero for unlimited.
+    analysis_budget::analysis_budget(unsigned max_steps, unsigned max_time_ms)
+        : max_steps_(max_steps)
+        , steps_(0u)
+        , timed_(max_time_ms != 0u)
+        , deadline_(clock_type::now() + std::chrono::milliseconds(max_time_ms))
+        , exceeded_(LIMIT_NONE)
+    {
+    }
+
+    /// \brief Check wall time immediately.
+    ///
+    /// \return Whether analysis can continue.
+    bool analysis_budget::check_time()
+    {
+        if (exceeded_ != LIMIT_NONE)
+        {
+            return false;
+        }
+
+        if (timed_ && (clock_type::now() > deadline_))
+        {
+            exceeded_ = LIMIT_TIME;
+            return false;
+        }
+
+        return true;
+    }
+
+} // namespace
@@ -0,0 +1,58 @@
+/// \file bobopt_budget.hpp File contains definition of budget that limits work
+/// spent by analysis of single member function.
+
+#ifndef BOBOPT_BUDGET_HPP_GUARD_
+#define BOBOPT_BUDGET_HPP_GUARD_
+
+#include <bobopt_inline.hpp>
+
+#include <chrono>
+
+namespace bobopt
+{
+
+    // analysis_budget:
+    //==========================================================================
+
+    /// \brief Limits number of steps and wall time of single analysis.
+    ///
+    /// Zero limit means unlimited. Once any limit is exceeded, budget stays
+    /// exhausted and analysis is expected to stop and degrade gracefully.
+    class analysis_budget
+    {
+    public:
+        /// \brief Limit that was exceeded.
+        enum limits
+        {
+            LIMIT_NONE,
+            LIMIT_STEPS,
+            LIMIT_TIME
+        };
+
+        analysis_budget(unsigned max_steps, unsigned max_time_ms);
+
+        bool consume();
+        bool check_time();
+
+        bool exhausted() const;
+        limits get_exceeded() const;
+        unsigned get_steps() const;
+
+    private:
+        typedef std::chrono::steady_clock clock_type;
+
+        unsigned max_steps_;
+        unsigned steps_;
+        bool timed_;
+        clock_type::time_point deadline_;
+        limits exceeded_;
+
+        /// \brief Clock is checked only once per this number of steps.
+        static const unsigned TIME_CHECK_INTERVAL = 64u;
+    };
+
+} // namespace
+
+#include BOBOPT_INLINE_IN_HEADER(bobopt_budget.inl)
+
+#endif // guard
@@ -0,0 +1,44 @@
+namespace bobopt
+{
+
+    /// \brief Count single step of analysis. Wall time is checked periodically.
+    ///
+    /// \return Whether analysis can continue.
+    BOBOPT_INLINE bool analysis_budget::consume()
+    {
+        if (exceeded_ != LIMIT_NONE)
+        {
+            return false;
+        }
+
+        ++steps_;
+        if ((max_steps_ != 0u) && (steps_ > max_steps_))
+        {
+            exceeded_ = LIMIT_STEPS;
+            return false;
+        }
+
+        if ((steps_ % TIME_CHECK_INTERVAL) == 0u)
+        {
+            return check_time();
+        }
+
+        return true;
+    }
+
+    BOBOPT_INLINE bool analysis_budget::exhausted() const
+    {
+        return (exceeded_ != LIMIT_NONE);
+    }
+
+    BOBOPT_INLINE analysis_budget::limits analysis_budget::get_exceeded() const
+    {
+        return exceeded_;
+    }
+
+    BOBOPT_INLINE unsigned analysis_budget::get_steps() const
+    {
+        return steps_;
+    }
+
+} // namespace
@@ -0,0 +1,426 @@
+#include <bobopt_calibration.hpp>
+
+#include <bobopt_debug.hpp>
+
+#include <clang/bobopt_clang_prolog.hpp>
+#include "llvm/ADT/APSInt.h"
+#include "llvm/Support/raw_ostream.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/Decl.h"
+#include "clang/AST/Expr.h"
+#include "clang/AST/Stmt.h"
+#include "clang/Analysis/CFG.h"
+#include "clang/Basic/SourceManager.h"
+#include <clang/bobopt_clang_epilog.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <numeric>
+#include <sstream>
+
+using namespace clang;
+using namespace clang::ast_matchers;
+
+namespace bobopt
+{
+
+    // TU helpers.
+    //==========================================================================
+
+    namespace
+    {
+
+        /// \brief Tests whether expression is reference to variable.
+        bool refers_to(const Expr* expr, const VarDecl* var)
+        {
+            const DeclRefExpr* ref = llvm::dyn_cast_or_null<DeclRefExpr>((expr != nullptr) ? expr->IgnoreParenImpCasts() : nullptr);
+            return (ref != nullptr) && (ref->getDecl() == var);
+        }
+
+        /// \brief Evaluate integer constant expression.
+        bool evaluate(const Expr* expr, const ASTContext& context, long long& value)
+        {
+            if ((expr == nullptr) || expr->isValueDependent() || expr->isTypeDependent())
+            {
+                return false;
+            }
+
+            llvm::APSInt result;
+            if (!expr->EvaluateAsInt(result, context) || (result.getMinSignedBits() > 63))
+            {
+                return false;
+            }
+
+            value = result.getExtValue();
+            return true;
+        }
+
+        /// \brief Counter variable of for loop and its initial value.
+        const VarDecl* get_counter(const Stmt* init, const ASTContext& context, long long& start)
+        {
+            if (const DeclStmt* decl_stmt = llvm::dyn_cast_or_null<DeclStmt>(init))
+            {
+                if (!decl_stmt->isSingleDecl())
+                {
+                    return nullptr;
+                }
+
+                const VarDecl* var = llvm::dyn_cast<VarDecl>(decl_stmt->getSingleDecl());
+                return ((var != nullptr) && evaluate(var->getInit(), context, start)) ? var : nullptr;
+            }
+
+            const BinaryOperator* assign = llvm::dyn_cast_or_null<BinaryOperator>(init);
+            if ((assign == nullptr) || (assign->getOpcode() != BO_Assign))
+            {
+                return nullptr;
+            }
+
+            const DeclRefExpr* ref = llvm::dyn_cast<DeclRefExpr>(assign->getLHS()->IgnoreParenImpCasts());
+            const VarDecl* var = (ref != nullptr) ? llvm::dyn_cast<VarDecl>(ref->getDecl()) : nullptr;
+            return ((var != nullptr) && evaluate(assign->getRHS(), context, start)) ? var : nullptr;
+        }
+
+        /// \brief Step added to counter by increment of for loop.
+        bool get_step(const Expr* inc, const VarDecl* var, const ASTContext& context, long long& step)
+        {
+            inc = (inc != nullptr) ? inc->IgnoreParens() : nullptr;
+
+            if (const UnaryOperator* unary = llvm::dyn_cast_or_null<UnaryOperator>(inc))
+            {
+                if (!refers_to(unary->getSubExpr(), var))
+                {
+                    return false;
+                }
+
+                if (unary->isIncrementOp())
+                {
+                    step = 1;
+                    return true;
+                }
+
+                if (unary->isDecrementOp())
+                {
+                    step = -1;
+                    return true;
+                }
+
+                return false;
+            }
+
+            const CompoundAssignOperator* assign = llvm::dyn_cast_or_null<CompoundAssignOperator>(inc);
+            if ((assign == nullptr) || !refers_to(assign->getLHS(), var) || !evaluate(assign->getRHS(), context, step))
+            {
+                return false;
+            }
+
+            switch (assign->getOpcode())
+            {
+            case BO_AddAssign:
+            {
+                return step != 0;
+            }
+            case BO_SubAssign:
+            {
+                step = -step;
+                return step != 0;
+            }
+            default:
+            {
+                return false;
+            }
+            }
+        }
+
+        /// \brief Number of body executions of for loop with constant bounds.
+        ///
+        /// Only loops in form for (i = C1; i op C2; i += C3) are recognized,
+        /// where op is one of <, <=, >, >= and !=. Trip count of other loops
+        /// depends on run time values.
+        bool get_for_executions(const ForStmt* for_stmt, const ASTContext& context, unsigned long long& executions)
+        {
+            long long start = 0;
+            const VarDecl* var = get_counter(for_stmt->getInit(), context, start);
+            if (var == nullptr)
+            {
+                return false;
+            }
+
+            const BinaryOperator* cond = llvm::dyn_cast_or_null<BinaryOperator>((for_stmt->getCond() != nullptr) ? for_stmt->getCond()->IgnoreParenImpCasts() : nullptr);
+            if (cond == nullptr)
+            {
+                return false;
+            }
+
+            const bool counter_left = refers_to(cond->getLHS(), var);
+            if (!counter_left && !refers_to(cond->getRHS(), var))
+            {
+                return false;
+            }
+
+            long long end = 0;
+            if (!evaluate(counter_left ? cond->getRHS() : cond->getLHS(), context, end))
+            {
+                return false;
+            }
+
+            // Normalize C2 op i to i op' C2.
+            BinaryOperatorKind opcode = cond->getOpcode();
+            if (!counter_left)
+            {
+                switch (opcode)
+                {
+                case BO_LT:
+                {
+                    opcode = BO_GT;
+                    break;
+                }
+                case BO_LE:
+                {
+                    opcode = BO_GE;
+                    break;
+                }
+                case BO_GT:
+                {
+                    opcode = BO_LT;
+                    break;
+                }
+                case BO_GE:
+                {
+                    opcode = BO_LE;
+                    break;
+                }
+                default:
+                {
+                    break;
+                }
+                }
+            }
+
+            long long step = 0;
+            if (!get_step(for_stmt->getInc(), var, context, step))
+            {
+                return false;
+            }
+
+            // Count in direction of step, distance is number of values counter passes.
+            const bool up = (step > 0);
+            const unsigned long long abs_step = up ? static_cast<unsigned long long>(step) : static_cast<unsigned long long>(-step);
+            if ((up && (end <= start)) || (!up && (start <= end)))
+            {
+                // Only inclusive bounds execute body with equal start and end.
+                const bool inclusive = ((opcode == (up ? BO_LE : BO_GE)) && (start == end));
+                executions = inclusive ? 1u : 0u;
+                return inclusive;
+            }
+
+            const unsigned long long distance = up ? (static_cast<unsigned long long>(end) - static_cast<unsigned long long>(start))
+                                                    : (static_cast<unsigned long long>(start) - static_cast<unsigned long long>(end));
+
+            if (opcode == (up ? BO_LT : BO_GT))
+            {
+                executions = (distance + abs_step - 1) / abs_step;
+                return true;
+            }
+
+            if (opcode == (up ? BO_LE : BO_GE))
+            {
+                executions = distance / abs_step + 1;
+                return true;
+            }
+
+            if ((opcode == BO_NE) && ((distance % abs_step) == 0))
+            {
+                executions = distance / abs_step;
+                return true;
+            }
+
+            return false;
+        }
+
+        /// \brief Number of CFG elements of function body, the unit of yield complex cost model.
+        unsigned get_statement_count(const FunctionDecl* function, ASTContext& context)
+        {
+            CFG::BuildOptions options;
+            std::unique_ptr<CFG> cfg(CFG::buildCFG(function, function->getBody(), &context, options));
+            if (cfg == nullptr)
+            {
+                return 0u;
+            }
+
+            unsigned result = 0u;
+            for (const CFGBlock* block : *cfg)
+            {
+                result += static_cast<unsigned>(block->size());
+            }
+
+            return result;
+        }
+
+        /// \brief Rounded arithmetic mean.
+        unsigned get_mean(const std::vector<unsigned>& values)
+        {
+            BOBOPT_ASSERT(!values.empty());
+
+            const unsigned long long sum = std::accumulate(values.begin(), values.end(), 0ull);
+            return static_cast<unsigned>((sum + values.size() / 2) / values.size());
+        }
+
+        /// \brief Median, robust against few loops with huge constant bounds.
+        unsigned long long get_median(std::vector<unsigned long long> values)
+        {
+            BOBOPT_ASSERT(!values.empty());
+
+            auto middle = values.begin() + values.size() / 2;
+            std::nth_element(values.begin(), middle, values.end());
+            return *middle;
+        }
+
+    } // namespace
+
+    // calibration:
+    //==========================================================================
+
+    /// \brief Matcher of function definitions.
+    const DeclarationMatcher calibration::FUNCTION_MATCHER = functionDecl(isDefinition()).bind("function");
+    /// \brief Matcher of for loops.
+    const StatementMatcher calibration::FOR_MATCHER = forStmt().bind("for");
+
+    calibration::calibration()
+        : seen_()
+        , inline_complexities_()
+        , default_complexities_()
+        , for_executions_()
+    {
+    }
+
+    calibration::~calibration()
+    {
+    }
+
+    /// \brief Match callback.
+    void calibration::run(const MatchFinder::MatchResult& result)
+    {
+        if (const FunctionDecl* function = result.Nodes.getNodeAs<FunctionDecl>("function"))
+        {
+            add_function(function, *result.Context);
+        }
+
+        if (const ForStmt* for_stmt = result.Nodes.getNodeAs<ForStmt>("for"))
+        {
+            add_for(for_stmt, *result.Context);
+        }
+    }
+
+    /// \brief Add statement count of function to inline or non-inline samples.
+    ///
+    /// Trivial and constexpr functions have their own constants in cost model.
+    void calibration::add_function(const FunctionDecl* function, ASTContext& context)
+    {
+        if (function->isImplicit() || function->isDependentContext() || function->hasTrivialBody() || function->isConstexpr() || (function->getBody() == nullptr))
+        {
+            return;
+        }
+
+        const SourceManager& sm = context.getSourceManager();
+        if (sm.isInSystemHeader(function->getLocation()) || !is_new(sm, function->getLocation()))
+        {
+            return;
+        }
+
+        const unsigned count = get_statement_count(function, context);
+        if (count == 0u)
+        {
+            return;
+        }
+
+        if (function->isInlined())
+        {
+            inline_complexities_.push_back(count);
+        }
+        else
+        {
+            default_complexities_.push_back(count);
+        }
+    }
+
+    /// \brief Add number of body executions of for loop with constant bounds.
+    void calibration::add_for(const ForStmt* for_stmt, ASTContext& context)
+    {
+        const SourceManager& sm = context.getSourceManager();
+        if (sm.isInSystemHeader(for_stmt->getForLoc()))
+        {
+            return;
+        }
+
+        // Loops in template are matched uninstantiated first, they are counted
+        // only once evaluated in instantiation.
+        unsigned long long executions = 0;
+        if (!get_for_executions(for_stmt, context, executions) || !is_new(sm, for_stmt->getForLoc()))
+        {
+            return;
+        }
+
+        for_executions_.push_back(executions);
+    }
+
+    /// \brief Tests whether location wasn't seen in this or previous translation units.
+    bool calibration::is_new(const SourceManager& sm, SourceLocation location)
+    {
+        const SourceLocation expansion = sm.getExpansionLoc(location);
+
+        std::ostringstream os;
+        os << sm.getFilename(expansion).str() << ':' << sm.getFileOffset(expansion);
+        return seen_.insert(os.str()).second;
+    }
+
+    /// \brief Save [yield complex] configuration with calibrated constants.
+    ///
+    /// Constants without samples aren't written, loading configuration keeps
+    /// their current values.
+    bool calibration::save(const std::string& file_name) const
+    {
+        std::ofstream file(file_name);
+        if (!file)
+        {
+            return false;
+        }
+
+        file << "# Generated by bobopt calibrate from " << inline_complexities_.size() << " inline functions, " << default_complexities_.size()
+             << " non-inline functions and " << for_executions_.size() << " for loops with constant bounds." << std::endl;
+        file << "# Trip counts of while loops aren't known statically, multiplier_while isn't calibrated." << std::endl;
+        file << "[yield complex]" << std::endl;
+        file << std::endl;
+
+        if (!inline_complexities_.empty())
+        {
+            file << "call_inline_complexity: " << get_mean(inline_complexities_) << std::endl;
+        }
+        else
+        {
+            file << "# No inline function found, call_inline_complexity isn't calibrated." << std::endl;
+        }
+
+        if (!default_complexities_.empty())
+        {
+            file << "call_default_complexity: " << get_mean(default_complexities_) << std::endl;
+        }
+        else
+        {
+            file << "# No non-inline function found, call_default_complexity isn't calibrated." << std::endl;
+        }
+
+        if (!for_executions_.empty())
+        {
+            const unsigned long long median = get_median(for_executions_);
+            file << "multiplier_for: " << static_cast<unsigned>(std::max(1ull, std::min(median, 0xffffffffull))) << std::endl;
+        }
+        else
+        {
+            file << "# No for loop with constant bounds found, multiplier_for isn't calibrated." << std::endl;
+        }
+
+        return static_cast<bool>(file);
+    }
+
+} // namespace
@@ -0,0 +1,71 @@
+/// \file bobopt_calibration.hpp File contains calibration of yield complex cost
+/// model constants for particular codebase.
+///
+/// Complexity of call expressions in yield complex method is estimated by
+/// average statement count of inline and non-inline functions, loop body
+/// complexity by average number of loop body executions. Calibration gathers
+/// the same statistics from translation units of codebase and saves them as
+/// \c [yield complex] configuration readable by \c config_parser::load.
+
+#ifndef BOBOPT_CALIBRATION_HPP_GUARD_
+#define BOBOPT_CALIBRATION_HPP_GUARD_
+
+#include <bobopt_language.hpp>
+#include <bobopt_macros.hpp>
+
+#include <clang/bobopt_clang_prolog.hpp>
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+#include <clang/bobopt_clang_epilog.hpp>
+
+#include <set>
+#include <string>
+#include <vector>
+
+// Forward declaration(s).
+namespace clang
+{
+    class ASTContext;
+    class ForStmt;
+    class FunctionDecl;
+    class SourceManager;
+}
+
+namespace bobopt
+{
+
+    // calibration:
+    //==========================================================================
+
+    /// \brief Match callback gathering statistics of functions and loops.
+    class calibration : public clang::ast_matchers::MatchFinder::MatchCallback
+    {
+    public:
+        static const clang::ast_matchers::DeclarationMatcher FUNCTION_MATCHER;
+        static const clang::ast_matchers::StatementMatcher FOR_MATCHER;
+
+        calibration();
+        virtual ~calibration() BOBOPT_OVERRIDE;
+
+        virtual void run(const clang::ast_matchers::MatchFinder::MatchResult& result) BOBOPT_OVERRIDE;
+
+        bool save(const std::string& file_name) const;
+
+    private:
+        BOBOPT_NONCOPYMOVABLE(calibration);
+
+        void add_function(const clang::FunctionDecl* function, clang::ASTContext& context);
+        void add_for(const clang::ForStmt* for_stmt, clang::ASTContext& context);
+
+        bool is_new(const clang::SourceManager& sm, clang::SourceLocation location);
+
+        /// \brief Functions and loops from headers are matched in every translation unit.
+        std::set<std::string> seen_;
+
+        std::vector<unsigned> inline_complexities_;
+        std::vector<unsigned> default_complexities_;
+        std::vector<unsigned long long> for_executions_;
+    };
+
+} // namespace
+
+#endif // guard
@@ -1,6 +1,9 @@
 #include <bobopt_config.hpp>
 
 #include <clang/bobopt_clang_prolog.hpp>
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 #include <clang/bobopt_clang_epilog.hpp>
 
@@ -29,19 +32,21 @@ namespace bobopt
     /// \brief Load configuration from specific file.
     bool config_parser::load(const std::string& file_name)
     {
-        std::ifstream file(file_name);
-        if (!file)
+        std::vector<config_setting> settings;
+        if (!read(file_name, settings))
         {
             return false;
         }
 
         try
         {
-            for (std::string line; std::getline(file, line);)
+            for (const auto& setting : settings)
             {
-                if (!parse_line(line))
+                // Variables of unknown group are ignored.
+                config_group* group = config_map::instance().get_group(setting.group);
+                if (group != nullptr)
                 {
-                    return false;
+                    group->get_variable(setting.variable).set(setting.value);
                 }
             }
         }
@@ -54,6 +59,27 @@ namespace bobopt
         return true;
     }
 
+    /// \brief Read settings of configuration file without applying them.
+    bool config_parser::read(const std::string& file_name, std::vector<config_setting>& settings) const
+    {
+        std::ifstream file(file_name);
+        if (!file)
+        {
+            return false;
+        }
+
+        std::string group;
+        for (std::string line; std::getline(file, line);)
+        {
+            if (!parse_line(line, group, settings))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
     /// \brief Save configuration to specific file.
     bool config_parser::save(const std::string& file_name) const
     {
@@ -82,20 +108,18 @@ namespace bobopt
     }
 
     /// \brief Helper to parse single line of configuration file.
-    bool config_parser::parse_line(const std::string& line)
+    bool config_parser::parse_line(const std::string& line, std::string& group, std::vector<config_setting>& settings)
     {
         // Variable line should be the most frequent.
         {
             std::smatch m;
             if (std::regex_match(line, m, REGEX_VARIABLE))
             {
-                if (group_ == nullptr)
-                {
-                    return true;
-                }
-
-                auto& variable = group_->get_variable(m[1].str());
-                variable.set(m[2].str());
+                config_setting setting;
+                setting.group = group;
+                setting.variable = m[1].str();
+                setting.value = m[2].str();
+                settings.push_back(setting);
                 return true;
             }
         }
@@ -113,7 +137,7 @@ namespace bobopt
             std::smatch m;
             if (std::regex_match(line, m, REGEX_GROUP))
             {
-                group_ = config_map::instance().get_group(m[1].str());
+                group = m[1].str();
                 return true;
             }
         }
@@ -122,4 +146,120 @@ namespace bobopt
         return std::regex_match(line, REGEX_COMMENT);
     }
 
+    // config_override:
+    //==========================================================================
+
+    config_override::config_override()
+        : previous_()
+    {
+    }
+
+    config_override::~config_override()
+    {
+        for (auto it = previous_.rbegin(), end = previous_.rend(); it != end; ++it)
+        {
+            it->first->set(it->second);
+        }
+    }
+
+    /// \brief Set variable until destruction, fails for unknown variable or invalid value.
+    bool config_override::set(const std::string& group_name, const std::string& variable_name, const std::string& text)
+    {
+        config_group* group = config_map::instance().get_group(group_name);
+        basic_config_variable* variable = (group != nullptr) ? group->find_variable(variable_name) : nullptr;
+        if (variable == nullptr)
+        {
+            return false;
+        }
+
+        const std::string previous = variable->value();
+        try
+        {
+            variable->set(text);
+        }
+        catch (const std::exception&)
+        {
+            return false;
+        }
+
+        previous_.push_back(std::make_pair(variable, previous));
+        return true;
+    }
+
+    // config_directories:
+    //==========================================================================
+
+    /// \brief Name of configuration file searched in directories.
+    const char* const config_directories::FILE_NAME = ".bobopt";
+
+    config_directories::config_directories()
+        : cache_()
+    {
+    }
+
+    config_directories::~config_directories()
+    {
+    }
+
+    /// \brief Override variables by configuration files of directories of file.
+    void config_directories::apply(const std::string& file_path, config_override& overrides)
+    {
+        llvm::SmallString<256> path(file_path);
+        llvm::sys::fs::make_absolute(path);
+
+        for (const auto& setting : get_settings(llvm::sys::path::parent_path(path).str()))
+        {
+            if (!overrides.set(setting.group, setting.variable, setting.value))
+            {
+                llvm::errs() << "[WARNING] Invalid value of " << setting.variable << " in [" << setting.group << "] for: " << file_path << "\n";
+            }
+        }
+    }
+
+    /// \brief Merged settings of directory and its parents, settings of directory come last.
+    const config_directories::settings_type& config_directories::get_settings(const std::string& directory)
+    {
+        auto found = cache_.find(directory);
+        if (found != cache_.end())
+        {
+            return found->second;
+        }
+
+        settings_type result;
+
+        const std::string parent = llvm::sys::path::parent_path(directory).str();
+        if (!parent.empty() && (parent != directory))
+        {
+            result = get_settings(parent);
+        }
+
+        llvm::SmallString<256> file_name(directory);
+        llvm::sys::path::append(file_name, FILE_NAME);
+
+        if (llvm::sys::fs::exists(file_name.str()))
+        {
+            settings_type settings;
+            config_parser parser;
+            if (!parser.read(file_name.str(), settings))
+            {
+                llvm::errs() << "[WARNING] Failed to load configuration file: " << file_name.str() << "\n";
+            }
+
+            // Unknown variables are reported once per file, not for every box.
+            for (const auto& setting : settings)
+            {
+                config_group* group = config_map::instance().get_group(setting.group);
+                if ((group == nullptr) || (group->find_variable(setting.variable) == nullptr))
+                {
+                    llvm::errs() << "[WARNING] Unknown variable " << setting.variable << " in [" << setting.group << "] of: " << file_name.str() << "\n";
+                    continue;
+                }
+
+                result.push_back(setting);
+            }
+        }
+
+        return cache_[directory] = result;
+    }
+
 } // bobopt
@@ -13,6 +13,7 @@
 #include <regex>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace bobopt
 {
@@ -53,6 +54,8 @@ namespace bobopt
         virtual void set(const std::string& text) = 0;
         /// \brief Return default variable value as a text.
         virtual std::string default_value() const = 0;
+        /// \brief Return current variable value as a text.
+        virtual std::string value() const = 0;
     };
 
     // config_group:
@@ -68,6 +71,7 @@ namespace bobopt
 
         std::string get_name() const;
         basic_config_variable& get_variable(const std::string& name);
+        basic_config_variable* find_variable(const std::string& name) const;
         bool add(basic_config_variable* variable);
 
         typedef variables_type::const_iterator variable_iterator;
@@ -113,6 +117,11 @@ namespace bobopt
             return parser_.print(default_value_);
         }
 
+        virtual std::string value() const override
+        {
+            return parser_.print(value_);
+        }
+
         /// \brief Access value of configuration variable.
         BOBOPT_INLINE ValueT get() const
         {
@@ -130,25 +139,46 @@ namespace bobopt
         ParserT parser_;
     };
 
+    // config_override:
+    //==========================================================================
+
+    /// \brief Scoped override of configuration variables, e.g., by annotations
+    /// of single box. Previous values are restored on destruction.
+    class config_override
+    {
+    public:
+        config_override();
+        ~config_override();
+
+        bool set(const std::string& group_name, const std::string& variable_name, const std::string& text);
+
+    private:
+        BOBOPT_NONCOPYMOVABLE(config_override);
+
+        std::vector<std::pair<basic_config_variable*, std::string> > previous_;
+    };
+
     // config_parser:
     //==========================================================================
 
+    /// \brief Variable setting read from configuration file.
+    struct config_setting
+    {
+        std::string group;
+        std::string variable;
+        std::string value;
+    };
+
     /// \brief Helper for save/load of configuration file.
     class config_parser
     {
     public:
-        config_parser()
-            : group_(nullptr)
-        {
-        }
-
         bool load(const std::string& file_name);
         bool save(const std::string& file_name) const;
+        bool read(const std::string& file_name, std::vector<config_setting>& settings) const;
 
     private:
-        bool parse_line(const std::string& line);
-
-        config_group* group_;
+        static bool parse_line(const std::string& line, std::string& group, std::vector<config_setting>& settings);
 
         // constants:
         static const std::regex REGEX_GROUP;
@@ -157,6 +187,35 @@ namespace bobopt
         static const std::regex REGEX_EMPTY_LINE;
     };
 
+    // config_directories:
+    //==========================================================================
+
+    /// \brief Configuration files named .bobopt found in directory of source file
+    /// and all its parent directories.
+    ///
+    /// Files are merged like .clang-format files, variables set by file closer to
+    /// source override those set in parent directories. Merged settings are
+    /// cached per directory.
+    class config_directories
+    {
+    public:
+        static const char* const FILE_NAME;
+
+        config_directories();
+        ~config_directories();
+
+        void apply(const std::string& file_path, config_override& overrides);
+
+    private:
+        BOBOPT_NONCOPYMOVABLE(config_directories);
+
+        typedef std::vector<config_setting> settings_type;
+
+        const settings_type& get_settings(const std::string& directory);
+
+        std::map<std::string, settings_type> cache_;
+    };
+
 } // bobopt
 
 #include BOBOPT_INLINE_IN_HEADER(bobopt_config.inl)
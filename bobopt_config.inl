@@ -63,6 +63,17 @@ namespace bobopt
         return *(variables_[name]);
     }
 
+    /// \brief Find configuration variable, \c nullptr if group doesn't have it.
+    BOBOPT_INLINE basic_config_variable* config_group::find_variable(const std::string& name) const
+    {
+        auto found = variables_.find(name);
+        if (found == std::end(variables_))
+        {
+            return nullptr;
+        }
+        return found->second;
+    }
+
     /// \brief Add configuration variable to the group.
     BOBOPT_INLINE bool config_group::add(basic_config_variable* variable)
     {
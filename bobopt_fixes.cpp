@@ -0,0 +1,451 @@
+#include <bobopt_fixes.hpp>
+
+#include <bobopt_debug.hpp>
+#include <bobopt_utils.hpp>
+
+#include <clang/bobopt_clang_prolog.hpp>
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+#include <clang/bobopt_clang_epilog.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace clang::tooling;
+
+namespace bobopt
+{
+
+    // Constants.
+    //==========================================================================
+
+    static const std::string FIXES_HEADER("bobopt-fixes");
+    static const unsigned FIXES_VERSION = 1u;
+
+    // TU helpers.
+    //==========================================================================
+
+    namespace
+    {
+
+        /// \brief Source file state the fixes were computed from.
+        struct file_state
+        {
+            std::size_t size;
+            std::string hash;
+        };
+
+        /// \brief Replacement texts indexed by offset and length of replaced range.
+        typedef std::map<std::pair<unsigned, unsigned>, std::vector<std::string> > edits_type;
+
+        /// \brief Fixes of single source file.
+        struct file_fixes
+        {
+            file_state state;
+            edits_type edits;
+        };
+
+        /// \brief Fixes indexed by absolute path of source file.
+        typedef std::map<std::string, file_fixes> fixes_type;
+
+        std::string escape(const std::string& text)
+        {
+            std::string result;
+            result.reserve(text.size());
+
+            for (char c : text)
+            {
+                switch (c)
+                {
+                case '\\':
+                {
+                    result += "\\\\";
+                    break;
+                }
+
+                case '\t':
+                {
+                    result += "\\t";
+                    break;
+                }
+
+                case '\n':
+                {
+                    result += "\\n";
+                    break;
+                }
+
+                case '\r':
+                {
+                    result += "\\r";
+                    break;
+                }
+
+                default:
+                {
+                    result += c;
+                }
+                }
+            }
+
+            return result;
+        }
+
+        bool unescape(const std::string& text, std::string& result)
+        {
+            result.clear();
+            result.reserve(text.size());
+
+            for (std::size_t i = 0; i < text.size(); ++i)
+            {
+                if (text[i] != '\\')
+                {
+                    result += text[i];
+                    continue;
+                }
+
+                if (++i == text.size())
+                {
+                    return false;
+                }
+
+                switch (text[i])
+                {
+                case '\\':
+                {
+                    result += '\\';
+                    break;
+                }
+
+                case 't':
+                {
+                    result += '\t';
+                    break;
+                }
+
+                case 'n':
+                {
+                    result += '\n';
+                    break;
+                }
+
+                case 'r':
+                {
+                    result += '\r';
+                    break;
+                }
+
+                default:
+                {
+                    return false;
+                }
+                }
+            }
+
+            return true;
+        }
+
+        /// \brief Split line by tabs into at most \c count fields, the last field holds the rest of line.
+        std::vector<std::string> split(const std::string& line, std::size_t count)
+        {
+            std::vector<std::string> result;
+
+            std::size_t start = 0;
+            while (result.size() + 1 < count)
+            {
+                const std::size_t end = line.find('\t', start);
+                if (end == std::string::npos)
+                {
+                    break;
+                }
+
+                result.push_back(line.substr(start, end - start));
+                start = end + 1;
+            }
+
+            result.push_back(line.substr(start));
+            return result;
+        }
+
+        bool read_content(const std::string& path, std::string& content)
+        {
+            std::ifstream file(path, std::ios::binary);
+            if (!file)
+            {
+                return false;
+            }
+
+            content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            return !file.bad();
+        }
+
+        std::string absolute_path(const std::string& path)
+        {
+            llvm::SmallString<256> result(path);
+            llvm::sys::fs::make_absolute(result);
+            return result.str();
+        }
+
+        /// \brief Add edits of single fixes file to edits merged from previous ones.
+        ///
+        /// The same replacement exported by more translation units, e.g., in
+        /// included header, is kept once. Different replacements of the same
+        /// range are conflicts, the first one wins.
+        void merge_edits(const std::string& path, const edits_type& src, edits_type& dst)
+        {
+            for (const auto& edit : src)
+            {
+                auto found = dst.find(edit.first);
+                if (found == dst.end())
+                {
+                    dst.insert(edit);
+                    continue;
+                }
+
+                if (found->second != edit.second)
+                {
+                    llvm::errs() << "[WARNING] Conflicting fixes of " << path << " at offset " << edit.first.first << ", keeping the first one.\n";
+                }
+            }
+        }
+
+        /// \brief Load single fixes file and merge it into fixes.
+        bool load_fixes(const std::string& file_name, fixes_type& fixes)
+        {
+            std::ifstream file(file_name, std::ios::binary);
+            if (!file)
+            {
+                llvm::errs() << "[ERROR] Failed to open fixes file: " << file_name << "\n";
+                return false;
+            }
+
+            std::string line;
+            if (!std::getline(file, line) || (line != FIXES_HEADER + "\t" + std::to_string(FIXES_VERSION)))
+            {
+                llvm::errs() << "[ERROR] Invalid header of fixes file: " << file_name << "\n";
+                return false;
+            }
+
+            fixes_type loaded;
+            file_fixes* current = nullptr;
+
+            unsigned line_number = 1;
+            while (std::getline(file, line))
+            {
+                ++line_number;
+
+                const auto fields = split(line, 4);
+                if ((fields.size() == 4) && (fields[0] == "F"))
+                {
+                    std::string path;
+                    if (!unescape(fields[1], path))
+                    {
+                        break;
+                    }
+
+                    current = &loaded[path];
+                    current->state.size = static_cast<std::size_t>(std::stoull(fields[2]));
+                    current->state.hash = fields[3];
+                    continue;
+                }
+
+                if ((fields.size() == 4) && (fields[0] == "R") && (current != nullptr))
+                {
+                    std::string text;
+                    if (!unescape(fields[3], text))
+                    {
+                        break;
+                    }
+
+                    const auto offset = static_cast<unsigned>(std::stoul(fields[1]));
+                    const auto length = static_cast<unsigned>(std::stoul(fields[2]));
+                    current->edits[std::make_pair(offset, length)].push_back(text);
+                    continue;
+                }
+
+                llvm::errs() << "[ERROR] Invalid record at line " << line_number << " of fixes file: " << file_name << "\n";
+                return false;
+            }
+
+            if (!file.eof())
+            {
+                llvm::errs() << "[ERROR] Invalid record at line " << line_number << " of fixes file: " << file_name << "\n";
+                return false;
+            }
+
+            for (const auto& loaded_file : loaded)
+            {
+                auto found = fixes.find(loaded_file.first);
+                if (found == fixes.end())
+                {
+                    fixes.insert(loaded_file);
+                    continue;
+                }
+
+                if (found->second.state.hash != loaded_file.second.state.hash)
+                {
+                    llvm::errs() << "[ERROR] Fixes of " << loaded_file.first << " were computed from different versions of file, re-run analysis.\n";
+                    return false;
+                }
+
+                merge_edits(loaded_file.first, loaded_file.second.edits, found->second.edits);
+            }
+
+            return true;
+        }
+
+        /// \brief Apply merged fixes to single source file.
+        bool apply_file(const std::string& path, const file_fixes& fixes)
+        {
+            std::string content;
+            if (!read_content(path, content))
+            {
+                llvm::errs() << "[ERROR] Failed to read source file: " << path << "\n";
+                return false;
+            }
+
+            if ((content.size() != fixes.state.size) || (content_hash(content) != fixes.state.hash))
+            {
+                llvm::errs() << "[ERROR] Source file changed since analysis, skipping: " << path << "\n";
+                return false;
+            }
+
+            std::string result;
+            result.reserve(content.size());
+
+            std::size_t position = 0;
+            for (const auto& edit : fixes.edits)
+            {
+                const std::size_t offset = edit.first.first;
+                const std::size_t length = edit.first.second;
+
+                if ((offset < position) || (offset + length > content.size()))
+                {
+                    llvm::errs() << "[WARNING] Overlapping fix of " << path << " at offset " << offset << " skipped.\n";
+                    continue;
+                }
+
+                if ((length != 0) && (edit.second.size() > 1))
+                {
+                    llvm::errs() << "[WARNING] Conflicting fixes of " << path << " at offset " << offset << ", keeping the first one.\n";
+                }
+
+                result.append(content, position, offset - position);
+                if (length == 0)
+                {
+                    for (const auto& text : edit.second)
+                    {
+                        result += text;
+                    }
+                }
+                else
+                {
+                    result += edit.second.front();
+                }
+                position = offset + length;
+            }
+            result.append(content, position, std::string::npos);
+
+            if (result == content)
+            {
+                return true;
+            }
+
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            if (!file.write(result.data(), static_cast<std::streamsize>(result.size())))
+            {
+                llvm::errs() << "[ERROR] Failed to write source file: " << path << "\n";
+                return false;
+            }
+
+            return true;
+        }
+
+    } // namespace
+
+    // Interface.
+    //==========================================================================
+
+    /// \brief Save replacements of single run to fixes file.
+    ///
+    /// Paths are made absolute and replacements are sorted and deduplicated,
+    /// so the file doesn't depend on order in which boxes were optimized.
+    /// State of every modified source file is recorded to detect stale fixes.
+    bool save_fixes(const std::string& file_name, const Replacements& replacements)
+    {
+        std::map<std::string, std::set<std::pair<std::pair<unsigned, unsigned>, std::string> > > files;
+        for (const auto& replacement : replacements)
+        {
+            if (!replacement.isApplicable())
+            {
+                continue;
+            }
+
+            auto key = std::make_pair(replacement.getOffset(), replacement.getLength());
+            files[absolute_path(replacement.getFilePath())].insert(std::make_pair(key, replacement.getReplacementText().str()));
+        }
+
+        std::ostringstream os;
+        os << FIXES_HEADER << '\t' << FIXES_VERSION << '\n';
+
+        for (const auto& file : files)
+        {
+            std::string content;
+            if (!read_content(file.first, content))
+            {
+                llvm::errs() << "[ERROR] Failed to read source file: " << file.first << "\n";
+                return false;
+            }
+
+            os << "F\t" << escape(file.first) << '\t' << content.size() << '\t' << content_hash(content) << '\n';
+            for (const auto& edit : file.second)
+            {
+                os << "R\t" << edit.first.first << '\t' << edit.first.second << '\t' << escape(edit.second) << '\n';
+            }
+        }
+
+        std::ofstream file(file_name, std::ios::binary | std::ios::trunc);
+        const std::string text = os.str();
+        return static_cast<bool>(file.write(text.data(), static_cast<std::streamsize>(text.size())));
+    }
+
+    /// \brief Merge fixes files and apply them to sources.
+    ///
+    /// Fixes files are merged in sorted order of their names, so result
+    /// doesn't depend on order given by build system. Fixes are applied
+    /// only to source files that didn't change since analysis.
+    bool apply_fixes(const std::vector<std::string>& file_names)
+    {
+        std::vector<std::string> sorted(file_names);
+        std::sort(std::begin(sorted), std::end(sorted));
+
+        fixes_type fixes;
+        for (const auto& file_name : sorted)
+        {
+            if (!load_fixes(file_name, fixes))
+            {
+                return false;
+            }
+        }
+
+        bool result = true;
+        for (const auto& file : fixes)
+        {
+            if (!apply_file(file.first, file.second))
+            {
+                result = false;
+            }
+        }
+
+        return result;
+    }
+
+} // namespace
@@ -0,0 +1,39 @@
+/// \file bobopt_fixes.hpp File contains export of replacements to fixes files
+/// and their merging and application in separate step.
+///
+/// Build systems can run the optimizer over translation units in parallel
+/// processes, each exporting its own fixes file, and apply all fixes at once
+/// when analysis is done. Fixes file is deterministic, the same translation
+/// unit always produces the same file, so build systems can also cache it.
+///
+/// Format of fixes file, fields are separated by tabs, text is escaped:
+/// \code
+/// bobopt-fixes <version>
+/// F <absolute path> <size> <hash of content>
+/// R <offset> <length> <replacement text>
+/// ...
+/// \endcode
+/// Replacements follow the file record they belong to.
+
+#ifndef BOBOPT_FIXES_HPP_GUARD_
+#define BOBOPT_FIXES_HPP_GUARD_
+
+#include <clang/bobopt_clang_prolog.hpp>
+#include "clang/Tooling/Refactoring.h"
+#include <clang/bobopt_clang_epilog.hpp>
+
+#include <string>
+#include <vector>
+
+namespace bobopt
+{
+
+    /// \brief Save replacements of single run to fixes file.
+    bool save_fixes(const std::string& file_name, const clang::tooling::Replacements& replacements);
+
+    /// \brief Merge fixes files and apply them to sources.
+    bool apply_fixes(const std::vector<std::string>& file_names);
+
+} // namespace
+
+#endif // guard
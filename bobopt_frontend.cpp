@@ -0,0 +1,112 @@
+#include <bobopt_frontend.hpp>
+
+#include <bobopt_statistics.hpp>
+
+using namespace clang;
+using namespace clang::ast_matchers;
+
+namespace bobopt
+{
+
+    // timed_ast_consumer implementation.
+    //==============================================================================
+
+    /// \brief Take ownership of wrapped consumer.
+    timed_ast_consumer::timed_ast_consumer(std::unique_ptr<ASTConsumer> consumer)
+        : consumer_(std::move(consumer))
+        , parse_start_()
+    {
+        BOBOPT_ASSERT(consumer_ != nullptr);
+    }
+
+    /// \brief Deletable through pointer to base.
+    timed_ast_consumer::~timed_ast_consumer()
+    {
+    }
+
+    /// \brief Parsing of translation unit begins.
+    void timed_ast_consumer::Initialize(ASTContext& context)
+    {
+        parse_start_ = std::chrono::steady_clock::now();
+        consumer_->Initialize(context);
+    }
+
+    /// \brief Forward top level declarations.
+    bool timed_ast_consumer::HandleTopLevelDecl(DeclGroupRef group)
+    {
+        return consumer_->HandleTopLevelDecl(group);
+    }
+
+    /// \brief Parsing of translation unit ends, matchers are run by wrapped consumer.
+    void timed_ast_consumer::HandleTranslationUnit(ASTContext& context)
+    {
+        const double parse_time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - parse_start_).count();
+        time_report::instance().record("parse", parse_time);
+
+        scoped_timer timer("matchers");
+        consumer_->HandleTranslationUnit(context);
+    }
+
+    /// \brief Forward decision about skipping of function body.
+    bool timed_ast_consumer::shouldSkipFunctionBody(Decl* decl)
+    {
+        return consumer_->shouldSkipFunctionBody(decl);
+    }
+
+    // body_filter_ast_consumer implementation.
+    //==============================================================================
+
+    /// \brief Take ownership of wrapped consumer.
+    body_filter_ast_consumer::body_filter_ast_consumer(std::unique_ptr<ASTConsumer> consumer)
+        : consumer_(std::move(consumer))
+    {
+        BOBOPT_ASSERT(consumer_ != nullptr);
+    }
+
+    /// \brief Deletable through pointer to base.
+    body_filter_ast_consumer::~body_filter_ast_consumer()
+    {
+    }
+
+    /// \brief Forward initialization.
+    void body_filter_ast_consumer::Initialize(ASTContext& context)
+    {
+        consumer_->Initialize(context);
+    }
+
+    /// \brief Forward top level declarations.
+    bool body_filter_ast_consumer::HandleTopLevelDecl(DeclGroupRef group)
+    {
+        return consumer_->HandleTopLevelDecl(group);
+    }
+
+    /// \brief Forward translation unit to matchers.
+    void body_filter_ast_consumer::HandleTranslationUnit(ASTContext& context)
+    {
+        consumer_->HandleTranslationUnit(context);
+    }
+
+    /// \brief Skip bodies of functions in system headers optimizer doesn't need.
+    bool body_filter_ast_consumer::shouldSkipFunctionBody(Decl* decl)
+    {
+        if (optimizer::needs_body(decl))
+        {
+            return false;
+        }
+
+        statistics::instance().increment("parse.skipped_bodies");
+        return true;
+    }
+
+    // Matchers.
+    //==============================================================================
+
+    /// \brief Add matchers of boxes and Bobox classes handled by optimizer.
+    void add_box_matchers(MatchFinder& finder, bobopt::optimizer* optimizer)
+    {
+        finder.addMatcher(bobopt::optimizer::BOBOX_BOX_MATCHER, optimizer);
+        finder.addMatcher(bobopt::optimizer::BOBOX_BASIC_BOX_MATCHER, optimizer);
+        finder.addMatcher(bobopt::optimizer::USER_BOX_MATCHER, optimizer);
+    }
+
+} // namespace
@@ -0,0 +1,256 @@
+/// \file bobopt_frontend.hpp File contains frontend actions and AST consumers
+/// running optimizer over translation units, shared by bobopt executable and
+/// the library interface.
+
+#ifndef BOBOPT_FRONTEND_HPP_GUARD_
+#define BOBOPT_FRONTEND_HPP_GUARD_
+
+#include <bobopt_debug.hpp>
+#include <bobopt_macros.hpp>
+#include <bobopt_optimizer.hpp>
+#include <bobopt_time_report.hpp>
+#include <bobopt_utils.hpp>
+
+#include <clang/bobopt_clang_prolog.hpp>
+#include "clang/AST/ASTConsumer.h"
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/FrontendAction.h"
+#include "clang/Frontend/FrontendOptions.h"
+#include "clang/Tooling/Tooling.h"
+#include <clang/bobopt_clang_epilog.hpp>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace bobopt
+{
+
+    // timed_ast_consumer:
+    //==============================================================================
+
+    /// \brief Wrapper of AST consumer that measures parsing and matching of translation
+    /// unit for time report.
+    ///
+    /// Parsing starts with initialization of consumer and ends with handling of the whole
+    /// translation unit, where match finder runs matchers.
+    class timed_ast_consumer : public clang::ASTConsumer
+    {
+    public:
+
+        // create/destroy:
+        explicit timed_ast_consumer(std::unique_ptr<clang::ASTConsumer> consumer);
+        virtual ~timed_ast_consumer() BOBOPT_OVERRIDE;
+
+        // inherited overriden members:
+        virtual void Initialize(clang::ASTContext& context) BOBOPT_OVERRIDE;
+        virtual bool HandleTopLevelDecl(clang::DeclGroupRef group) BOBOPT_OVERRIDE;
+        virtual void HandleTranslationUnit(clang::ASTContext& context) BOBOPT_OVERRIDE;
+        virtual bool shouldSkipFunctionBody(clang::Decl* decl) BOBOPT_OVERRIDE;
+
+    private:
+        std::unique_ptr<clang::ASTConsumer> consumer_;
+        std::chrono::steady_clock::time_point parse_start_;
+    };
+
+    // body_filter_ast_consumer:
+    //==============================================================================
+
+    /// \brief Wrapper of AST consumer that lets parser skip bodies of functions
+    /// optimizer doesn't analyze.
+    ///
+    /// Parser asks only when \c SkipFunctionBodies front-end option is set and only
+    /// for bodies that Sema can skip, e.g., not for bodies of constexpr functions.
+    class body_filter_ast_consumer : public clang::ASTConsumer
+    {
+    public:
+
+        // create/destroy:
+        explicit body_filter_ast_consumer(std::unique_ptr<clang::ASTConsumer> consumer);
+        virtual ~body_filter_ast_consumer() BOBOPT_OVERRIDE;
+
+        // inherited overriden members:
+        virtual void Initialize(clang::ASTContext& context) BOBOPT_OVERRIDE;
+        virtual bool HandleTopLevelDecl(clang::DeclGroupRef group) BOBOPT_OVERRIDE;
+        virtual void HandleTranslationUnit(clang::ASTContext& context) BOBOPT_OVERRIDE;
+        virtual bool shouldSkipFunctionBody(clang::Decl* decl) BOBOPT_OVERRIDE;
+
+    private:
+        std::unique_ptr<clang::ASTConsumer> consumer_;
+    };
+
+
+    // optimizer_frontend_action_factory/optimizer_frontend_action implementation.
+    //==============================================================================
+
+    /// \brief A little wrapping to catch \c clang::CompilerInstance so we can access \c clang::Sema.
+    /// There's no other possibility to access those objects from code inside match finder handling
+    /// member function.
+    template <typename FactoryT>
+    class optimizer_frontend_action_factory : public clang::tooling::FrontendActionFactory
+    {
+    public:
+
+        // create/destroy:
+        optimizer_frontend_action_factory(FactoryT* factory, bobopt::optimizer* optimizer, bool skip_bodies);
+        virtual ~optimizer_frontend_action_factory() BOBOPT_OVERRIDE;
+
+        void set_dependencies(std::vector<std::string>* dependencies);
+
+        // inherited overriden members:
+        virtual clang::FrontendAction* create() BOBOPT_OVERRIDE;
+
+    private:
+
+        /// \brief Wrapper for ASTFrontendAction that will actually catch instance of \c clang::CompilerInstance
+        /// and pass this to optimizer object.
+        class optimizer_frontend_action : public clang::ASTFrontendAction
+        {
+        public:
+
+            // create/destroy:
+            optimizer_frontend_action(FactoryT* factory, bobopt::optimizer* optimizer, bool skip_bodies, std::vector<std::string>* dependencies);
+            virtual ~optimizer_frontend_action() BOBOPT_OVERRIDE;
+
+            // inherited overriden members:
+            virtual std::unique_ptr<clang::ASTConsumer> CreateASTConsumer(clang::CompilerInstance& compiler_instance, llvm::StringRef) BOBOPT_OVERRIDE;
+            virtual bool BeginSourceFileAction(clang::CompilerInstance& compiler_instance, llvm::StringRef file_name) BOBOPT_OVERRIDE;
+            virtual void EndSourceFileAction() BOBOPT_OVERRIDE;
+
+        private:
+            FactoryT* factory_;
+            bobopt::optimizer* optimizer_;
+            bool skip_bodies_;
+            std::vector<std::string>* dependencies_;
+        };
+
+        FactoryT* factory_;
+        bobopt::optimizer* optimizer_;
+        bool skip_bodies_;
+        std::vector<std::string>* dependencies_;
+    };
+
+    // optimizer_frontend_action implementation.
+    //==============================================================================
+
+    /// \brief Create frontend action with all needed addition information.
+    template <typename FactoryT>
+    optimizer_frontend_action_factory<FactoryT>::optimizer_frontend_action::optimizer_frontend_action(FactoryT* factory,
+                                                                                                    bobopt::optimizer* optimizer,
+                                                                                                    bool skip_bodies,
+                                                                                                    std::vector<std::string>* dependencies)
+        : factory_(factory)
+        , optimizer_(optimizer)
+        , skip_bodies_(skip_bodies)
+        , dependencies_(dependencies)
+    {
+    }
+
+    /// \brief Deletable through pointer to base.
+    template <typename FactoryT>
+    optimizer_frontend_action_factory<FactoryT>::optimizer_frontend_action::~optimizer_frontend_action()
+    {
+    }
+
+    /// \brief Immediately pass pointer to \c clang::CompilerInstance to optimizer object and create consumer using factory object.
+    ///
+    /// Parser reads \c SkipFunctionBodies option after consumer is created, so it can be still set here.
+    template <typename FactoryT>
+    std::unique_ptr<clang::ASTConsumer> optimizer_frontend_action_factory<FactoryT>::optimizer_frontend_action::CreateASTConsumer(clang::CompilerInstance& compiler_instance,
+                                                                                                           llvm::StringRef)
+    {
+        optimizer_->set_compiler(&compiler_instance);
+
+        std::unique_ptr<clang::ASTConsumer> consumer = factory_->newASTConsumer();
+
+        if (skip_bodies_)
+        {
+            compiler_instance.getFrontendOpts().SkipFunctionBodies = true;
+            consumer = make_unique<body_filter_ast_consumer>(std::move(consumer));
+        }
+
+        if (time_report::instance().enabled())
+        {
+            consumer = make_unique<timed_ast_consumer>(std::move(consumer));
+        }
+
+        return consumer;
+    }
+
+    /// \brief Start measurement of translation unit for time report.
+    template <typename FactoryT>
+    bool optimizer_frontend_action_factory<FactoryT>::optimizer_frontend_action::BeginSourceFileAction(clang::CompilerInstance&, llvm::StringRef file_name)
+    {
+        if (time_report::instance().enabled())
+        {
+            time_report::instance().begin_unit(file_name);
+        }
+
+        return true;
+    }
+
+    /// \brief Finish measurement of translation unit for time report and record files it was parsed from.
+    template <typename FactoryT>
+    void optimizer_frontend_action_factory<FactoryT>::optimizer_frontend_action::EndSourceFileAction()
+    {
+        if (time_report::instance().enabled())
+        {
+            time_report::instance().end_unit();
+        }
+
+        if (dependencies_ != nullptr)
+        {
+            clang::SourceManager& sm = getCompilerInstance().getSourceManager();
+            for (auto it = sm.fileinfo_begin(); it != sm.fileinfo_end(); ++it)
+            {
+                dependencies_->push_back(it->first->getName());
+            }
+        }
+    }
+
+    // optimizer_frontend_action_factory implementation.
+    //==============================================================================
+
+    /// \brief Create factory with all needed additional information.
+    template <typename FactoryT>
+    optimizer_frontend_action_factory<FactoryT>::optimizer_frontend_action_factory(FactoryT* factory, bobopt::optimizer* optimizer, bool skip_bodies)
+        : factory_(factory)
+        , optimizer_(optimizer)
+        , skip_bodies_(skip_bodies)
+        , dependencies_(nullptr)
+    {
+        BOBOPT_ASSERT(factory != nullptr);
+        BOBOPT_ASSERT(optimizer != nullptr);
+    }
+
+    /// \brief Deletable through pointer to base.
+    template <typename FactoryT>
+    optimizer_frontend_action_factory<FactoryT>::~optimizer_frontend_action_factory()
+    {
+    }
+
+    /// \brief Collect paths of files translation units are parsed from, \c nullptr stops collecting.
+    template <typename FactoryT>
+    void optimizer_frontend_action_factory<FactoryT>::set_dependencies(std::vector<std::string>* dependencies)
+    {
+        dependencies_ = dependencies;
+    }
+
+    /// \brief Create wrapper of frontend action to catch \c clang::CompilerInstance.
+    template <typename FactoryT>
+    clang::FrontendAction* optimizer_frontend_action_factory<FactoryT>::create()
+    {
+        return new optimizer_frontend_action(factory_, optimizer_, skip_bodies_, dependencies_);
+    }
+
+    // Matchers.
+    //==============================================================================
+
+    void add_box_matchers(clang::ast_matchers::MatchFinder& finder, bobopt::optimizer* optimizer);
+
+} // namespace
+
+#endif // guard
@@ -0,0 +1,363 @@
+#include <bobopt_library.hpp>
+
+#include <bobopt_config.hpp>
+#include <bobopt_fixes.hpp>
+#include <bobopt_frontend.hpp>
+#include <bobopt_pch.hpp>
+#include <bobopt_prescan.hpp>
+#include <bobopt_statistics.hpp>
+#include <bobopt_time_report.hpp>
+#include <bobopt_utils.hpp>
+
+#include <clang/bobopt_clang_prolog.hpp>
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+#include "clang/Tooling/Refactoring.h"
+#include "clang/Tooling/Tooling.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include <clang/bobopt_clang_epilog.hpp>
+
+#include <algorithm>
+#include <map>
+
+using namespace clang;
+using namespace clang::ast_matchers;
+using namespace clang::tooling;
+
+namespace bobopt
+{
+
+    // TU helpers.
+    //==========================================================================
+
+    namespace
+    {
+
+        /// \brief Absolute path without "." and ".." components, different spellings
+        /// of the same file compare equal.
+        std::string normalize_path(const std::string& path)
+        {
+            llvm::SmallString<256> absolute(path);
+            llvm::sys::fs::make_absolute(absolute);
+
+            std::vector<llvm::StringRef> components;
+            const llvm::StringRef relative = llvm::sys::path::relative_path(absolute);
+            for (auto it = llvm::sys::path::begin(relative); it != llvm::sys::path::end(relative); ++it)
+            {
+                if (*it == ".")
+                {
+                    continue;
+                }
+
+                if (*it == "..")
+                {
+                    if (!components.empty())
+                    {
+                        components.pop_back();
+                    }
+                    continue;
+                }
+
+                components.push_back(*it);
+            }
+
+            llvm::SmallString<256> result(llvm::sys::path::root_path(absolute));
+            for (const auto& component : components)
+            {
+                llvm::sys::path::append(result, component);
+            }
+
+            return result.str();
+        }
+
+        /// \brief Replacements grouped by normalized path of file.
+        ///
+        /// Replacements are ordered by path as spelled, relative and absolute
+        /// spellings of the same file would interleave. Same replacement with
+        /// different spellings is kept once.
+        std::map<std::string, Replacements> group_by_file(const Replacements& replacements)
+        {
+            std::map<std::string, Replacements> files;
+            for (const auto& replacement : replacements)
+            {
+                const std::string path = normalize_path(replacement.getFilePath());
+                files[path].insert(Replacement(path, replacement.getOffset(), replacement.getLength(), replacement.getReplacementText()));
+            }
+
+            return files;
+        }
+
+        /// \brief Apply replacements of file to its content in memory.
+        ///
+        /// Replacements of single file are ordered by offset, overlapping ones
+        /// are skipped.
+        bool apply_to_content(const std::string& path, const Replacements& replacements, std::string& content)
+        {
+            std::string result;
+            result.reserve(content.size());
+
+            bool applied = true;
+            std::size_t position = 0;
+            for (const auto& replacement : replacements)
+            {
+                const std::size_t offset = replacement.getOffset();
+                const std::size_t length = replacement.getLength();
+                if ((offset < position) || (offset + length > content.size()))
+                {
+                    llvm::errs() << "[WARNING] Overlapping replacement of " << path << " at offset " << offset << " skipped.\n";
+                    applied = false;
+                    continue;
+                }
+
+                result.append(content, position, offset - position);
+                result += replacement.getReplacementText();
+                position = offset + length;
+            }
+            result.append(content, position, std::string::npos);
+
+            content.swap(result);
+            return applied;
+        }
+
+    } // namespace
+
+    // batch_optimizer implementation.
+    //==========================================================================
+
+    batch_optimizer::batch_optimizer(const CompilationDatabase& compilations, modes mode)
+        : compilations_(compilations)
+        , mode_(mode)
+        , skip_bodies_(true)
+        , prescan_(true)
+        , pch_compilations_()
+        , export_fixes_()
+        , stats_file_()
+        , time_report_(false)
+        , replacements_()
+        , header_replacements_()
+    {
+    }
+
+    batch_optimizer::~batch_optimizer()
+    {
+    }
+
+    /// \brief Let parser skip bodies of functions optimizer doesn't analyze (default).
+    void batch_optimizer::set_skip_bodies(bool skip_bodies)
+    {
+        skip_bodies_ = skip_bodies;
+    }
+
+    /// \brief Skip files lexical pre-scan finds without boxes (default).
+    void batch_optimizer::set_prescan(bool prescan)
+    {
+        prescan_ = prescan;
+    }
+
+    /// \brief Precompile header with common includes once and include it in all translation units.
+    void batch_optimizer::set_pch(const std::string& header, const std::string& cache_dir)
+    {
+        pch_compilations_ = make_unique<pch_database>(compilations_, header, cache_dir);
+    }
+
+    /// \brief Save replacements of files to fixes file instead of modifying files.
+    void batch_optimizer::set_export_fixes(const std::string& file_name)
+    {
+        export_fixes_ = file_name;
+    }
+
+    /// \brief Save statistics in JSON after each batch.
+    void batch_optimizer::set_stats_file(const std::string& file_name)
+    {
+        stats_file_ = file_name;
+        statistics::instance().enable();
+    }
+
+    /// \brief Print time report of optimizer phases after each batch.
+    void batch_optimizer::set_time_report(bool time_report)
+    {
+        time_report_ = time_report;
+        if (time_report_)
+        {
+            time_report::instance().enable();
+        }
+    }
+
+    /// \brief Load configuration file, variables it doesn't set keep their values.
+    bool batch_optimizer::load_config(const std::string& file_name)
+    {
+        config_parser parser;
+        return parser.load(file_name);
+    }
+
+    /// \brief Compilation database translation units are parsed with.
+    const CompilationDatabase& batch_optimizer::get_compilations() const
+    {
+        if (pch_compilations_ != nullptr)
+        {
+            return *pch_compilations_;
+        }
+
+        return compilations_;
+    }
+
+    /// \brief Sources lexical pre-scan finds with boxes, all sources without pre-scan.
+    std::vector<std::string> batch_optimizer::scan_sources(const std::vector<std::string>& sources) const
+    {
+        std::vector<std::string> scanned = sources;
+        if (!prescan_)
+        {
+            return scanned;
+        }
+
+        scoped_timer timer("prescan");
+
+        prescan scanner;
+        auto skip = [&](const std::string& source) -> bool
+        {
+            if (scanner.may_contain_box(compilations_, source))
+            {
+                return false;
+            }
+
+            statistics::instance().increment("prescan.skipped_units");
+            return true;
+        };
+        scanned.erase(std::remove_if(scanned.begin(), scanned.end(), skip), scanned.end());
+
+        const size_t skipped = sources.size() - scanned.size();
+        if ((skipped != 0) && ((mode_ == MODE_DIAGNOSTIC) || (mode_ == MODE_INTERACTIVE)))
+        {
+            llvm::errs() << "Skipped " << skipped << " of " << sources.size() << " translation units without boxes.\n";
+        }
+
+        return scanned;
+    }
+
+    /// \brief Optimize source files and save modified files, or export fixes file.
+    bool batch_optimizer::optimize_files(const std::vector<std::string>& sources)
+    {
+        replacements_.clear();
+
+        RefactoringTool tool(get_compilations(), scan_sources(sources));
+        bobopt::optimizer optimizer(mode_, &tool.getReplacements());
+
+        MatchFinder finder;
+        add_box_matchers(finder, &optimizer);
+
+        optimizer_frontend_action_factory<MatchFinder> frontend_action_factory(&finder, &optimizer, skip_bodies_);
+
+        int result = 0;
+        {
+            scoped_measurement measurement("tool");
+            if (!export_fixes_.empty())
+            {
+                scoped_timer timer("run");
+                result = tool.run(&frontend_action_factory);
+
+                if (!save_fixes(export_fixes_, tool.getReplacements()))
+                {
+                    llvm::errs() << "Failed to save fixes to: " << export_fixes_ << '\n';
+                    result = 1;
+                }
+            }
+            else
+            {
+                scoped_timer timer("runAndSave");
+                result = tool.runAndSave(&frontend_action_factory);
+            }
+        }
+
+        replacements_ = tool.getReplacements();
+        report();
+        return result == 0;
+    }
+
+    /// \brief Optimize sources in memory, files on disk aren't read nor modified.
+    ///
+    /// Buffers have to be described by compilation database as if they were files.
+    /// Replacements of other files, e.g., headers with boxes, aren't applied, see
+    /// \c get_header_replacements().
+    bool batch_optimizer::optimize_buffers(std::vector<source_buffer>& buffers)
+    {
+        replacements_.clear();
+        header_replacements_.clear();
+
+        // Tool keeps references to paths and contents of mapped files.
+        std::vector<std::string> paths;
+        paths.reserve(buffers.size());
+        for (const auto& buffer : buffers)
+        {
+            paths.push_back(normalize_path(buffer.file_name));
+        }
+
+        ClangTool tool(get_compilations(), paths);
+        for (size_t i = 0; i < buffers.size(); ++i)
+        {
+            tool.mapVirtualFile(paths[i], buffers[i].content);
+        }
+
+        bobopt::optimizer optimizer(mode_, &replacements_);
+
+        MatchFinder finder;
+        add_box_matchers(finder, &optimizer);
+
+        optimizer_frontend_action_factory<MatchFinder> frontend_action_factory(&finder, &optimizer, skip_bodies_);
+        bool result = (tool.run(&frontend_action_factory) == 0);
+
+        std::map<std::string, Replacements> files = group_by_file(replacements_);
+        for (size_t i = 0; i < buffers.size(); ++i)
+        {
+            auto found = files.find(paths[i]);
+            if (found == files.end())
+            {
+                continue;
+            }
+
+            result = apply_to_content(paths[i], found->second, buffers[i].content) && result;
+            files.erase(found);
+        }
+
+        for (const auto& file : files)
+        {
+            header_replacements_.insert(file.second.begin(), file.second.end());
+        }
+
+        report();
+        return result;
+    }
+
+    /// \brief Replacements of the last optimized batch.
+    const Replacements& batch_optimizer::get_replacements() const
+    {
+        return replacements_;
+    }
+
+    /// \brief Replacements of files which aren't buffers of the last \c optimize_buffers() call.
+    ///
+    /// Paths of replacements are normalized, optimizer doesn't apply them.
+    const Replacements& batch_optimizer::get_header_replacements() const
+    {
+        return header_replacements_;
+    }
+
+    /// \brief Print time report and save statistics, if enabled.
+    ///
+    /// Batches report themselves, runs of optimizer outside of batch, e.g.,
+    /// what-if or server, share its settings by calling it directly.
+    void batch_optimizer::report() const
+    {
+        if (time_report_)
+        {
+            time_report::instance().print(llvm::errs());
+        }
+
+        if (!stats_file_.empty() && !statistics::instance().save(stats_file_))
+        {
+            llvm::errs() << "Failed to save statistics to: " << stats_file_ << '\n';
+        }
+    }
+
+} // namespace
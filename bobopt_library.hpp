@@ -0,0 +1,102 @@
+/// \file bobopt_library.hpp File contains interface for embedding the optimizer
+/// into other tools.
+///
+/// Optimizer processes a batch of translation units in single run, compilation
+/// database and configuration are loaded once for all of them:
+/// \code
+/// std::string error;
+/// auto compilations = clang::tooling::CompilationDatabase::autoDetectFromDirectory(build_dir, error);
+///
+/// bobopt::batch_optimizer optimizer(*compilations, bobopt::MODE_BUILD);
+/// optimizer.load_config("bobopt.cfg");
+/// optimizer.optimize_files(sources);
+/// \endcode
+///
+/// Configuration variables, statistics and time report are global, only one
+/// batch optimizer should run at a time. Command line tool is built on it.
+
+#ifndef BOBOPT_LIBRARY_HPP_GUARD_
+#define BOBOPT_LIBRARY_HPP_GUARD_
+
+#include <bobopt_macros.hpp>
+#include <bobopt_optimizer.hpp>
+
+#include <clang/bobopt_clang_prolog.hpp>
+#include "clang/Tooling/CompilationDatabase.h"
+#include "clang/Tooling/Refactoring.h"
+#include <clang/bobopt_clang_epilog.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace bobopt
+{
+
+    // forward declarations:
+    class pch_database;
+
+    // source_buffer:
+    //==========================================================================
+
+    /// \brief Source file optimized in memory.
+    struct source_buffer
+    {
+        /// \brief Path of file in compilation database.
+        std::string file_name;
+        /// \brief Source code, replaced by optimized source code.
+        std::string content;
+    };
+
+    // batch_optimizer:
+    //==========================================================================
+
+    /// \brief Optimizer of list of translation units in single process.
+    class batch_optimizer
+    {
+    public:
+        batch_optimizer(const clang::tooling::CompilationDatabase& compilations, modes mode);
+        ~batch_optimizer();
+
+        void set_skip_bodies(bool skip_bodies);
+        void set_prescan(bool prescan);
+        void set_pch(const std::string& header, const std::string& cache_dir);
+        void set_export_fixes(const std::string& file_name);
+        void set_stats_file(const std::string& file_name);
+        void set_time_report(bool time_report);
+
+        bool load_config(const std::string& file_name);
+
+        const clang::tooling::CompilationDatabase& get_compilations() const;
+        std::vector<std::string> scan_sources(const std::vector<std::string>& sources) const;
+
+        bool optimize_files(const std::vector<std::string>& sources);
+        bool optimize_buffers(std::vector<source_buffer>& buffers);
+
+        const clang::tooling::Replacements& get_replacements() const;
+        const clang::tooling::Replacements& get_header_replacements() const;
+
+        void report() const;
+
+    private:
+        BOBOPT_NONCOPYMOVABLE(batch_optimizer);
+
+        const clang::tooling::CompilationDatabase& compilations_;
+        modes mode_;
+        bool skip_bodies_;
+        bool prescan_;
+        /// \brief Compilation database including precompiled header, empty without it.
+        std::unique_ptr<pch_database> pch_compilations_;
+        /// \brief Fixes file replacements are saved to instead of modifying files.
+        std::string export_fixes_;
+        std::string stats_file_;
+        bool time_report_;
+        /// \brief Replacements of the last batch.
+        clang::tooling::Replacements replacements_;
+        /// \brief Replacements of the last batch of buffers that weren't applied.
+        clang::tooling::Replacements header_replacements_;
+    };
+
+} // namespace
+
+#endif // guard
@@ -1,6 +1,15 @@
 #include <bobopt_method.hpp>
 
+#include <bobopt_diagnostic.hpp>
 #include <bobopt_inline.hpp>
+#include <bobopt_macros.hpp>
+#include <bobopt_optimizer.hpp>
+#include <bobopt_statistics.hpp>
+
+#include <clang/bobopt_clang_prolog.hpp>
+#include "llvm/Support/raw_ostream.h"
+#include "clang/AST/Decl.h"
+#include <clang/bobopt_clang_epilog.hpp>
 
 #include BOBOPT_INLINE_IN_SOURCE(bobopt_method.inl)
 
@@ -15,4 +24,50 @@ namespace bobopt
     {
     }
 
+    /// \brief Replacements of all instantiations are kept by default.
+    basic_method::merge_policies basic_method::get_merge_policy() const
+    {
+        return MERGE_UNION;
+    }
+
+    /// \brief Methods merged by optimizer keep no state of instantiations.
+    void basic_method::begin_merge(const std::string& key)
+    {
+        BOBOPT_UNUSED_EXPRESSION(key);
+    }
+
+    /// \brief Methods merged by optimizer keep no state of instantiations.
+    void basic_method::end_merge(clang::CXXRecordDecl* box_declaration, clang::tooling::Replacements* replacements)
+    {
+        BOBOPT_UNUSED_EXPRESSION(box_declaration);
+        BOBOPT_UNUSED_EXPRESSION(replacements);
+    }
+
+    box_context& basic_method::get_context() const
+    {
+        return get_optimizer().get_box_context();
+    }
+
+    /// \brief Count exceeded budget and tell user what was done instead of full analysis.
+    ///
+    /// \param decl Declaration whose analysis exceeded budget.
+    /// \param method Name of optimization method.
+    /// \param limit Name of exceeded limit.
+    /// \param fallback Description of action taken instead of full analysis.
+    void basic_method::report_budget_exceeded(const clang::NamedDecl* decl, const std::string& method, const std::string& limit, const std::string& fallback) const
+    {
+        statistics::instance().increment("budget." + method + "." + limit);
+
+        const std::string message = method + " analysis exceeded " + limit + " budget, " + fallback;
+        if (get_optimizer().verbose())
+        {
+            const diagnostic& diag = get_optimizer().get_diagnostic();
+            diag.emit(diag.get_message_decl(diagnostic_message::info, decl, message + ":"));
+        }
+        else
+        {
+            llvm::errs() << "[WARNING] " << message << ": " << decl->getQualifiedNameAsString() << "\n";
+        }
+    }
+
 } // namespace
@@ -10,16 +10,20 @@
 #include "clang/Tooling/Refactoring.h"
 #include <clang/bobopt_clang_epilog.hpp>
 
+#include <string>
+
 // forward declarations:
 namespace clang
 {
     class CXXRecordDecl;
+    class NamedDecl;
 }
 
 namespace bobopt
 {
 
     // forward declarations:
+    class box_context;
     class optimizer;
 
     /// \brief Interface for any optimization method in the optimizer.
@@ -27,6 +31,18 @@ namespace bobopt
     class basic_method
     {
     public:
+        /// \brief Policies of merging replacements of box template instantiations
+        /// into template source.
+        enum merge_policies
+        {
+            /// Keep replacements of all instantiations.
+            MERGE_UNION,
+            /// Keep in each member function replacements of instantiation with most of them.
+            MERGE_WORST_CASE,
+            /// Method merges decisions of instantiations itself, see \c end_merge().
+            MERGE_METHOD
+        };
+
         basic_method();
         virtual ~basic_method();
 
@@ -39,9 +55,34 @@ namespace bobopt
         /// used in \code RefactoringTool.
         virtual void optimize(clang::CXXRecordDecl* box_declaration, clang::tooling::Replacements* replacements) = 0;
 
+        /// \brief Policy of merging replacements of instantiations of box template.
+        virtual merge_policies get_merge_policy() const;
+
+        /// \brief Following \c optimize() calls analyze instantiations of single box template.
+        ///
+        /// \param key Identifies box template and configuration for the whole run,
+        /// translation units with new instantiations of template merge them with
+        /// instantiations of previous translation units.
+        virtual void begin_merge(const std::string& key);
+
+        /// \brief Insert merged decisions of instantiations into template source.
+        ///
+        /// Called only for methods with \c MERGE_METHOD policy, replacements of
+        /// \c optimize() calls since \c begin_merge() are discarded.
+        ///
+        /// \param box_declaration Pointer to the AST node representing the box
+        /// template declaration.
+        /// \param replacements Pointer to the set of replacements of template source.
+        virtual void end_merge(clang::CXXRecordDecl* box_declaration, clang::tooling::Replacements* replacements);
+
     protected:
         /// \brief Acess to the optimizer main object.
         const optimizer& get_optimizer() const;
+        /// \brief Access to the analysis context of the box being optimized.
+        box_context& get_context() const;
+
+        /// \brief Report analysis of declaration that exceeded its budget.
+        void report_budget_exceeded(const clang::NamedDecl* decl, const std::string& method, const std::string& limit, const std::string& fallback) const;
 
     private:
         friend class optimizer;
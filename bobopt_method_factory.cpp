@@ -4,8 +4,14 @@
 namespace bobopt
 {
 
-    method_factory_function method_factory::factories_[OM_COUNT] = { create_prefetch,     // OM_PREFETCH
-                                                                     create_yield_complex // OM_YIELD_COMPLEX
+    method_factory_function method_factory::factories_[OM_COUNT] = { create_prefetch,      // OM_PREFETCH
+                                                                     create_yield_complex, // OM_YIELD_COMPLEX
+                                                                     create_profile_probes // OM_PROFILE_PROBES
+    };
+
+    const char* method_factory::names_[OM_COUNT] = { "prefetch",      // OM_PREFETCH
+                                                     "yield_complex", // OM_YIELD_COMPLEX
+                                                     "profile_probes" // OM_PROFILE_PROBES
     };
 
     basic_method* method_factory::create(method_type method)
@@ -17,4 +23,10 @@ namespace bobopt
         return result;
     }
 
+    const char* method_factory::get_name(method_type method)
+    {
+        BOBOPT_ASSERT(method < OM_COUNT);
+        return names_[method];
+    }
+
 } // namespace
\ No newline at end of file
@@ -18,6 +18,7 @@ namespace bobopt
     {
         OM_PREFETCH = 0,
         OM_YIELD_COMPLEX = 1,
+        OM_PROFILE_PROBES = 2,
 
         OM_COUNT
     };
@@ -27,6 +28,7 @@ namespace bobopt
 
     basic_method* create_prefetch();
     basic_method* create_yield_complex();
+    basic_method* create_profile_probes();
 
     /// \brief Class that handles mapping factory methods to enumeration type.
     ///
@@ -35,9 +37,11 @@ namespace bobopt
     {
     public:
         static basic_method* create(method_type method);
+        static const char* get_name(method_type method);
 
     private:
         static method_factory_function factories_[OM_COUNT];
+        static const char* names_[OM_COUNT];
     };
 
 } // namespace
@@ -1,15 +1,29 @@
+#include <bobopt_analysis_context.hpp>
 #include <bobopt_debug.hpp>
 #include <bobopt_method.hpp>
 #include <bobopt_method_factory.hpp>
 #include <bobopt_optimizer.hpp>
+#include <bobopt_statistics.hpp>
+#include <bobopt_time_report.hpp>
+#include <bobopt_utils.hpp>
+#include <bobopt_what_if.hpp>
 
 #include <clang/bobopt_clang_prolog.hpp>
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/Attr.h"
 #include "clang/AST/DeclCXX.h"
+#include "clang/AST/DeclTemplate.h"
 #include "clang/Basic/SourceManager.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
 #include <clang/bobopt_clang_epilog.hpp>
 
 #include <algorithm>
+#include <map>
 #include <string>
+#include <vector>
 
 #include BOBOPT_INLINE_IN_SOURCE(bobopt_optimizer.inl)
 
@@ -40,6 +54,12 @@ namespace bobopt
         , compiler_(nullptr)
         , replacements_(replacements)
         , diagnostic_(nullptr)
+        , box_context_(nullptr)
+        , analyzed_boxes_()
+        , templates_()
+        , config_directories_()
+        , what_if_(nullptr)
+        , costs_(nullptr)
     {
         BOBOPT_ASSERT(replacements != nullptr);
 
@@ -68,6 +88,8 @@ namespace bobopt
 
     void optimizer::run(const MatchFinder::MatchResult& result)
     {
+        scoped_timer timer("optimizer::run");
+
         auto user_box_decl = const_cast<CXXRecordDecl*>(result.Nodes.getNodeAs<CXXRecordDecl>("user_box"));
         if ((user_box_decl != nullptr) && user_box_decl->isThisDeclarationADefinition())
         {
@@ -83,6 +105,33 @@ namespace bobopt
                 return;
             }
 
+            // Instantiations of box template are analyzed together with the template.
+            if (is_box_instantiation(user_box_decl))
+            {
+                return;
+            }
+
+            // Box was already analyzed in other translation unit including the same header,
+            // its replacements are already recorded. Box template is analyzed again only
+            // for instantiations previous translation units didn't have.
+            const std::string fingerprint = get_fingerprint(user_box_decl);
+            const std::vector<CXXRecordDecl*> instantiations = get_instantiations(user_box_decl);
+            bool duplicate = false;
+            if (instantiations.empty() || (analyzed_boxes_.count(fingerprint) != 0))
+            {
+                duplicate = (templates_.count(fingerprint) != 0) || !analyzed_boxes_.insert(fingerprint).second;
+            }
+            else
+            {
+                duplicate = !has_new_instantiations(fingerprint, instantiations);
+            }
+
+            if (duplicate)
+            {
+                statistics::instance().increment("optimizer.duplicate_boxes");
+                return;
+            }
+
             apply_methods(user_box_decl);
             return;
         }
@@ -101,6 +150,45 @@ namespace bobopt
         }
     }
 
+    /// \brief Tests whether parser has to parse body of function for optimization.
+    ///
+    /// Methods analyze bodies of member functions of boxes and, to cost calls
+    /// and functors, bodies of functions they reach. All bodies of user code are
+    /// parsed. In system headers, only bodies of classes from Bobox namespace
+    /// and of function call operators (functors of standard algorithms) are
+    /// parsed, other bodies can be skipped by parser, which still handles their
+    /// declarations. Calls to skipped functions with empty body get inline
+    /// complexity instead of trivial one.
+    bool optimizer::needs_body(const Decl* decl)
+    {
+        if ((decl == nullptr) || !llvm::isa<FunctionDecl>(decl))
+        {
+            return true;
+        }
+
+        const SourceManager& sm = decl->getASTContext().getSourceManager();
+        if (!sm.isInSystemHeader(decl->getLocation()))
+        {
+            return true;
+        }
+
+        if (llvm::cast<FunctionDecl>(decl)->getOverloadedOperator() == OO_Call)
+        {
+            return true;
+        }
+
+        for (const DeclContext* context = decl->getDeclContext(); context != nullptr; context = context->getParent())
+        {
+            const auto* record = llvm::dyn_cast<CXXRecordDecl>(context);
+            if ((record != nullptr) && is_bobox_record(record))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
     void optimizer::create_method(method_type method)
     {
         BOBOPT_ASSERT(method < OM_COUNT);
@@ -121,23 +209,582 @@ namespace bobopt
         methods_[method] = nullptr;
     }
 
-    void optimizer::apply_methods(CXXRecordDecl* box_declaration) const
+    void optimizer::apply_methods(CXXRecordDecl* box_declaration)
     {
         BOBOPT_ASSERT(box_declaration != nullptr);
 
-        for (auto method : methods_)
+        scoped_timer timer("apply_methods");
+
+        if (what_if_ == nullptr)
+        {
+            apply_configured_methods(box_declaration);
+        }
+        else
+        {
+            // Replacements of each configuration are discarded, configurations are
+            // compared by decisions methods record.
+            what_if_->begin_box(box_declaration->getQualifiedNameAsString());
+
+            Replacements* replacements = replacements_;
+            for (size_t i = 0; i < what_if_->get_config_count(); ++i)
+            {
+                what_if_->set_config(i);
+
+                Replacements config_replacements;
+                replacements_ = &config_replacements;
+                apply_configured_methods(box_declaration);
+            }
+
+            replacements_ = replacements;
+        }
+
+        if (time_report::instance().enabled())
+        {
+            time_report::instance().add_item(time_report::IK_BOX, box_declaration->getQualifiedNameAsString(), timer.elapsed());
+        }
+    }
+
+    /// \brief Apply methods to box under current configuration.
+    void optimizer::apply_configured_methods(CXXRecordDecl* box_declaration)
+    {
+        BOBOPT_ASSERT(box_declaration != nullptr);
+
+        // Configuration files of box directory, what-if configuration and annotations tune
+        // analysis of this box only, overrides are restored at the end.
+        config_override overrides;
+        const SourceManager& sm = compiler_->getSourceManager();
+        const llvm::StringRef file_path = sm.getFilename(sm.getExpansionLoc(box_declaration->getLocation()));
+        if (!file_path.empty())
+        {
+            config_directories_.apply(file_path.str(), overrides);
+        }
+
+        if (what_if_ != nullptr)
+        {
+            what_if_->apply_config(overrides);
+        }
+
+        enabled_methods enabled;
+        enabled.fill(true);
+        apply_annotations(box_declaration, overrides, enabled);
+
+        const std::vector<CXXRecordDecl*> instantiations = get_instantiations(box_declaration);
+        if (instantiations.empty())
+        {
+            box_context_ = make_unique<box_context>(box_declaration, compiler_->getSourceManager());
+
+            for (size_t i = 0; i < methods_.size(); ++i)
+            {
+                basic_method* method = methods_[i];
+                if ((method != nullptr) && enabled[i])
+                {
+                    scoped_measurement measurement(std::string("method.") + method_factory::get_name(static_cast<method_type>(i)));
+
+                    method->optimizer_ = this;
+                    method->optimize(box_declaration, replacements_);
+                }
+            }
+
+            box_context_.reset();
+        }
+        else
+        {
+            apply_instantiation_methods(box_declaration, instantiations, enabled);
+        }
+    }
+
+    /// \brief Record decision of method for what-if analysis, nothing is recorded otherwise.
+    ///
+    /// \param subject Part of box decision is about, e.g., name of member function.
+    /// \param aspect What is decided, e.g., number of inserted yields.
+    void optimizer::record_decision(const std::string& subject, const std::string& aspect, const std::string& value) const
+    {
+        if (what_if_ != nullptr)
+        {
+            what_if_->record(subject, aspect, value);
+        }
+    }
+
+    /// \brief Record cost of the costliest path of member function of analyzed instantiation.
+    ///
+    /// Costs choose instantiation whose replacements are kept by \c MERGE_WORST_CASE
+    /// policy, nothing is recorded outside of box templates.
+    void optimizer::record_cost(const FunctionDecl* function, double cost) const
+    {
+        BOBOPT_ASSERT(function != nullptr);
+
+        if (costs_ != nullptr)
+        {
+            (*costs_)[get_location_key(function)] = cost;
+        }
+    }
+
+    /// \brief Analyze each instantiation of box template and merge replacements into template source.
+    ///
+    /// Cost of template code can differ by template arguments, so every instantiation
+    /// is analyzed on its own. Instantiated code has locations of template code,
+    /// replacements of all instantiations edit the same text and are merged by policy
+    /// of method.
+    /// Method with \c MERGE_METHOD policy merges its decisions itself, e.g., prefetch
+    /// inserts calls of all inputs instantiations need once.
+    ///
+    /// Results are kept for the whole run. Translation unit with new instantiations of
+    /// template analyzes only them and replaces merged replacements of previous ones.
+    void optimizer::apply_instantiation_methods(CXXRecordDecl* box_declaration, const std::vector<CXXRecordDecl*>& instantiations, const enabled_methods& enabled)
+    {
+        BOBOPT_ASSERT(box_declaration != nullptr);
+        BOBOPT_ASSERT(!instantiations.empty());
+
+        const std::string fingerprint = get_fingerprint(box_declaration);
+        const size_t config = (what_if_ != nullptr) ? what_if_->get_config() : 0;
+
+        std::vector<template_results>& configs = templates_[fingerprint];
+        if (configs.size() <= config)
         {
-            if (method != nullptr)
+            configs.resize(config + 1);
+        }
+        template_results& state = configs[config];
+
+        for (size_t i = 0; i < methods_.size(); ++i)
+        {
+            basic_method* method = methods_[i];
+            if ((method != nullptr) && enabled[i] && (method->get_merge_policy() == basic_method::MERGE_METHOD))
             {
                 method->optimizer_ = this;
-                method->optimize(box_declaration, replacements_);
+                method->begin_merge(fingerprint + ":" + std::to_string(config));
             }
         }
+
+        for (CXXRecordDecl* instantiation : instantiations)
+        {
+            const std::string key = get_specialization_name(instantiation);
+            if (std::find(state.keys.begin(), state.keys.end(), key) != state.keys.end())
+            {
+                continue;
+            }
+
+            statistics::instance().increment("optimizer.instantiations");
+
+            const size_t j = state.keys.size();
+            state.keys.push_back(key);
+            state.names.push_back(get_instantiation_name(instantiation));
+            state.costs.resize(j + 1);
+            for (auto& method_results : state.results)
+            {
+                method_results.resize(j + 1);
+            }
+
+            if (verbose())
+            {
+                diagnostic_->emit(diagnostic_->get_message_decl(diagnostic_message::info, box_declaration, "analysis of instantiation " + state.names[j] + ":"));
+            }
+
+            box_context_ = make_unique<box_context>(instantiation, compiler_->getSourceManager());
+            costs_ = &state.costs[j];
+
+            for (size_t i = 0; i < methods_.size(); ++i)
+            {
+                basic_method* method = methods_[i];
+                if ((method != nullptr) && enabled[i])
+                {
+                    scoped_measurement measurement(std::string("method.") + method_factory::get_name(static_cast<method_type>(i)));
+
+                    method->optimizer_ = this;
+                    method->optimize(instantiation, &state.results[i][j]);
+                }
+            }
+
+            costs_ = nullptr;
+            box_context_.reset();
+        }
+
+        Replacements merged;
+        for (size_t i = 0; i < methods_.size(); ++i)
+        {
+            basic_method* method = methods_[i];
+            if (method == nullptr)
+            {
+                continue;
+            }
+
+            if (method->get_merge_policy() == basic_method::MERGE_WORST_CASE)
+            {
+                merge_worst_case(box_declaration, state, i, merged);
+                continue;
+            }
+
+            if (method->get_merge_policy() == basic_method::MERGE_METHOD)
+            {
+                if (enabled[i])
+                {
+                    method->optimizer_ = this;
+                    method->end_merge(box_declaration, &merged);
+                }
+                continue;
+            }
+
+            for (const auto& replacements : state.results[i])
+            {
+                merged.insert(replacements.begin(), replacements.end());
+            }
+        }
+
+        // Replacements merged in previous translation units are superseded, those
+        // shared with other boxes, e.g., include of profile probes, are merged again.
+        for (const auto& replacement : state.merged)
+        {
+            if (merged.count(replacement) == 0)
+            {
+                replacements_->erase(replacement);
+            }
+        }
+
+        replacements_->insert(merged.begin(), merged.end());
+        state.merged.swap(merged);
+    }
+
+    /// \brief Apply tuning annotations of box, see annotations/bobopt_annotations.hpp.
+    ///
+    /// Annotation "bobopt:config:<group>:<variable>:<value>" overrides configuration
+    /// variable, "bobopt:disable:<method>" disables optimization method.
+    void optimizer::apply_annotations(const CXXRecordDecl* box_declaration, config_override& overrides, enabled_methods& enabled) const
+    {
+        BOBOPT_ASSERT(box_declaration != nullptr);
+
+        static const llvm::StringRef PREFIX("bobopt:");
+        static const llvm::StringRef CONFIG("config:");
+        static const llvm::StringRef DISABLE("disable:");
+
+        for (const AnnotateAttr* attr : box_declaration->specific_attrs<AnnotateAttr>())
+        {
+            llvm::StringRef annotation = attr->getAnnotation();
+            if (!annotation.startswith(PREFIX))
+            {
+                continue;
+            }
+
+            annotation = annotation.drop_front(PREFIX.size());
+
+            bool applied = false;
+            if (annotation.startswith(CONFIG))
+            {
+                // Value is the rest of annotation, it can contain colons.
+                const auto group = annotation.drop_front(CONFIG.size()).split(':');
+                const auto variable = group.second.split(':');
+                applied = overrides.set(group.first.str(), variable.first.str(), variable.second.str());
+            }
+            else if (annotation.startswith(DISABLE))
+            {
+                const llvm::StringRef name = annotation.drop_front(DISABLE.size());
+                for (size_t i = 0; i < enabled.size(); ++i)
+                {
+                    if (name == method_factory::get_name(static_cast<method_type>(i)))
+                    {
+                        enabled[i] = false;
+                        applied = true;
+                    }
+                }
+            }
+
+            if (!applied)
+            {
+                llvm::errs() << "[WARNING] Invalid annotation \"" << attr->getAnnotation() << "\" of box: " << box_declaration->getQualifiedNameAsString() << "\n";
+                continue;
+            }
+
+            statistics::instance().increment("optimizer.annotations");
+            if (verbose())
+            {
+                diagnostic_->emit(diagnostic_->get_message_decl(diagnostic_message::info, box_declaration, "box tuned by annotation " + annotation.str() + ":"));
+            }
+        }
+    }
+
+    /// \brief Keep in each member function of box template replacements of instantiation with the costliest path.
+    ///
+    /// Instantiation is chosen by cost of the costliest path method recorded for member
+    /// function, number of replacements decides between instantiations of the same
+    /// cost. Replacements outside of member function bodies are kept from all instantiations.
+    void optimizer::merge_worst_case(const CXXRecordDecl* box_declaration, const template_results& state, size_t method, Replacements& merged)
+    {
+        BOBOPT_ASSERT(method < OM_COUNT);
+
+        const std::vector<Replacements>& results = state.results[method];
+        BOBOPT_ASSERT(state.names.size() == results.size());
+        BOBOPT_ASSERT(state.costs.size() == results.size());
+
+        const SourceManager& sm = compiler_->getSourceManager();
+
+        // Ranges of member function definitions in template source.
+        struct method_range
+        {
+            const FunctionDecl* definition;
+            std::string key;
+            std::string file;
+            unsigned begin;
+            unsigned end;
+        };
+
+        std::vector<method_range> ranges;
+        for (const CXXMethodDecl* method_decl : box_declaration->methods())
+        {
+            const FunctionDecl* definition = nullptr;
+            if (!method_decl->hasBody(definition))
+            {
+                continue;
+            }
+
+            const SourceLocation begin = sm.getExpansionLoc(definition->getLocStart());
+            const SourceLocation end = sm.getExpansionLoc(definition->getLocEnd());
+
+            method_range range;
+            range.definition = definition;
+            range.key = get_location_key(definition);
+            range.file = sm.getFilename(begin).str();
+            range.begin = sm.getFileOffset(begin);
+            range.end = sm.getFileOffset(end);
+            ranges.push_back(range);
+        }
+
+        // Replacements grouped by member function and instantiation, ranges.size() stands for outside of member functions.
+        std::map<size_t, std::vector<Replacements> > groups;
+        for (size_t j = 0; j < results.size(); ++j)
+        {
+            for (const auto& replacement : results[j])
+            {
+                size_t index = 0;
+                while ((index < ranges.size()) && ((replacement.getFilePath() != ranges[index].file) || (replacement.getOffset() < ranges[index].begin) || (replacement.getOffset() > ranges[index].end)))
+                {
+                    ++index;
+                }
+
+                auto& group = groups[index];
+                group.resize(results.size());
+                group[j].insert(replacement);
+            }
+        }
+
+        for (const auto& group : groups)
+        {
+            if (group.first == ranges.size())
+            {
+                for (const auto& replacements : group.second)
+                {
+                    merged.insert(replacements.begin(), replacements.end());
+                }
+
+                continue;
+            }
+
+            // Instantiation without recorded cost, e.g., with predefined yields, is the cheapest one.
+            const std::string& key = ranges[group.first].key;
+            auto get_cost = [&](size_t j) -> double
+            {
+                auto found = state.costs[j].find(key);
+                return (found != state.costs[j].end()) ? found->second : -1.0;
+            };
+
+            size_t worst = 0;
+            for (size_t j = 1; j < group.second.size(); ++j)
+            {
+                const double cost = get_cost(j);
+                const double worst_cost = get_cost(worst);
+                if ((cost > worst_cost) || ((cost == worst_cost) && (group.second[j].size() > group.second[worst].size())))
+                {
+                    worst = j;
+                }
+            }
+
+            merged.insert(group.second[worst].begin(), group.second[worst].end());
+
+            if (verbose())
+            {
+                const std::string message = "decisions in member function taken from instantiation " + state.names[worst] + ":";
+                diagnostic_->emit(diagnostic_->get_message_decl(diagnostic_message::info, ranges[group.first].definition, message));
+            }
+        }
+    }
+
+    /// \brief Tests whether translation unit instantiates box template with arguments previous ones didn't.
+    bool optimizer::has_new_instantiations(const std::string& fingerprint, const std::vector<CXXRecordDecl*>& instantiations) const
+    {
+        auto found = templates_.find(fingerprint);
+        if ((found == templates_.end()) || found->second.empty())
+        {
+            return true;
+        }
+
+        const std::vector<std::string>& keys = found->second.front().keys;
+        for (const CXXRecordDecl* instantiation : instantiations)
+        {
+            if (std::find(keys.begin(), keys.end(), get_specialization_name(instantiation)) == keys.end())
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /// \brief Tests whether record is from Bobox namespace or derived from such record.
+    ///
+    /// Dependent bases can't be resolved before instantiation, those records are
+    /// considered to be boxes.
+    bool optimizer::is_bobox_record(const CXXRecordDecl* record)
+    {
+        BOBOPT_ASSERT(record != nullptr);
+
+        const DeclContext* outermost = nullptr;
+        for (const DeclContext* context = record->getDeclContext(); !context->isTranslationUnit(); context = context->getParent())
+        {
+            outermost = context;
+        }
+
+        const auto* ns = llvm::dyn_cast_or_null<NamespaceDecl>(outermost);
+        if ((ns != nullptr) && (ns->getName() == "bobox"))
+        {
+            return true;
+        }
+
+        if (!record->hasDefinition())
+        {
+            return false;
+        }
+
+        for (const auto& base : record->getDefinition()->bases())
+        {
+            if (base.getType()->isDependentType())
+            {
+                return true;
+            }
+
+            const CXXRecordDecl* base_record = base.getType()->getAsCXXRecordDecl();
+            if ((base_record != nullptr) && is_bobox_record(base_record))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /// \brief Name of template instantiation with template arguments and location it was instantiated at.
+    std::string optimizer::get_instantiation_name(const CXXRecordDecl* instantiation) const
+    {
+        BOBOPT_ASSERT(instantiation != nullptr);
+
+        std::string result = get_specialization_name(instantiation);
+        llvm::raw_string_ostream os(result);
+
+        const auto* specialization = llvm::dyn_cast<ClassTemplateSpecializationDecl>(instantiation);
+        if ((specialization != nullptr) && specialization->getPointOfInstantiation().isValid())
+        {
+            os << " (instantiated at " << specialization->getPointOfInstantiation().printToString(compiler_->getSourceManager()) << ")";
+        }
+
+        return os.str();
+    }
+
+    /// \brief Qualified name of template instantiation with template arguments, same in all translation units.
+    std::string optimizer::get_specialization_name(const CXXRecordDecl* instantiation) const
+    {
+        BOBOPT_ASSERT(instantiation != nullptr);
+
+        std::string result;
+        llvm::raw_string_ostream os(result);
+        instantiation->getNameForDiagnostic(os, compiler_->getASTContext().getPrintingPolicy(), /* Qualified= */ true);
+        return os.str();
+    }
+
+    /// \brief Absolute path and offset of declaration, instantiated declarations share the key of their pattern.
+    std::string optimizer::get_location_key(const Decl* decl) const
+    {
+        BOBOPT_ASSERT(decl != nullptr);
+
+        const SourceManager& sm = compiler_->getSourceManager();
+        const SourceLocation location = sm.getExpansionLoc(decl->getLocStart());
+
+        llvm::SmallString<256> path(sm.getFilename(location));
+        llvm::sys::fs::make_absolute(path);
+        return path.str().str() + ":" + std::to_string(sm.getFileOffset(location));
+    }
+
+    /// \brief Tests whether record is instantiation of template analyzed as box on its own.
+    ///
+    /// Template with dependent base isn't matched as box, its instantiations are
+    /// analyzed separately.
+    bool optimizer::is_box_instantiation(const CXXRecordDecl* record) const
+    {
+        BOBOPT_ASSERT(record != nullptr);
+        BOBOPT_ASSERT(bobox_basic_box_ != nullptr);
+
+        const TemplateSpecializationKind kind = record->getTemplateSpecializationKind();
+        if ((kind != TSK_ImplicitInstantiation) && (kind != TSK_ExplicitInstantiationDeclaration) && (kind != TSK_ExplicitInstantiationDefinition))
+        {
+            return false;
+        }
+
+        const CXXRecordDecl* pattern = record->getTemplateInstantiationPattern();
+        return (pattern != nullptr) && (pattern->getDescribedClassTemplate() != nullptr) && pattern->isDerivedFrom(bobox_basic_box_);
+    }
+
+    /// \brief Identify box by absolute path of its file, offset and hash of its source text.
+    ///
+    /// Box without file, e.g., expanded from macro in scratch buffer, gets unique fingerprint.
+    std::string optimizer::get_fingerprint(const CXXRecordDecl* box_declaration) const
+    {
+        BOBOPT_ASSERT(box_declaration != nullptr);
+
+        const SourceManager& sm = compiler_->getSourceManager();
+
+        const SourceLocation begin = sm.getExpansionLoc(box_declaration->getLocStart());
+        const SourceLocation end = sm.getExpansionLoc(box_declaration->getLocEnd());
+        const std::pair<FileID, unsigned> decomposed_begin = sm.getDecomposedLoc(begin);
+        const std::pair<FileID, unsigned> decomposed_end = sm.getDecomposedLoc(end);
+
+        const FileEntry* entry = sm.getFileEntryForID(decomposed_begin.first);
+        if ((entry == nullptr) || (decomposed_begin.first != decomposed_end.first) || (decomposed_end.second < decomposed_begin.second))
+        {
+            return std::to_string(analyzed_boxes_.size()) + ":" + box_declaration->getQualifiedNameAsString();
+        }
+
+        llvm::SmallString<256> path(entry->getName());
+        llvm::sys::fs::make_absolute(path);
+
+        const llvm::StringRef text = sm.getBufferData(decomposed_begin.first).substr(decomposed_begin.second, decomposed_end.second - decomposed_begin.second + 1);
+        return path.str().str() + ":" + std::to_string(decomposed_begin.second) + ":" + content_hash(text.str());
+    }
+
+    /// \brief Instantiations of box template with definition, empty for box that isn't template.
+    ///
+    /// Instantiations of partial specializations are analyzed as separate boxes.
+    std::vector<CXXRecordDecl*> optimizer::get_instantiations(const CXXRecordDecl* box_declaration)
+    {
+        BOBOPT_ASSERT(box_declaration != nullptr);
+
+        std::vector<CXXRecordDecl*> result;
+
+        const ClassTemplateDecl* box_template = box_declaration->getDescribedClassTemplate();
+        if (box_template == nullptr)
+        {
+            return result;
+        }
+
+        for (ClassTemplateSpecializationDecl* specialization : box_template->specializations())
+        {
+            if (specialization->hasDefinition() && (specialization->getTemplateInstantiationPattern() == box_declaration))
+            {
+                result.push_back(specialization);
+            }
+        }
+
+        return result;
     }
 
     optimizer::method_iterator_pair optimizer::get_level_methods(levels level)
     {
-        static const method_type METHODS[OM_COUNT] = { OM_PREFETCH, OM_YIELD_COMPLEX };
+        // Profile probes are not an optimization, they are enabled by mode.
+        static const method_type METHODS[OM_COUNT] = { OM_PREFETCH, OM_YIELD_COMPLEX, OM_PROFILE_PROBES };
 
         switch (level)
         {
@@ -3,6 +3,8 @@
 #ifndef BOBOPT_OPTIMIZER_HPP_GUARD_
 #define BOBOPT_OPTIMIZER_HPP_GUARD_
 
+#include <bobopt_analysis_context.hpp>
+#include <bobopt_config.hpp>
 #include <bobopt_diagnostic.hpp>
 #include <bobopt_inline.hpp>
 #include <bobopt_language.hpp>
@@ -15,18 +17,27 @@
 #include <clang/bobopt_clang_epilog.hpp>
 
 #include <array>
+#include <map>
 #include <memory>
+#include <set>
+#include <string>
+#include <vector>
 
 // Forward declaration(s).
 namespace clang
 {
     class CXXRecordDecl;
+    class Decl;
     class CompilerInstance;
+    class FunctionDecl;
 }
 
 namespace bobopt
 {
 
+    // forward declarations:
+    class what_if_report;
+
     /// \brief Optimization level type.
     enum levels
     {
@@ -42,7 +53,9 @@ namespace bobopt
     {
         MODE_DIAGNOSTIC,
         MODE_INTERACTIVE,
-        MODE_BUILD
+        MODE_BUILD,
+        /// Modify code as in build mode and insert profiling probes.
+        MODE_PROFILE
     };
 
     /// \brief Base class for bobox optimizations.
@@ -82,8 +95,19 @@ namespace bobopt
         clang::CXXRecordDecl* get_bobox_box() const;
         clang::CXXRecordDecl* get_bobox_basic_box() const;
 
+        box_context& get_box_context() const;
+
+        void set_what_if(what_if_report* report);
+        bool what_if() const;
+        void record_decision(const std::string& subject, const std::string& aspect, const std::string& value) const;
+        void record_cost(const clang::FunctionDecl* function, double cost) const;
+
+        std::string get_instantiation_name(const clang::CXXRecordDecl* instantiation) const;
+
         virtual void run(const clang::ast_matchers::MatchFinder::MatchResult& result) BOBOPT_OVERRIDE;
 
+        static bool needs_body(const clang::Decl* decl);
+
     private:
         typedef const method_type* method_iterator;
         typedef std::pair<method_iterator, method_iterator> method_iterator_pair;
@@ -94,9 +118,43 @@ namespace bobopt
         void create_method(method_type method);
         void destroy_method(method_type method);
 
-        void apply_methods(clang::CXXRecordDecl* box_decl) const;
+        typedef std::array<bool, OM_COUNT> enabled_methods;
+
+        /// \brief Cost of member functions indexed by location of their definition.
+        typedef std::map<std::string, double> costs_type;
+
+        /// \brief Results of instantiations of box template analyzed so far in the run.
+        ///
+        /// Translation units can instantiate the same template with different arguments,
+        /// merged replacements are replaced whenever new instantiation is analyzed.
+        struct template_results
+        {
+            /// \brief Names of analyzed instantiations without point of instantiation.
+            std::vector<std::string> keys;
+            /// \brief Names of analyzed instantiations for diagnostic.
+            std::vector<std::string> names;
+            /// \brief Replacements indexed by method and instantiation.
+            std::array<std::vector<clang::tooling::Replacements>, OM_COUNT> results;
+            /// \brief Costs of member functions indexed by instantiation.
+            std::vector<costs_type> costs;
+            /// \brief Merged replacements inserted into replacements of the run.
+            clang::tooling::Replacements merged;
+        };
+
+        void apply_methods(clang::CXXRecordDecl* box_decl);
+        void apply_configured_methods(clang::CXXRecordDecl* box_decl);
+        void apply_instantiation_methods(clang::CXXRecordDecl* box_decl, const std::vector<clang::CXXRecordDecl*>& instantiations, const enabled_methods& enabled);
+        void apply_annotations(const clang::CXXRecordDecl* box_decl, config_override& overrides, enabled_methods& enabled) const;
+        void merge_worst_case(const clang::CXXRecordDecl* box_decl, const template_results& state, size_t method, clang::tooling::Replacements& merged);
+        bool has_new_instantiations(const std::string& fingerprint, const std::vector<clang::CXXRecordDecl*>& instantiations) const;
+        std::string get_fingerprint(const clang::CXXRecordDecl* box_decl) const;
+        std::string get_specialization_name(const clang::CXXRecordDecl* instantiation) const;
+        std::string get_location_key(const clang::Decl* decl) const;
+        bool is_box_instantiation(const clang::CXXRecordDecl* record) const;
 
         static method_iterator_pair get_level_methods(levels level);
+        static bool is_bobox_record(const clang::CXXRecordDecl* record);
+        static std::vector<clang::CXXRecordDecl*> get_instantiations(const clang::CXXRecordDecl* box_decl);
 
         modes mode_;
         clang::CXXRecordDecl* bobox_box_;
@@ -104,6 +162,17 @@ namespace bobopt
         clang::CompilerInstance* compiler_;
         clang::tooling::Replacements* replacements_;
         std::unique_ptr<diagnostic> diagnostic_;
+        std::unique_ptr<box_context> box_context_;
+        /// \brief Fingerprints of boxes analyzed in this run, boxes from headers are matched in every translation unit.
+        std::set<std::string> analyzed_boxes_;
+        /// \brief Results of box templates by fingerprint, indexed by what-if configuration.
+        std::map<std::string, std::vector<template_results> > templates_;
+        /// \brief Configuration files of directories of boxes.
+        config_directories config_directories_;
+        /// \brief Report of what-if analysis, boxes are analyzed under each of its configurations.
+        what_if_report* what_if_;
+        /// \brief Costs of member functions of instantiation being analyzed, null otherwise.
+        costs_type* costs_;
         std::array<basic_method*, OM_COUNT> methods_;
     };
 
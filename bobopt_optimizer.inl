@@ -10,7 +10,10 @@ namespace bobopt
 
     template <typename InputIterator>
     optimizer::optimizer(clang::tooling::Replacements* replacements, InputIterator first, InputIterator last)
-        : replacements_(replacements)
+        : mode_(MODE_DIAGNOSTIC)
+        , replacements_(replacements)
+        , what_if_(nullptr)
+        , costs_(nullptr)
     {
         construct(first, last);
     }
@@ -23,6 +26,11 @@ namespace bobopt
         {
             create_method(*first);
         }
+
+        if (mode_ == MODE_PROFILE)
+        {
+            create_method(OM_PROFILE_PROBES);
+        }
     }
 
     BOBOPT_INLINE modes optimizer::get_mode() const
@@ -80,6 +88,25 @@ namespace bobopt
         return bobox_basic_box_;
     }
 
+    /// \brief Analysis context of box being optimized, shared by all methods.
+    BOBOPT_INLINE box_context& optimizer::get_box_context() const
+    {
+        BOBOPT_ASSERT(box_context_);
+        return *box_context_;
+    }
+
+    /// \brief Analyze boxes under each configuration of report instead of producing replacements, \c nullptr stops it.
+    BOBOPT_INLINE void optimizer::set_what_if(what_if_report* report)
+    {
+        what_if_ = report;
+    }
+
+    /// \brief Tests whether methods run for what-if analysis and should record their decisions.
+    BOBOPT_INLINE bool optimizer::what_if() const
+    {
+        return (what_if_ != nullptr);
+    }
+
     BOBOPT_INLINE clang::CompilerInstance& optimizer::get_compiler() const
     {
         return *compiler_;
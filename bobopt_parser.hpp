@@ -42,6 +42,21 @@ namespace bobopt
         }
     };
 
+    /// \brief Specialization for strings. Value is taken as is.
+    template <>
+    struct parser<std::string>
+    {
+        BOBOPT_INLINE std::string parse(const std::string& text)
+        {
+            return text;
+        }
+
+        BOBOPT_INLINE std::string print(const std::string& value) const
+        {
+            return value;
+        }
+    };
+
     /// \brief Specialization for unsigned integers.
     template <>
     struct parser<unsigned>
@@ -0,0 +1,330 @@
+#include <bobopt_pch.hpp>
+
+#include <bobopt_debug.hpp>
+#include <bobopt_statistics.hpp>
+#include <bobopt_time_report.hpp>
+#include <bobopt_utils.hpp>
+
+#include <clang/bobopt_clang_prolog.hpp>
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/FrontendActions.h"
+#include "clang/Tooling/Tooling.h"
+#include <clang/bobopt_clang_epilog.hpp>
+
+#include <fstream>
+#include <sstream>
+
+using namespace clang;
+using namespace clang::tooling;
+
+namespace bobopt
+{
+
+    // TU helpers.
+    //==========================================================================
+
+    namespace
+    {
+
+        /// \brief Action writing precompiled header to given file and collecting its input files.
+        class pch_action : public GeneratePCHAction
+        {
+        public:
+            pch_action(const std::string& output, std::string* deps)
+                : output_(output)
+                , deps_(deps)
+            {
+                BOBOPT_ASSERT(deps_ != nullptr);
+            }
+
+        protected:
+            virtual std::unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance& compiler_instance, StringRef file_name) BOBOPT_OVERRIDE
+            {
+                compiler_instance.getFrontendOpts().OutputFile = output_;
+                return GeneratePCHAction::CreateASTConsumer(compiler_instance, file_name);
+            }
+
+            /// \brief Record size and modification time of input files, the same
+            /// values compiler validates when precompiled header is loaded.
+            virtual void EndSourceFileAction() BOBOPT_OVERRIDE
+            {
+                std::ostringstream os;
+
+                SourceManager& sm = getCompilerInstance().getSourceManager();
+                for (auto it = sm.fileinfo_begin(); it != sm.fileinfo_end(); ++it)
+                {
+                    const FileEntry* entry = it->first;
+                    os << entry->getSize() << '\t' << static_cast<long long>(entry->getModificationTime()) << '\t' << std::string(entry->getName()) << '\n';
+                }
+
+                *deps_ = os.str();
+                GeneratePCHAction::EndSourceFileAction();
+            }
+
+        private:
+            std::string output_;
+            std::string* deps_;
+        };
+
+        /// \brief Factory of single precompiled header action.
+        class pch_action_factory : public FrontendActionFactory
+        {
+        public:
+            pch_action_factory(const std::string& output, std::string* deps)
+                : output_(output)
+                , deps_(deps)
+            {
+            }
+
+            virtual FrontendAction* create() BOBOPT_OVERRIDE
+            {
+                return new pch_action(output_, deps_);
+            }
+
+        private:
+            std::string output_;
+            std::string* deps_;
+        };
+
+        /// \brief Make path absolute against directory.
+        std::string make_absolute(const std::string& directory, llvm::StringRef path)
+        {
+            if (llvm::sys::path::is_absolute(path))
+            {
+                return path.str();
+            }
+
+            llvm::SmallString<256> result(directory);
+            llvm::sys::path::append(result, path);
+            return result.str().str();
+        }
+
+        /// \brief Compile flags without program name, source file, outputs and dependency file options.
+        ///
+        /// Flags that don't change meaning of code are removed, so translation
+        /// units differing only by them share precompiled header.
+        std::vector<std::string> get_flags(const CompileCommand& command, llvm::StringRef file_path)
+        {
+            std::vector<std::string> result;
+
+            const std::string source = make_absolute(command.Directory, file_path);
+            const auto& args = command.CommandLine;
+            for (size_t i = 1; i < args.size(); ++i)
+            {
+                const llvm::StringRef arg(args[i]);
+
+                if ((arg == "-o") || (arg == "-MF") || (arg == "-MT") || (arg == "-MQ"))
+                {
+                    ++i;
+                    continue;
+                }
+
+                if ((arg == "-c") || arg.startswith("-o") || arg.startswith("-M") || (make_absolute(command.Directory, arg) == source))
+                {
+                    continue;
+                }
+
+                result.push_back(args[i]);
+            }
+
+            return result;
+        }
+
+        /// \brief Database of single compile command used to build precompiled header.
+        class pch_command_database : public CompilationDatabase
+        {
+        public:
+            explicit pch_command_database(const CompileCommand& command)
+                : command_(command)
+            {
+            }
+
+            virtual std::vector<CompileCommand> getCompileCommands(llvm::StringRef) const BOBOPT_OVERRIDE
+            {
+                return std::vector<CompileCommand>(1, command_);
+            }
+
+            virtual std::vector<std::string> getAllFiles() const BOBOPT_OVERRIDE
+            {
+                return std::vector<std::string>(1, command_.CommandLine.back());
+            }
+
+            virtual std::vector<CompileCommand> getAllCompileCommands() const BOBOPT_OVERRIDE
+            {
+                return std::vector<CompileCommand>(1, command_);
+            }
+
+        private:
+            CompileCommand command_;
+        };
+
+    } // namespace
+
+    // pch_database:
+    //==========================================================================
+
+    pch_database::pch_database(const CompilationDatabase& base, const std::string& header, const std::string& cache_dir)
+        : base_(base)
+        , header_(header)
+        , cache_dir_(cache_dir)
+        , pchs_()
+    {
+        llvm::SmallString<256> absolute_header(header_);
+        llvm::sys::fs::make_absolute(absolute_header);
+        header_ = absolute_header.str();
+
+        llvm::SmallString<256> absolute_cache_dir(cache_dir_);
+        llvm::sys::fs::make_absolute(absolute_cache_dir);
+        cache_dir_ = absolute_cache_dir.str();
+    }
+
+    pch_database::~pch_database()
+    {
+    }
+
+    /// \brief Commands of base database with precompiled header included.
+    std::vector<CompileCommand> pch_database::getCompileCommands(llvm::StringRef file_path) const
+    {
+        std::vector<CompileCommand> result = base_.getCompileCommands(file_path);
+
+        for (auto& command : result)
+        {
+            if (command.CommandLine.empty())
+            {
+                continue;
+            }
+
+            const std::string& pch = get_pch(command.Directory, get_flags(command, file_path));
+            if (!pch.empty())
+            {
+                const char* const include_pch[] = { "-include-pch", pch.c_str() };
+                command.CommandLine.insert(command.CommandLine.begin() + 1, std::begin(include_pch), std::end(include_pch));
+            }
+        }
+
+        return result;
+    }
+
+    std::vector<std::string> pch_database::getAllFiles() const
+    {
+        return base_.getAllFiles();
+    }
+
+    std::vector<CompileCommand> pch_database::getAllCompileCommands() const
+    {
+        return base_.getAllCompileCommands();
+    }
+
+    /// \brief Precompiled header for compile flags, built or validated once per run.
+    const std::string& pch_database::get_pch(const std::string& directory, const std::vector<std::string>& flags) const
+    {
+        std::string key = header_ + '\n' + directory;
+        for (const auto& flag : flags)
+        {
+            key += '\n';
+            key += flag;
+        }
+
+        auto found = pchs_.find(key);
+        if (found != pchs_.end())
+        {
+            return found->second;
+        }
+
+        std::string& result = pchs_[key];
+
+        const std::string pch = make_absolute(cache_dir_, content_hash(key) + ".pch");
+        const std::string deps = pch + ".deps";
+
+        if (is_up_to_date(pch, deps))
+        {
+            statistics::instance().increment("pch.reused");
+            result = pch;
+            return result;
+        }
+
+        if (build(directory, flags, pch, deps))
+        {
+            statistics::instance().increment("pch.built");
+            result = pch;
+            return result;
+        }
+
+        llvm::errs() << "[WARNING] Failed to build precompiled header from " << header_ << ", translation units are parsed without it.\n";
+        return result;
+    }
+
+    /// \brief Build precompiled header and save list of its input files.
+    bool pch_database::build(const std::string& directory, const std::vector<std::string>& flags, const std::string& pch, const std::string& deps) const
+    {
+        scoped_timer timer("pch build");
+
+        if (llvm::sys::fs::create_directories(cache_dir_))
+        {
+            return false;
+        }
+
+        CompileCommand command;
+        command.Directory = directory;
+        command.CommandLine.push_back("clang-tool");
+        command.CommandLine.insert(command.CommandLine.end(), flags.begin(), flags.end());
+        command.CommandLine.push_back("-x");
+        command.CommandLine.push_back("c++-header");
+        command.CommandLine.push_back(header_);
+
+        pch_command_database database(command);
+        ClangTool tool(database, std::vector<std::string>(1, header_));
+
+        std::string dependencies;
+        pch_action_factory factory(pch, &dependencies);
+        if ((tool.run(&factory) != 0) || dependencies.empty())
+        {
+            return false;
+        }
+
+        // List is written last, interrupted build leaves stale or no list.
+        std::ofstream file(deps, std::ios::binary | std::ios::trunc);
+        return static_cast<bool>(file << dependencies);
+    }
+
+    /// \brief Tests whether precompiled header exists and none of its input files changed.
+    bool pch_database::is_up_to_date(const std::string& pch, const std::string& deps)
+    {
+        if (!llvm::sys::fs::exists(pch))
+        {
+            return false;
+        }
+
+        std::ifstream file(deps, std::ios::binary);
+        if (!file)
+        {
+            return false;
+        }
+
+        unsigned long long size = 0;
+        long long time = 0;
+        std::string path;
+        while ((file >> size >> time) && (file.get() == '\t') && std::getline(file, path))
+        {
+            llvm::sys::fs::file_status status;
+            if (llvm::sys::fs::status(path, status))
+            {
+                return false;
+            }
+
+            if ((status.getSize() != size) || (static_cast<long long>(status.getLastModificationTime().toEpochTime()) != time))
+            {
+                return false;
+            }
+        }
+
+        return file.eof();
+    }
+
+} // namespace
@@ -0,0 +1,75 @@
+/// \file bobopt_pch.hpp File contains compilation database that lets translation
+/// units share precompiled header of common includes.
+///
+/// Precompiled header is built once for every distinct set of compile flags
+/// from user given header, e.g., one including Bobox and ulibpp headers, and
+/// it is added to compile commands by \c -include-pch. Built headers are kept
+/// in cache directory together with list of their input files, so next runs
+/// reuse them until any input file changes.
+
+#ifndef BOBOPT_PCH_HPP_GUARD_
+#define BOBOPT_PCH_HPP_GUARD_
+
+#include <bobopt_language.hpp>
+#include <bobopt_macros.hpp>
+
+#include <clang/bobopt_clang_prolog.hpp>
+#include "llvm/ADT/StringRef.h"
+#include "clang/Tooling/CompilationDatabase.h"
+#include <clang/bobopt_clang_epilog.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace bobopt
+{
+
+    // pch_database:
+    //==========================================================================
+
+    /// \brief Compilation database adding shared precompiled header to commands
+    /// of other database.
+    ///
+    /// Translation unit whose precompiled header fails to build is compiled
+    /// without it.
+    class pch_database : public clang::tooling::CompilationDatabase
+    {
+    public:
+        pch_database(const clang::tooling::CompilationDatabase& base, const std::string& header, const std::string& cache_dir);
+        virtual ~pch_database() BOBOPT_OVERRIDE;
+
+        virtual std::vector<clang::tooling::CompileCommand> getCompileCommands(llvm::StringRef file_path) const BOBOPT_OVERRIDE;
+        virtual std::vector<std::string> getAllFiles() const BOBOPT_OVERRIDE;
+        virtual std::vector<clang::tooling::CompileCommand> getAllCompileCommands() const BOBOPT_OVERRIDE;
+
+    private:
+        BOBOPT_NONCOPYMOVABLE(pch_database);
+
+        /// \brief Input file of precompiled header as recorded by compiler.
+        struct dependency
+        {
+            std::string path;
+            unsigned long long size;
+            long long time;
+        };
+
+        typedef std::vector<dependency> dependencies_type;
+        typedef std::map<std::string, std::string> pchs_type;
+
+        const std::string& get_pch(const std::string& directory, const std::vector<std::string>& flags) const;
+        bool build(const std::string& directory, const std::vector<std::string>& flags, const std::string& pch, const std::string& deps) const;
+
+        static bool is_up_to_date(const std::string& pch, const std::string& deps);
+
+        const clang::tooling::CompilationDatabase& base_;
+        std::string header_;
+        std::string cache_dir_;
+
+        /// \brief Precompiled headers by key of compile flags, empty path when build failed.
+        mutable pchs_type pchs_;
+    };
+
+} // namespace
+
+#endif // guard
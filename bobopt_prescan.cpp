@@ -0,0 +1,358 @@
+#include <bobopt_prescan.hpp>
+
+#include <bobopt_debug.hpp>
+
+#include <clang/bobopt_clang_prolog.hpp>
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Path.h"
+#include "clang/Basic/LangOptions.h"
+#include "clang/Basic/SourceLocation.h"
+#include "clang/Basic/TokenKinds.h"
+#include "clang/Lex/Lexer.h"
+#include "clang/Lex/Token.h"
+#include "clang/Tooling/CompilationDatabase.h"
+#include <clang/bobopt_clang_epilog.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+using namespace clang;
+using namespace clang::tooling;
+
+namespace bobopt
+{
+
+    // TU helpers.
+    //==========================================================================
+
+    namespace
+    {
+
+        /// \brief Make path absolute against directory.
+        std::string make_absolute(const std::string& directory, const std::string& path)
+        {
+            if (llvm::sys::path::is_absolute(path))
+            {
+                return path;
+            }
+
+            llvm::SmallString<256> result(directory);
+            llvm::sys::path::append(result, path);
+            return result.str();
+        }
+
+        /// \brief Extract user include directories from compile commands of source.
+        std::vector<std::string> get_include_dirs(const std::vector<CompileCommand>& commands)
+        {
+            std::vector<std::string> result;
+
+            for (const auto& command : commands)
+            {
+                const auto& args = command.CommandLine;
+                for (size_t i = 0; i < args.size(); ++i)
+                {
+                    const llvm::StringRef arg(args[i]);
+
+                    llvm::StringRef flag;
+                    if (arg.startswith("-I"))
+                    {
+                        flag = "-I";
+                    }
+                    else if (arg.startswith("-iquote"))
+                    {
+                        flag = "-iquote";
+                    }
+                    else
+                    {
+                        continue;
+                    }
+
+                    std::string dir = arg.substr(flag.size()).str();
+                    if (dir.empty() && (i + 1 < args.size()))
+                    {
+                        dir = args[++i];
+                    }
+
+                    if (!dir.empty())
+                    {
+                        result.push_back(make_absolute(command.Directory, dir));
+                    }
+                }
+            }
+
+            return result;
+        }
+
+        /// \brief Find included file in directories, empty string when not found.
+        std::string find_include(const std::string& name, const std::vector<std::string>& dirs)
+        {
+            for (const auto& dir : dirs)
+            {
+                std::string path = make_absolute(dir, name);
+                if (llvm::sys::fs::is_regular_file(path))
+                {
+                    return path;
+                }
+            }
+
+            return std::string();
+        }
+
+        /// \brief Extract files included by -include option from compile commands of source.
+        ///
+        /// Files are searched in directory of command and in user include
+        /// directories, file that isn't found is returned as empty string.
+        std::vector<std::string> get_forced_includes(const std::vector<CompileCommand>& commands, const std::vector<std::string>& include_dirs)
+        {
+            std::vector<std::string> result;
+
+            for (const auto& command : commands)
+            {
+                std::vector<std::string> dirs(1, command.Directory);
+                dirs.insert(dirs.end(), include_dirs.begin(), include_dirs.end());
+
+                const auto& args = command.CommandLine;
+                for (size_t i = 0; i < args.size(); ++i)
+                {
+                    const llvm::StringRef arg(args[i]);
+                    if (!arg.startswith("-include") || arg.startswith("-include-pch"))
+                    {
+                        continue;
+                    }
+
+                    std::string name = arg.substr(std::strlen("-include")).str();
+                    if (name.empty() && (i + 1 < args.size()))
+                    {
+                        name = args[++i];
+                    }
+
+                    result.push_back(find_include(name, dirs));
+                }
+            }
+
+            return result;
+        }
+
+        /// \brief Identifier can name box class, e.g., \c box, \c basic_box or \c filter_box.
+        bool is_box_name(llvm::StringRef identifier)
+        {
+            return identifier.endswith("box");
+        }
+
+        /// \brief Identifier can precede name of base class in base clause.
+        bool is_base_prefix(llvm::StringRef identifier)
+        {
+            return (identifier == "public") || (identifier == "protected") || (identifier == "private") || (identifier == "virtual");
+        }
+
+    } // namespace
+
+    // prescan:
+    //==========================================================================
+
+    prescan::prescan()
+        : files_()
+    {
+    }
+
+    prescan::~prescan()
+    {
+    }
+
+    /// \brief Tests whether translation unit of source can contain box.
+    ///
+    /// Files included by -include option are scanned together with source.
+    /// Source without compile command, unreadable source or forced include that
+    /// isn't found is always let through, parser reports the problem.
+    bool prescan::may_contain_box(const CompilationDatabase& compilations, const std::string& source)
+    {
+        const std::vector<CompileCommand> commands = compilations.getCompileCommands(source);
+        if (commands.empty())
+        {
+            return true;
+        }
+
+        const std::vector<std::string> include_dirs = get_include_dirs(commands);
+
+        visited_type visited;
+        for (const auto& include : get_forced_includes(commands, include_dirs))
+        {
+            if (include.empty() || scan(include, include_dirs, visited))
+            {
+                return true;
+            }
+        }
+
+        return scan(make_absolute(commands.front().Directory, source), include_dirs, visited);
+    }
+
+    /// \brief Scan file and its user includes.
+    bool prescan::scan(const std::string& path, const std::vector<std::string>& include_dirs, visited_type& visited)
+    {
+        llvm::sys::fs::UniqueID id;
+        if (llvm::sys::fs::getUniqueID(path, id))
+        {
+            return true;
+        }
+
+        if (!visited.insert(id).second)
+        {
+            return false;
+        }
+
+        // Reference stays valid, map doesn't invalidate it when includes are lexed.
+        const file_result& result = lex(id, path);
+        if (result.box)
+        {
+            return true;
+        }
+
+        std::vector<std::string> quoted_dirs(1, llvm::sys::path::parent_path(path).str());
+        quoted_dirs.insert(quoted_dirs.end(), include_dirs.begin(), include_dirs.end());
+
+        for (const auto& name : result.quoted_includes)
+        {
+            const std::string include = find_include(name, quoted_dirs);
+            if (!include.empty() && scan(include, include_dirs, visited))
+            {
+                return true;
+            }
+        }
+
+        // Angled includes not found in user directories are system includes.
+        for (const auto& name : result.angled_includes)
+        {
+            const std::string include = find_include(name, include_dirs);
+            if (!include.empty() && scan(include, include_dirs, visited))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /// \brief Lex file by raw lexer, result is cached.
+    const prescan::file_result& prescan::lex(const llvm::sys::fs::UniqueID& id, const std::string& path)
+    {
+        auto found = files_.find(id);
+        if (found != files_.end())
+        {
+            return found->second;
+        }
+
+        file_result& result = files_[id];
+        result.box = false;
+
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+        {
+            result.box = true;
+            return result;
+        }
+
+        const std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        LangOptions lang_options;
+        lang_options.CPlusPlus = true;
+        lang_options.CPlusPlus11 = true;
+
+        const char* begin = content.c_str();
+        Lexer lexer(SourceLocation(), lang_options, begin, begin, begin + content.size());
+
+        // Previous token is enough to recognize name of box in base clause
+        // ": public box", in qualified name "bobox :: box" or "bx :: box" and
+        // Bobox namespace in "using namespace bobox" or "namespace bx = bobox".
+        enum previous_kinds
+        {
+            PK_OTHER,
+            PK_SCOPE,
+            PK_BASE,
+            PK_NAMESPACE
+        };
+        previous_kinds previous = PK_OTHER;
+
+        Token token;
+        lexer.LexFromRawLexer(token);
+        while (token.isNot(tok::eof))
+        {
+            if (token.is(tok::hash) && token.isAtStartOfLine())
+            {
+                lexer.LexFromRawLexer(token);
+                if (token.is(tok::raw_identifier) && token.getRawIdentifier().startswith("include"))
+                {
+                    // The rest of directive line holds name of included file.
+                    const char* position = lexer.getBufferLocation();
+                    const char* end = begin + content.size();
+                    while ((position != end) && ((*position == ' ') || (*position == '\t')))
+                    {
+                        ++position;
+                    }
+
+                    const char terminator = (position == end) ? '\0' : (*position == '"') ? '"' : (*position == '<') ? '>' : '\0';
+                    const char* name_end = (terminator == '\0') ? end : std::find(position + 1, end, terminator);
+                    if ((terminator == '\0') || (name_end == end))
+                    {
+                        // Include by macro can't be resolved without preprocessor.
+                        result.box = true;
+                        return result;
+                    }
+
+                    const std::string name(position + 1, name_end);
+                    if (terminator == '"')
+                    {
+                        result.quoted_includes.push_back(name);
+                    }
+                    else
+                    {
+                        result.angled_includes.push_back(name);
+                    }
+
+                    lexer.ReadToEndOfLine();
+                }
+
+                previous = PK_OTHER;
+                lexer.LexFromRawLexer(token);
+                continue;
+            }
+
+            if (token.is(tok::raw_identifier))
+            {
+                const llvm::StringRef identifier = token.getRawIdentifier();
+                if ((identifier == "basic_box") || (identifier == "BOBOX_BOX_INPUTS_LIST") ||
+                    (((previous == PK_SCOPE) || (previous == PK_BASE)) && is_box_name(identifier)) ||
+                    ((previous == PK_NAMESPACE) && (identifier == "bobox")))
+                {
+                    result.box = true;
+                    return result;
+                }
+
+                previous = (identifier == "namespace") ? PK_NAMESPACE : is_base_prefix(identifier) ? PK_BASE : PK_OTHER;
+            }
+            else if (token.is(tok::coloncolon))
+            {
+                previous = PK_SCOPE;
+            }
+            else if (token.is(tok::colon) || token.is(tok::comma))
+            {
+                previous = PK_BASE;
+            }
+            else if (token.is(tok::equal))
+            {
+                previous = PK_NAMESPACE;
+            }
+            else
+            {
+                previous = PK_OTHER;
+            }
+
+            lexer.LexFromRawLexer(token);
+        }
+
+        return result;
+    }
+
+} // namespace
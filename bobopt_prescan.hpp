@@ -0,0 +1,79 @@
+/// \file bobopt_prescan.hpp File contains lexical pre-scan that finds translation
+/// units which can't contain any box.
+///
+/// Pre-scan runs raw lexer over main file, files forced by -include option and
+/// their includes found in user include directories. System includes are not
+/// scanned, Bobox headers are expected to be among them. Translation unit may
+/// contain box if any scanned file mentions \c basic_box or
+/// \c BOBOX_BOX_INPUTS_LIST, name ending with \c box qualified or in base
+/// clause (\c bobox::box, \c bx::box, \c public \c filter_box), Bobox namespace
+/// in using directive or namespace alias, or includes file by macro. Pre-scan
+/// ignores conditional compilation. It skips translation unit with box only
+/// when base class of box is declared in system header under name not ending
+/// with \c box.
+
+#ifndef BOBOPT_PRESCAN_HPP_GUARD_
+#define BOBOPT_PRESCAN_HPP_GUARD_
+
+#include <bobopt_macros.hpp>
+
+#include <clang/bobopt_clang_prolog.hpp>
+#include "llvm/Support/FileSystem.h"
+#include <clang/bobopt_clang_epilog.hpp>
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+// Forward declaration(s).
+namespace clang
+{
+    namespace tooling
+    {
+        class CompilationDatabase;
+    }
+}
+
+namespace bobopt
+{
+
+    // prescan:
+    //==========================================================================
+
+    /// \brief Lexical pre-scan of translation units for boxes.
+    ///
+    /// Results of scanned files are cached, headers shared by more translation
+    /// units are lexed only once.
+    class prescan
+    {
+    public:
+        prescan();
+        ~prescan();
+
+        bool may_contain_box(const clang::tooling::CompilationDatabase& compilations, const std::string& source);
+
+    private:
+        BOBOPT_NONCOPYMOVABLE(prescan);
+
+        /// \brief Result of lexing single file.
+        struct file_result
+        {
+            /// \brief File mentions box or includes file by macro.
+            bool box;
+            std::vector<std::string> quoted_includes;
+            std::vector<std::string> angled_includes;
+        };
+
+        typedef std::map<llvm::sys::fs::UniqueID, file_result> files_type;
+        typedef std::set<llvm::sys::fs::UniqueID> visited_type;
+
+        bool scan(const std::string& path, const std::vector<std::string>& include_dirs, visited_type& visited);
+        const file_result& lex(const llvm::sys::fs::UniqueID& id, const std::string& path);
+
+        files_type files_;
+    };
+
+} // namespace
+
+#endif // guard
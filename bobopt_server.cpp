@@ -0,0 +1,228 @@
+#include <bobopt_server.hpp>
+
+#include <bobopt_config.hpp>
+#include <bobopt_debug.hpp>
+#include <bobopt_fixes.hpp>
+#include <bobopt_utils.hpp>
+
+#include <clang/bobopt_clang_prolog.hpp>
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+#include <clang/bobopt_clang_epilog.hpp>
+
+#include <algorithm>
+#include <sstream>
+
+using namespace clang::tooling;
+
+namespace bobopt
+{
+
+    // server:
+    //==========================================================================
+
+    server::server(analyze_function analyze)
+        : analyze_(analyze)
+        , units_()
+        , reloaded_()
+    {
+        BOBOPT_ASSERT(analyze_);
+    }
+
+    server::~server()
+    {
+    }
+
+    /// \brief Analyze translation units before first request.
+    void server::warm_up(const std::vector<std::string>& sources)
+    {
+        for (const auto& source : sources)
+        {
+            bool analyzed = false;
+            analyze(source, analyzed);
+        }
+    }
+
+    /// \brief Handle requests until quit request or end of input.
+    int server::serve(std::istream& in, llvm::raw_ostream& out)
+    {
+        std::string request;
+        while (std::getline(in, request))
+        {
+            if (!handle(request, out))
+            {
+                break;
+            }
+
+            out.flush();
+        }
+
+        return 0;
+    }
+
+    /// \brief Handle single request, returns false on quit request.
+    bool server::handle(const std::string& request, llvm::raw_ostream& out)
+    {
+        std::istringstream is(request);
+
+        std::string command;
+        is >> command;
+
+        std::string argument;
+        std::getline(is >> std::ws, argument);
+
+        if (command.empty())
+        {
+            return true;
+        }
+
+        if (command == "quit")
+        {
+            out << "ok quit\n";
+            return false;
+        }
+
+        if (command == "reload")
+        {
+            if (argument.empty() || !reload(argument))
+            {
+                out << "error failed to load configuration file: " << argument << "\n";
+                return true;
+            }
+
+            // Results depend on configuration.
+            units_.clear();
+            out << "ok reloaded\n";
+            return true;
+        }
+
+        if ((command != "analyze") && (command != "apply"))
+        {
+            out << "error unknown request: " << command << "\n";
+            return true;
+        }
+
+        if (argument.empty())
+        {
+            out << "error missing file\n";
+            return true;
+        }
+
+        bool analyzed = false;
+        const unit* result = analyze(argument, analyzed);
+        if (result == nullptr)
+        {
+            out << "error failed to analyze: " << argument << "\n";
+            return true;
+        }
+
+        if (command == "analyze")
+        {
+            out << "ok " << (analyzed ? "analyzed " : "unchanged ") << static_cast<unsigned>(result->replacements.size()) << "\n";
+            return true;
+        }
+
+        const unsigned count = static_cast<unsigned>(result->replacements.size());
+        if (!apply_replacements(result->replacements))
+        {
+            out << "error failed to apply replacements: " << argument << "\n";
+            return true;
+        }
+
+        out << "ok applied " << count << "\n";
+        return true;
+    }
+
+    /// \brief Replace configuration of the previous reload by configuration file.
+    ///
+    /// Variables file doesn't set return to values server started with, so
+    /// configuration doesn't depend on history of reloads. Configuration stays
+    /// unchanged when file can't be read or sets unknown variable or invalid
+    /// value. Variables of unknown groups are ignored as by \c -c option.
+    bool server::reload(const std::string& file_name)
+    {
+        std::vector<config_setting> settings;
+        config_parser parser;
+        if (!parser.read(file_name, settings))
+        {
+            return false;
+        }
+
+        settings.erase(std::remove_if(settings.begin(), settings.end(), [](const config_setting& setting)
+                                      { return config_map::instance().get_group(setting.group) == nullptr; }),
+                       settings.end());
+
+        // Values are checked on top of current configuration, check restores it.
+        {
+            config_override check;
+            for (const auto& setting : settings)
+            {
+                if (!check.set(setting.group, setting.variable, setting.value))
+                {
+                    llvm::errs() << "[WARNING] Invalid variable " << setting.variable << " in [" << setting.group << "] of: " << file_name << "\n";
+                    return false;
+                }
+            }
+        }
+
+        // Restore startup configuration before new one is applied.
+        reloaded_.reset();
+        reloaded_ = make_unique<config_override>();
+        for (const auto& setting : settings)
+        {
+            BOBOPT_CHECK(reloaded_->set(setting.group, setting.variable, setting.value));
+        }
+
+        return true;
+    }
+
+    /// \brief Result of translation unit, analyzed again only when its files changed.
+    const server::unit* server::analyze(const std::string& source, bool& analyzed)
+    {
+        llvm::SmallString<256> path(source);
+        llvm::sys::fs::make_absolute(path);
+
+        auto found = units_.find(path.str());
+        if ((found != units_.end()) && (get_stamp(found->second.dependencies) == found->second.stamp))
+        {
+            analyzed = false;
+            return &found->second;
+        }
+
+        unit& result = units_[path.str()];
+        result.replacements.clear();
+        result.dependencies.clear();
+
+        if (!analyze_(path.str(), result.replacements, result.dependencies))
+        {
+            units_.erase(path.str());
+            return nullptr;
+        }
+
+        result.stamp = get_stamp(result.dependencies);
+        analyzed = true;
+        return &result;
+    }
+
+    /// \brief Sizes and modification times of files.
+    std::string server::get_stamp(const std::vector<std::string>& dependencies)
+    {
+        std::ostringstream os;
+
+        for (const auto& dependency : dependencies)
+        {
+            llvm::sys::fs::file_status status;
+            if (llvm::sys::fs::status(dependency, status))
+            {
+                os << "-\n";
+                continue;
+            }
+
+            os << status.getSize() << ' ' << status.getLastModificationTime().toEpochTime() << '\n';
+        }
+
+        return os.str();
+    }
+
+} // namespace
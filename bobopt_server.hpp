@@ -0,0 +1,90 @@
+/// \file bobopt_server.hpp File contains long-lived server mode of optimizer.
+///
+/// Server reads requests from input line by line and answers each by single
+/// line of output, diagnostics of optimizer go to standard error as usual:
+/// \code
+/// analyze <file>   Analyze translation unit, answers "ok analyzed <n>" or
+///                  "ok unchanged <n>", n is number of replacements.
+/// apply <file>     Analyze translation unit if needed and apply its
+///                  replacements, answers "ok applied <n>".
+/// reload <config>  Load configuration file over configuration server started
+///                  with, answers "ok reloaded".
+/// quit             Stop server.
+/// \endcode
+/// Failed requests are answered by "error <message>". Translation unit is
+/// analyzed again only when any file it was parsed from changed or when
+/// configuration was reloaded.
+
+#ifndef BOBOPT_SERVER_HPP_GUARD_
+#define BOBOPT_SERVER_HPP_GUARD_
+
+#include <bobopt_macros.hpp>
+
+#include <clang/bobopt_clang_prolog.hpp>
+#include "clang/Tooling/Refactoring.h"
+#include <clang/bobopt_clang_epilog.hpp>
+
+#include <functional>
+#include <istream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Forward declaration(s).
+namespace llvm
+{
+    class raw_ostream;
+}
+
+namespace bobopt
+{
+    class config_override;
+
+    // server:
+    //==========================================================================
+
+    /// \brief Server keeping process, configuration and analysis results warm
+    /// between requests.
+    class server
+    {
+    public:
+        /// \brief Function analyzing single translation unit, it fills replacements
+        /// and paths of all files translation unit was parsed from.
+        typedef std::function<bool(const std::string& source, clang::tooling::Replacements& replacements, std::vector<std::string>& dependencies)> analyze_function;
+
+        explicit server(analyze_function analyze);
+        ~server();
+
+        void warm_up(const std::vector<std::string>& sources);
+        int serve(std::istream& in, llvm::raw_ostream& out);
+
+    private:
+        BOBOPT_NONCOPYMOVABLE(server);
+
+        /// \brief Result of last analysis of translation unit.
+        struct unit
+        {
+            clang::tooling::Replacements replacements;
+            std::vector<std::string> dependencies;
+            /// \brief Sizes and modification times of dependencies at analysis time.
+            std::string stamp;
+        };
+
+        typedef std::map<std::string, unit> units_type;
+
+        bool handle(const std::string& request, llvm::raw_ostream& out);
+        bool reload(const std::string& file_name);
+        const unit* analyze(const std::string& source, bool& analyzed);
+
+        static std::string get_stamp(const std::vector<std::string>& dependencies);
+
+        analyze_function analyze_;
+        units_type units_;
+        /// \brief Configuration of the last reload, destruction restores startup configuration.
+        std::unique_ptr<config_override> reloaded_;
+    };
+
+} // namespace
+
+#endif // guard
@@ -0,0 +1,155 @@
+#include <bobopt_statistics.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <utility>
+
+#if defined(_WIN32)
+#   include <windows.h>
+#   include <psapi.h>
+#else
+#   include <sys/resource.h>
+#endif
+
+#include BOBOPT_INLINE_IN_SOURCE(bobopt_statistics.inl)
+
+namespace bobopt
+{
+
+    // resource_usage implementation.
+    //==========================================================================
+
+    resource_usage resource_usage::current()
+    {
+        resource_usage result;
+
+        typedef std::chrono::steady_clock clock_type;
+        result.wall_time = std::chrono::duration<double, std::milli>(clock_type::now().time_since_epoch()).count();
+
+#if defined(_WIN32)
+        PROCESS_MEMORY_COUNTERS counters;
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        {
+            result.peak_rss = static_cast<std::size_t>(counters.PeakWorkingSetSize / 1024);
+        }
+        else
+        {
+            result.peak_rss = 0;
+        }
+#else
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) == 0)
+        {
+#   if defined(__APPLE__)
+            // Reported in bytes on OS X.
+            result.peak_rss = static_cast<std::size_t>(usage.ru_maxrss / 1024);
+#   else
+            result.peak_rss = static_cast<std::size_t>(usage.ru_maxrss);
+#   endif
+        }
+        else
+        {
+            result.peak_rss = 0;
+        }
+#endif
+
+        return result;
+    }
+
+    // statistics implementation.
+    //==========================================================================
+
+    statistics::entry::entry()
+        : count(0)
+        , time(0.0)
+        , peak_rss_growth(0)
+    {
+    }
+
+    statistics::statistics()
+        : enabled_(false)
+        , entries_()
+        , counters_()
+    {
+    }
+
+    statistics& statistics::instance()
+    {
+        static statistics instance;
+        return instance;
+    }
+
+    void statistics::add(const std::string& name, double time, std::size_t peak_rss_growth)
+    {
+        entry& phase = entries_[name];
+        ++phase.count;
+        phase.time += time;
+        phase.peak_rss_growth = std::max(phase.peak_rss_growth, peak_rss_growth);
+    }
+
+    /// \brief Save statistics to file as JSON object.
+    bool statistics::save(const std::string& file_name) const
+    {
+        std::ofstream file(file_name);
+        if (!file)
+        {
+            return false;
+        }
+
+        file << "{" << std::endl;
+        file << "  \"peak_rss_kb\": " << resource_usage::current().peak_rss << "," << std::endl;
+        file << "  \"phases\": {" << std::endl;
+
+        for (auto it = entries_.begin(), end = entries_.end(); it != end;)
+        {
+            const entry& phase = it->second;
+            file << "    \"" << it->first << "\": { \"count\": " << phase.count << ", \"time_ms\": " << phase.time
+                 << ", \"peak_rss_growth_kb\": " << phase.peak_rss_growth << " }";
+
+            ++it;
+            file << ((it != end) ? "," : "") << std::endl;
+        }
+
+        file << "  }," << std::endl;
+        file << "  \"counters\": {" << std::endl;
+
+        for (auto it = counters_.begin(), end = counters_.end(); it != end;)
+        {
+            file << "    \"" << it->first << "\": " << it->second;
+
+            ++it;
+            file << ((it != end) ? "," : "") << std::endl;
+        }
+
+        file << "  }" << std::endl;
+        file << "}" << std::endl;
+
+        return static_cast<bool>(file);
+    }
+
+    // scoped_measurement implementation.
+    //==========================================================================
+
+    scoped_measurement::scoped_measurement(std::string name)
+        : active_(statistics::instance().enabled())
+        , name_()
+        , start_()
+    {
+        if (active_)
+        {
+            name_ = std::move(name);
+            start_ = resource_usage::current();
+        }
+    }
+
+    scoped_measurement::~scoped_measurement()
+    {
+        if (active_)
+        {
+            const resource_usage end = resource_usage::current();
+            statistics::instance().add(name_, end.wall_time - start_.wall_time, end.peak_rss - start_.peak_rss);
+        }
+    }
+
+} // namespace
@@ -0,0 +1,102 @@
+/// \file bobopt_statistics.hpp File contains facilities to measure time and
+/// memory used by the optimizer itself.
+
+#ifndef BOBOPT_STATISTICS_HPP_GUARD_
+#define BOBOPT_STATISTICS_HPP_GUARD_
+
+#include <bobopt_inline.hpp>
+#include <bobopt_macros.hpp>
+
+#include <cstddef>
+#include <map>
+#include <string>
+
+namespace bobopt
+{
+
+    // resource_usage:
+    //==========================================================================
+
+    /// \brief Snapshot of resources used by the process.
+    struct resource_usage
+    {
+        static resource_usage current();
+
+        /// Wall time in milliseconds from unspecified point.
+        double wall_time;
+        /// Peak resident set size in kilobytes.
+        std::size_t peak_rss;
+    };
+
+    // statistics:
+    //==========================================================================
+
+    /// \brief Gateway singleton to accumulated measurements of named phases.
+    ///
+    /// Measurements are collected only when enabled, otherwise
+    /// \c scoped_measurement does nothing. Named counters of rare events,
+    /// e.g., exceeded analysis budgets, are counted always.
+    class statistics
+    {
+    public:
+        /// \brief Accumulated measurements of single phase.
+        struct entry
+        {
+            entry();
+
+            /// Number of measurements.
+            unsigned long long count;
+            /// Total wall time in milliseconds.
+            double time;
+            /// Largest growth of peak RSS during single measurement in kilobytes.
+            std::size_t peak_rss_growth;
+        };
+
+        typedef std::map<std::string, entry> entries_type;
+        typedef std::map<std::string, unsigned long long> counters_type;
+
+        static statistics& instance();
+
+        void enable();
+        bool enabled() const;
+
+        void add(const std::string& name, double time, std::size_t peak_rss_growth);
+        const entries_type& get_entries() const;
+
+        void increment(const std::string& name);
+        const counters_type& get_counters() const;
+
+        bool save(const std::string& file_name) const;
+
+    private:
+        statistics();
+
+        bool enabled_;
+        entries_type entries_;
+        counters_type counters_;
+    };
+
+    // scoped_measurement:
+    //==========================================================================
+
+    /// \brief Measure wall time and growth of peak RSS of the scope under
+    /// given phase name.
+    class scoped_measurement
+    {
+    public:
+        explicit scoped_measurement(std::string name);
+        ~scoped_measurement();
+
+    private:
+        BOBOPT_NONCOPYMOVABLE(scoped_measurement);
+
+        bool active_;
+        std::string name_;
+        resource_usage start_;
+    };
+
+} // namespace
+
+#include BOBOPT_INLINE_IN_HEADER(bobopt_statistics.inl)
+
+#endif // guard
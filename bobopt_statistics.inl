@@ -0,0 +1,29 @@
+namespace bobopt
+{
+
+    BOBOPT_INLINE void statistics::enable()
+    {
+        enabled_ = true;
+    }
+
+    BOBOPT_INLINE bool statistics::enabled() const
+    {
+        return enabled_;
+    }
+
+    BOBOPT_INLINE const statistics::entries_type& statistics::get_entries() const
+    {
+        return entries_;
+    }
+
+    BOBOPT_INLINE void statistics::increment(const std::string& name)
+    {
+        ++counters_[name];
+    }
+
+    BOBOPT_INLINE const statistics::counters_type& statistics::get_counters() const
+    {
+        return counters_;
+    }
+
+} // namespace
@@ -0,0 +1,266 @@
+#include <bobopt_time_report.hpp>
+
+#include <bobopt_debug.hpp>
+#include <bobopt_utils.hpp>
+
+#include <clang/bobopt_clang_prolog.hpp>
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <clang/bobopt_clang_epilog.hpp>
+
+#include <algorithm>
+
+#include BOBOPT_INLINE_IN_SOURCE(bobopt_time_report.inl)
+
+namespace bobopt
+{
+
+    // Constants.
+    //==========================================================================
+
+    static const char* const UNIT_PHASE = "translation unit";
+    static const char* const OTHER_PHASE = "<other>";
+    static const char* const ITEM_KIND_NAMES[time_report::IK_COUNT] = { "boxes", "methods" };
+
+    static double elapsed_since(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // time_report implementation.
+    //==========================================================================
+
+    time_report::node::node(std::string name)
+        : name(std::move(name))
+        , count(0)
+        , time(0.0)
+        , children()
+    {
+    }
+
+    time_report::time_report()
+        : enabled_(false)
+        , total_("total")
+        , units_()
+        , unit_(nullptr)
+        , unit_depth_(0)
+        , unit_start_()
+        , stack_()
+    {
+    }
+
+    time_report& time_report::instance()
+    {
+        static time_report instance;
+        return instance;
+    }
+
+    /// \brief Start measurement of translation unit. Timers started until
+    /// \c end_unit() are accumulated also into tree of this unit.
+    void time_report::begin_unit(const std::string& file_name)
+    {
+        BOBOPT_ASSERT(unit_ == nullptr);
+
+        units_.push_back(make_unique<node>(file_name));
+        unit_ = units_.back().get();
+
+        push(UNIT_PHASE);
+        unit_depth_ = stack_.size();
+        unit_start_ = std::chrono::steady_clock::now();
+    }
+
+    void time_report::end_unit()
+    {
+        BOBOPT_ASSERT(unit_ != nullptr);
+        BOBOPT_ASSERT(stack_.size() == unit_depth_);
+
+        const double time = elapsed_since(unit_start_);
+        ++unit_->count;
+        unit_->time += time;
+        unit_ = nullptr;
+
+        pop(time);
+    }
+
+    void time_report::push(const std::string& name)
+    {
+        stack_.push_back(name);
+    }
+
+    void time_report::pop(double time)
+    {
+        BOBOPT_ASSERT(!stack_.empty());
+
+        add_time(total_, stack_.begin(), time);
+        if ((unit_ != nullptr) && (stack_.size() > unit_depth_))
+        {
+            add_time(*unit_, stack_.begin() + unit_depth_, time);
+        }
+
+        stack_.pop_back();
+    }
+
+    /// \brief Record phase measured by caller as a child of current phase.
+    void time_report::record(const std::string& name, double time)
+    {
+        push(name);
+        pop(time);
+    }
+
+    void time_report::add_item(item_kinds kind, const std::string& name, double time)
+    {
+        BOBOPT_ASSERT(kind < IK_COUNT);
+
+        auto& item = items_[kind][name];
+        ++item.first;
+        item.second += time;
+    }
+
+    void time_report::print(llvm::raw_ostream& out) const
+    {
+        out << "===" << std::string(73, '-') << "===\n";
+        out << std::string(30, ' ') << "bobopt time report\n";
+        out << "===" << std::string(73, '-') << "===\n";
+
+        for (const auto& unit : units_)
+        {
+            out << "\nTranslation unit: " << unit->name << '\n';
+            print_tree(out, *unit);
+        }
+
+        out << "\nTotal:\n";
+        print_tree(out, total_);
+
+        for (unsigned kind = 0; kind < IK_COUNT; ++kind)
+        {
+            print_items(out, static_cast<item_kinds>(kind));
+        }
+
+        out.flush();
+    }
+
+    time_report::node& time_report::get_child(node& parent, const std::string& name)
+    {
+        for (auto& child : parent.children)
+        {
+            if (child->name == name)
+            {
+                return *child;
+            }
+        }
+
+        parent.children.push_back(make_unique<node>(name));
+        return *parent.children.back();
+    }
+
+    void time_report::add_time(node& root, std::vector<std::string>::const_iterator first, double time)
+    {
+        node* current = &root;
+        for (; first != stack_.end(); ++first)
+        {
+            current = &get_child(*current, *first);
+        }
+
+        ++current->count;
+        current->time += time;
+    }
+
+    void time_report::print_tree(llvm::raw_ostream& out, const node& root)
+    {
+        double total = root.time;
+        if (total <= 0.0)
+        {
+            for (const auto& child : root.children)
+            {
+                total += child->time;
+            }
+        }
+
+        out << "   Time (ms)       %     Count  Phase\n";
+        if (root.count != 0)
+        {
+            print_node(out, root, 0, total);
+        }
+        else
+        {
+            for (const auto& child : root.children)
+            {
+                print_node(out, *child, 0, total);
+            }
+        }
+    }
+
+    /// \brief Print node and its children. Time of node not covered by
+    /// children is printed as separate phase.
+    void time_report::print_node(llvm::raw_ostream& out, const node& current, unsigned depth, double total)
+    {
+        const double percent = (total > 0.0) ? (100.0 * current.time / total) : 0.0;
+        out << llvm::format("%12.3f  %6.2f  %8llu  ", current.time, percent, current.count) << std::string(2 * depth, ' ') << current.name
+            << '\n';
+
+        if (current.children.empty())
+        {
+            return;
+        }
+
+        double children_time = 0.0;
+        for (const auto& child : current.children)
+        {
+            print_node(out, *child, depth + 1, total);
+            children_time += child->time;
+        }
+
+        const double other = current.time - children_time;
+        if (other > 0.0005)
+        {
+            const double other_percent = (total > 0.0) ? (100.0 * other / total) : 0.0;
+            out << llvm::format("%12.3f  %6.2f  %8s  ", other, other_percent, "") << std::string(2 * (depth + 1), ' ') << OTHER_PHASE << '\n';
+        }
+    }
+
+    void time_report::print_items(llvm::raw_ostream& out, item_kinds kind) const
+    {
+        typedef std::pair<std::string, std::pair<unsigned long long, double> > item_type;
+
+        std::vector<item_type> items(items_[kind].begin(), items_[kind].end());
+        if (items.empty())
+        {
+            return;
+        }
+
+        std::stable_sort(items.begin(), items.end(), [](const item_type& lhs, const item_type& rhs)
+                         { return lhs.second.second > rhs.second.second; });
+
+        out << "\nTop " << TOP_ITEMS << ' ' << ITEM_KIND_NAMES[kind] << ":\n";
+        out << "   Time (ms)     Count  Name\n";
+
+        const std::size_t count = std::min<std::size_t>(items.size(), TOP_ITEMS);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            out << llvm::format("%12.3f  %8llu  ", items[i].second.second, items[i].second.first) << items[i].first << '\n';
+        }
+    }
+
+    // scoped_timer implementation.
+    //==========================================================================
+
+    scoped_timer::scoped_timer(const char* name)
+        : active_(time_report::instance().enabled())
+        , start_()
+    {
+        if (active_)
+        {
+            time_report::instance().push(name);
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    scoped_timer::~scoped_timer()
+    {
+        if (active_)
+        {
+            time_report::instance().pop(elapsed());
+        }
+    }
+
+} // namespace
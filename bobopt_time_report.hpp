@@ -0,0 +1,122 @@
+/// \file bobopt_time_report.hpp File contains hierarchical timers of the
+/// optimizer phases.
+
+#ifndef BOBOPT_TIME_REPORT_HPP_GUARD_
+#define BOBOPT_TIME_REPORT_HPP_GUARD_
+
+#include <bobopt_inline.hpp>
+#include <bobopt_macros.hpp>
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// forward declarations:
+namespace llvm
+{
+    class raw_ostream;
+}
+
+namespace bobopt
+{
+
+    // time_report:
+    //==========================================================================
+
+    /// \brief Gateway singleton to hierarchical timers of optimizer phases.
+    ///
+    /// Timers form a tree by nesting of \c scoped_timer objects. Times are
+    /// accumulated for each translation unit and for the whole run. Boxes and
+    /// box methods are ranked separately to find the most expensive ones.
+    class time_report
+    {
+    public:
+        /// \brief Node of timer tree. Children are kept in order of the first
+        /// measurement.
+        struct node
+        {
+            explicit node(std::string name);
+
+            std::string name;
+            unsigned long long count;
+            double time;
+            std::vector<std::unique_ptr<node> > children;
+        };
+
+        /// \brief Kinds of ranked items.
+        enum item_kinds
+        {
+            IK_BOX,
+            IK_METHOD,
+
+            IK_COUNT
+        };
+
+        /// \brief Number of items printed for each kind.
+        static const unsigned TOP_ITEMS = 10u;
+
+        static time_report& instance();
+
+        void enable();
+        bool enabled() const;
+
+        void begin_unit(const std::string& file_name);
+        void end_unit();
+
+        void push(const std::string& name);
+        void pop(double time);
+        void record(const std::string& name, double time);
+        void add_item(item_kinds kind, const std::string& name, double time);
+
+        void print(llvm::raw_ostream& out) const;
+
+    private:
+        time_report();
+        BOBOPT_NONCOPYMOVABLE(time_report);
+
+        static node& get_child(node& parent, const std::string& name);
+        void add_time(node& root, std::vector<std::string>::const_iterator first, double time);
+
+        static void print_tree(llvm::raw_ostream& out, const node& root);
+        static void print_node(llvm::raw_ostream& out, const node& current, unsigned depth, double total);
+        void print_items(llvm::raw_ostream& out, item_kinds kind) const;
+
+        bool enabled_;
+        node total_;
+        std::vector<std::unique_ptr<node> > units_;
+        node* unit_;
+        std::size_t unit_depth_;
+        std::chrono::steady_clock::time_point unit_start_;
+        std::vector<std::string> stack_;
+        std::map<std::string, std::pair<unsigned long long, double> > items_[IK_COUNT];
+    };
+
+    // scoped_timer:
+    //==========================================================================
+
+    /// \brief Measure wall time of the scope as a phase nested in the phase
+    /// of enclosing timer. Does nothing when time report is not enabled.
+    class scoped_timer
+    {
+    public:
+        explicit scoped_timer(const char* name);
+        ~scoped_timer();
+
+        /// \brief Elapsed time in milliseconds.
+        double elapsed() const;
+
+    private:
+        BOBOPT_NONCOPYMOVABLE(scoped_timer);
+
+        bool active_;
+        std::chrono::steady_clock::time_point start_;
+    };
+
+} // namespace
+
+#include BOBOPT_INLINE_IN_HEADER(bobopt_time_report.inl)
+
+#endif // guard
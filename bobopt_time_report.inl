@@ -0,0 +1,19 @@
+namespace bobopt
+{
+
+    BOBOPT_INLINE void time_report::enable()
+    {
+        enabled_ = true;
+    }
+
+    BOBOPT_INLINE bool time_report::enabled() const
+    {
+        return enabled_;
+    }
+
+    BOBOPT_INLINE double scoped_timer::elapsed() const
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_).count();
+    }
+
+} // namespace
@@ -6,7 +6,10 @@
 #include <bobopt_inline.hpp>
 #include <bobopt_language.hpp>
 
+#include <cstdint>
+#include <cstdio>
 #include <memory>
+#include <string>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -87,6 +90,24 @@ namespace bobopt
         return (begin <= value) && (value < end);
     }
 
+    // content_hash.
+    //==========================================================================
+
+    /// \brief FNV-1a hash of content as hexadecimal string, stable across runs and platforms.
+    inline std::string content_hash(const std::string& content)
+    {
+        std::uint64_t hash = 14695981039346656037ull;
+        for (unsigned char c : content)
+        {
+            hash ^= c;
+            hash *= 1099511628211ull;
+        }
+
+        char buffer[17];
+        std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(hash));
+        return buffer;
+    }
+
 } // namespace
 
 #endif // guard
\ No newline at end of file
@@ -0,0 +1,191 @@
+#include <bobopt_what_if.hpp>
+
+#include <bobopt_debug.hpp>
+
+#include <clang/bobopt_clang_prolog.hpp>
+#include "llvm/Support/raw_ostream.h"
+#include <clang/bobopt_clang_epilog.hpp>
+
+#include <algorithm>
+#include <functional>
+
+namespace bobopt
+{
+
+    // Constants.
+    //==========================================================================
+
+    /// \brief Printed value of decision method didn't record under configuration.
+    static const char* const NO_DECISION = "none";
+
+    // what_if_report implementation.
+    //==========================================================================
+
+    what_if_report::what_if_report(std::vector<std::string> config_files)
+        : config_files_(std::move(config_files))
+        , settings_()
+        , boxes_()
+        , config_(0)
+    {
+    }
+
+    what_if_report::~what_if_report()
+    {
+    }
+
+    /// \brief Read settings of all configuration files.
+    ///
+    /// Unknown variables are reported and dropped, so they aren't reported again
+    /// for every box. Invalid value fails the whole report, its configuration
+    /// couldn't be compared.
+    bool what_if_report::load()
+    {
+        settings_.clear();
+        settings_.resize(config_files_.size());
+
+        config_parser parser;
+        for (std::size_t i = 0; i < config_files_.size(); ++i)
+        {
+            std::vector<config_setting> settings;
+            if (!parser.read(config_files_[i], settings))
+            {
+                llvm::errs() << "[WARNING] Failed to load configuration file: " << config_files_[i] << "\n";
+                return false;
+            }
+
+            for (const auto& setting : settings)
+            {
+                config_group* group = config_map::instance().get_group(setting.group);
+                if ((group == nullptr) || (group->find_variable(setting.variable) == nullptr))
+                {
+                    llvm::errs() << "[WARNING] Unknown variable " << setting.variable << " in [" << setting.group << "] of: " << config_files_[i] << "\n";
+                    continue;
+                }
+
+                settings_[i].push_back(setting);
+            }
+
+            // Values are checked on top of current configuration, check restores it.
+            config_override check;
+            for (const auto& setting : settings_[i])
+            {
+                if (!check.set(setting.group, setting.variable, setting.value))
+                {
+                    llvm::errs() << "[WARNING] Invalid value of variable " << setting.variable << " in [" << setting.group << "] of: " << config_files_[i] << "\n";
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    std::size_t what_if_report::get_config_count() const
+    {
+        return config_files_.size();
+    }
+
+    /// \brief Override configuration variables by settings of current configuration file.
+    void what_if_report::apply_config(config_override& overrides) const
+    {
+        BOBOPT_ASSERT(config_ < settings_.size());
+
+        for (const auto& setting : settings_[config_])
+        {
+            BOBOPT_CHECK(overrides.set(setting.group, setting.variable, setting.value));
+        }
+    }
+
+    /// \brief Following decisions are made for box.
+    void what_if_report::begin_box(const std::string& name)
+    {
+        box_decisions box;
+        box.name = name;
+        boxes_.push_back(std::move(box));
+        config_ = 0;
+    }
+
+    /// \brief Following decisions are made under configuration.
+    void what_if_report::set_config(std::size_t index)
+    {
+        BOBOPT_ASSERT(index < config_files_.size());
+        config_ = index;
+    }
+
+    /// \brief Index of configuration following decisions are made under.
+    std::size_t what_if_report::get_config() const
+    {
+        return config_;
+    }
+
+    /// \brief Record decision of method for current box and configuration.
+    ///
+    /// Decision recorded more times, e.g., for each instantiation of box template,
+    /// keeps all values.
+    void what_if_report::record(const std::string& subject, const std::string& aspect, const std::string& value)
+    {
+        BOBOPT_ASSERT(!boxes_.empty());
+
+        std::vector<std::string>& values = boxes_.back().decisions[std::make_pair(subject, aspect)];
+        values.resize(config_files_.size());
+
+        std::string& current = values[config_];
+        current += (current.empty() ? "" : "; ") + value;
+    }
+
+    /// \brief Print decisions which differ between configurations for each box.
+    void what_if_report::print(llvm::raw_ostream& out) const
+    {
+        out << "What-if analysis of " << config_files_.size() << " configurations:\n";
+        for (std::size_t i = 0; i < config_files_.size(); ++i)
+        {
+            out << "  [" << (i + 1) << "] " << config_files_[i] << "\n";
+        }
+        out << "\n";
+
+        std::size_t differing_boxes = 0;
+        for (const auto& box : boxes_)
+        {
+            std::size_t identical = 0;
+            std::vector<std::pair<const decision_key*, const std::vector<std::string>*> > differing;
+            for (const auto& decision : box.decisions)
+            {
+                const auto& values = decision.second;
+                if (std::adjacent_find(values.begin(), values.end(), std::not_equal_to<std::string>()) == values.end())
+                {
+                    ++identical;
+                    continue;
+                }
+
+                differing.emplace_back(&decision.first, &decision.second);
+            }
+
+            if (differing.empty())
+            {
+                out << "box " << box.name << ": " << identical << " decision(s), identical in all configurations\n";
+                continue;
+            }
+
+            ++differing_boxes;
+            out << "box " << box.name << ":\n";
+            for (const auto& decision : differing)
+            {
+                out << "  " << decision.first->first << " " << decision.first->second << ":";
+                for (std::size_t i = 0; i < decision.second->size(); ++i)
+                {
+                    const std::string& value = (*decision.second)[i];
+                    out << ((i == 0) ? " " : ", ") << "[" << (i + 1) << "] " << (value.empty() ? NO_DECISION : value);
+                }
+                out << "\n";
+            }
+
+            if (identical != 0)
+            {
+                out << "  " << identical << " other decision(s) identical in all configurations\n";
+            }
+        }
+
+        out << "\n" << differing_boxes << " of " << boxes_.size() << " boxes differ between configurations.\n";
+    }
+
+} // namespace
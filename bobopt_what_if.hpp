@@ -0,0 +1,79 @@
+/// \file bobopt_what_if.hpp File contains comparison of optimization decisions
+/// under several configurations.
+///
+/// Every box is analyzed once per configuration against the same AST, so
+/// comparing N configurations costs a single parse. Methods record their
+/// decisions, e.g., number of inserted yields or prefetched inputs, and the
+/// report shows decisions that differ between configurations.
+
+#ifndef BOBOPT_WHAT_IF_HPP_GUARD_
+#define BOBOPT_WHAT_IF_HPP_GUARD_
+
+#include <bobopt_config.hpp>
+#include <bobopt_macros.hpp>
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// forward declarations:
+namespace llvm
+{
+    class raw_ostream;
+}
+
+namespace bobopt
+{
+
+    // what_if_report:
+    //==========================================================================
+
+    /// \brief Decisions of optimization methods under each of configurations.
+    ///
+    /// Configuration files are applied on top of the configuration loaded by
+    /// \c -c option and configuration files of box directory, variables they
+    /// don't set keep its values. Annotations of box override them.
+    class what_if_report
+    {
+    public:
+        explicit what_if_report(std::vector<std::string> config_files);
+        ~what_if_report();
+
+        bool load();
+
+        std::size_t get_config_count() const;
+        void apply_config(config_override& overrides) const;
+
+        void begin_box(const std::string& name);
+        void set_config(std::size_t index);
+        std::size_t get_config() const;
+        void record(const std::string& subject, const std::string& aspect, const std::string& value);
+
+        void print(llvm::raw_ostream& out) const;
+
+    private:
+        BOBOPT_NONCOPYMOVABLE(what_if_report);
+
+        /// \brief Decision is identified by subject, e.g., member function, and its aspect.
+        typedef std::pair<std::string, std::string> decision_key;
+        /// \brief Values of decision indexed by configuration.
+        typedef std::map<decision_key, std::vector<std::string> > decisions_type;
+
+        /// \brief Decisions of single box.
+        struct box_decisions
+        {
+            std::string name;
+            decisions_type decisions;
+        };
+
+        std::vector<std::string> config_files_;
+        std::vector<std::vector<config_setting> > settings_;
+        std::vector<box_decisions> boxes_;
+        std::size_t config_;
+    };
+
+} // namespace
+
+#endif // guard
@@ -5,6 +5,7 @@
 #ifndef BOBOPT_CLANG_CONTROL_FLOW_SEARCH_HPP_GUARD
 #define BOBOPT_CLANG_CONTROL_FLOW_SEARCH_HPP_GUARD
 
+#include <bobopt_budget.hpp>
 #include <bobopt_config.hpp>
 #include <bobopt_debug.hpp>
 #include <bobopt_inline.hpp>
@@ -22,6 +23,7 @@
 #include <algorithm>
 #include <iterator>
 #include <map>
+#include <memory>
 #include <type_traits>
 #include <vector>
 
@@ -38,6 +40,10 @@ namespace bobopt
         static config_group config("control_flow_search");
         /// \brief Configuration variable for loop body traversal.
         static config_variable<bool> config_loop_body(config, "search_loop_body", true);
+        /// \brief Maximal number of statements traversed by single search, zero for unlimited.
+        static config_variable<unsigned> config_max_statements(config, "max_statements", 100000u);
+        /// \brief Maximal wall time of single search in milliseconds, zero for unlimited.
+        static config_variable<unsigned> config_time_budget(config, "time_budget_ms", 1000u);
 
     } // detail
 
@@ -443,8 +449,11 @@ namespace bobopt
         bool has_value(const value_type& val) const;
         locations_type get_locations(const value_type& val) const;
         std::pair<unsigned, unsigned> get_min_max(const value_type& val) const;
+        analysis_budget::limits get_exceeded_limit() const;
 
         // traversal:
+        bool TraverseStmt(clang::Stmt* stmt);
+
         bool TraverseIfStmt(clang::IfStmt* if_stmt);
         bool VisitIfStmt(clang::IfStmt* if_stmt);
 
@@ -504,6 +513,7 @@ namespace bobopt
         bool traverse_for_body(clang::ForStmt* for_stmt) const;
         bool traverse_while_body(clang::WhileStmt* while_stmt) const;
         bool should_continue() const;
+        void spawn(scoped_prototype<control_flow_search>& visitor);
 
         // value helpers:
         const container_type& get_container() const;
@@ -514,6 +524,7 @@ namespace bobopt
 
         container_type values_map_;
         int flags_;
+        std::shared_ptr<analysis_budget> budget_;
     };
 
     // control_flow_search implementation.
@@ -575,6 +586,36 @@ namespace bobopt
         return std::make_pair(found->second.min, found->second.max);
     }
 
+    /// \brief Get limit of analysis budget exceeded by search.
+    ///
+    /// Values collected by search that exceeded its budget are incomplete and
+    /// client should not rely on them.
+    template <typename Derived, typename Value, template <typename> class PrototypePolicy>
+    BOBOPT_INLINE analysis_budget::limits control_flow_search<Derived, Value, PrototypePolicy>::get_exceeded_limit() const
+    {
+        return (budget_ != nullptr) ? budget_->get_exceeded() : analysis_budget::LIMIT_NONE;
+    }
+
+    /// \brief Every traversed statement consumes analysis budget shared by all prototypes of search.
+    ///
+    /// Search stops traversal once budget is exhausted. Budget is created by
+    /// the first traversal of the root visitor.
+    template <typename Derived, typename Value, template <typename> class PrototypePolicy>
+    BOBOPT_INLINE bool control_flow_search<Derived, Value, PrototypePolicy>::TraverseStmt(clang::Stmt* stmt)
+    {
+        if (budget_ == nullptr)
+        {
+            budget_ = std::make_shared<analysis_budget>(detail::config_max_statements.get(), detail::config_time_budget.get());
+        }
+
+        if (!budget_->consume())
+        {
+            return false;
+        }
+
+        return clang::RecursiveASTVisitor<Derived>::TraverseStmt(stmt);
+    }
+
     /// \brief Recursive traversal of if statement will be handled by VisitIfStmt member function.
     template <typename Derived, typename Value, template <typename> class PrototypePolicy>
     BOBOPT_INLINE bool control_flow_search<Derived, Value, PrototypePolicy>::TraverseIfStmt(clang::IfStmt* if_stmt)
@@ -595,7 +636,8 @@ namespace bobopt
         clang::Expr* cond_expr = if_stmt->getCond();
         BOBOPT_ASSERT(cond_expr != nullptr);
 
-        scoped_prototype<control_flow_search> cond_visitor(*this);
+        scoped_prototype<control_flow_search> cond_visitor(*this, false);
+        spawn(cond_visitor);
         cond_visitor.get().TraverseStmt(cond_expr);
         flags_ |= cond_visitor.get().flags_;
 
@@ -604,7 +646,7 @@ namespace bobopt
         clang::Stmt* then_stmt = if_stmt->getThen();
         if (then_stmt != nullptr)
         {
-            then_visitor.create();
+            spawn(then_visitor);
             BOBOPT_ASSERT(then_visitor.valid());
             then_visitor.get().TraverseStmt(then_stmt);
             flags_ |= then_visitor.get().flags_;
@@ -615,7 +657,7 @@ namespace bobopt
         clang::Stmt* else_stmt = if_stmt->getElse();
         if (else_stmt != nullptr)
         {
-            else_visitor.create();
+            spawn(else_visitor);
             BOBOPT_ASSERT(else_visitor.valid());
             else_visitor.get().TraverseStmt(else_stmt);
             flags_ |= else_visitor.get().flags_;
@@ -672,7 +714,7 @@ namespace bobopt
         scoped_prototype<control_flow_search> init_visitor(*this, false);
         if (init_stmt != nullptr)
         {
-            init_visitor.create();
+            spawn(init_visitor);
             BOBOPT_ASSERT(init_visitor.valid());
             init_visitor.get().TraverseStmt(init_stmt);
             flags_ |= init_visitor.get().flags_;
@@ -683,7 +725,7 @@ namespace bobopt
         scoped_prototype<control_flow_search> cond_visitor(*this, false);
         if (cond_expr != nullptr)
         {
-            cond_visitor.create();
+            spawn(cond_visitor);
             BOBOPT_ASSERT(cond_visitor.valid());
             cond_visitor.get().TraverseStmt(cond_expr);
             flags_ |= cond_visitor.get().flags_;
@@ -697,7 +739,7 @@ namespace bobopt
             clang::Stmt* body_stmt = for_stmt->getBody();
             if (body_stmt != nullptr)
             {
-                body_visitor.create();
+                spawn(body_visitor);
                 BOBOPT_ASSERT(body_visitor.valid());
                 body_visitor.get().TraverseStmt(body_stmt);
                 flags_ |= body_visitor.get().flags_;
@@ -706,7 +748,7 @@ namespace bobopt
             clang::Expr* incr_expr = for_stmt->getInc();
             if (incr_expr != nullptr)
             {
-                incr_visitor.create();
+                spawn(incr_visitor);
                 BOBOPT_ASSERT(incr_visitor.valid());
                 incr_visitor.get().TraverseStmt(incr_expr);
                 flags_ |= incr_visitor.get().flags_;
@@ -757,7 +799,7 @@ namespace bobopt
         scoped_prototype<control_flow_search> cond_visitor(*this, false);
         if (cond_expr != nullptr)
         {
-            cond_visitor.create();
+            spawn(cond_visitor);
             BOBOPT_ASSERT(cond_visitor.valid());
             cond_visitor.get().TraverseStmt(cond_expr);
             flags_ |= cond_visitor.get().flags_;
@@ -770,7 +812,7 @@ namespace bobopt
             clang::Stmt* body_stmt = while_stmt->getBody();
             if (body_stmt != nullptr)
             {
-                body_visitor.create();
+                spawn(body_visitor);
                 BOBOPT_ASSERT(body_visitor.valid());
                 body_visitor.get().TraverseStmt(body_stmt);
                 flags_ |= body_visitor.get().flags_;
@@ -811,7 +853,8 @@ namespace bobopt
         clang::Expr* cond_expr = switch_stmt->getCond();
         BOBOPT_ASSERT(cond_expr != nullptr);
 
-        scoped_prototype<control_flow_search> cond_visitor(*this);
+        scoped_prototype<control_flow_search> cond_visitor(*this, false);
+        spawn(cond_visitor);
         BOBOPT_ASSERT(cond_visitor.valid());
         cond_visitor.get().TraverseStmt(cond_expr);
         flags_ |= cond_visitor.get().flags_;
@@ -843,7 +886,8 @@ namespace bobopt
         clang::Stmt* try_block = try_stmt->getTryBlock();
         if (try_block != nullptr)
         {
-            scoped_prototype<control_flow_search> block_visitor(*this);
+            scoped_prototype<control_flow_search> block_visitor(*this, false);
+            spawn(block_visitor);
             BOBOPT_ASSERT(block_visitor.valid());
             block_visitor.get().TraverseStmt(try_block);
             flags_ |= block_visitor.get().flags_;
@@ -907,6 +951,7 @@ namespace bobopt
         : context_(context)
         , values_map_()
         , flags_(0)
+        , budget_()
     {
     }
 
@@ -1014,6 +1059,14 @@ namespace bobopt
         return result;
     }
 
+    /// \brief Create prototyped visitor that shares analysis budget with this visitor.
+    template <typename Derived, typename Value, template <typename> class PrototypePolicy>
+    BOBOPT_INLINE void control_flow_search<Derived, Value, PrototypePolicy>::spawn(scoped_prototype<control_flow_search>& visitor)
+    {
+        visitor.create();
+        visitor.get().budget_ = budget_;
+    }
+
     /// \brief Get access to visitor storage.
     template <typename Derived, typename Value, template <typename> class PrototypePolicy>
     BOBOPT_INLINE const typename control_flow_search<Derived, Value, PrototypePolicy>::container_type&
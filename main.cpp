@@ -1,16 +1,21 @@
+#include <bobopt_calibration.hpp>
 #include <bobopt_config.hpp>
+#include <bobopt_fixes.hpp>
+#include <bobopt_frontend.hpp>
+#include <bobopt_library.hpp>
 #include <bobopt_optimizer.hpp>
+#include <bobopt_server.hpp>
+#include <bobopt_what_if.hpp>
 
 #include <clang/bobopt_clang_prolog.hpp>
 #include "clang/ASTMatchers/ASTMatchFinder.h"
-#include "clang/Frontend/FrontendAction.h"
 #include "clang/Tooling/CommonOptionsParser.h"
 #include "clang/Tooling/Refactoring.h"
 #include "clang/Tooling/Tooling.h"
 #include <clang/bobopt_clang_epilog.hpp>
 
 #include <cstdarg>
-#include <memory>
+#include <iostream>
 #include <string>
 #include <vector>
 
@@ -18,109 +23,31 @@ using namespace clang;
 using namespace clang::ast_matchers;
 using namespace clang::tooling;
 
-namespace bobopt
-{
-
-    // optimizer_frontend_action_factory/optimizer_frontend_action implementation.
-    //==============================================================================
-
-    /// \brief A little wrapping to catch \c clang::CompilerInstance so we can access \c clang::Sema.
-    /// There's no other possibility to access those objects from code inside match finder handling
-    /// member function.
-    template <typename FactoryT>
-    class optimizer_frontend_action_factory : public FrontendActionFactory
-    {
-    public:
-
-        // create/destroy:
-        optimizer_frontend_action_factory(FactoryT* factory, bobopt::optimizer* optimizer);
-        virtual ~optimizer_frontend_action_factory() BOBOPT_OVERRIDE;
-
-        // inherited overriden members:
-        virtual FrontendAction* create() BOBOPT_OVERRIDE;
-
-    private:
-
-        /// \brief Wrapper for ASTFrontendAction that will actually catch instance of \c clang::CompilerInstance
-        /// and pass this to optimizer object.
-        class optimizer_frontend_action : public ASTFrontendAction
-        {
-        public:
-
-            // create/destroy:
-            optimizer_frontend_action(FactoryT* factory, bobopt::optimizer* optimizer);
-            virtual ~optimizer_frontend_action() BOBOPT_OVERRIDE;
-
-            // inherited overriden members:
-            virtual std::unique_ptr<ASTConsumer> CreateASTConsumer(clang::CompilerInstance& compiler_instance, StringRef) BOBOPT_OVERRIDE;
-
-        private:
-            FactoryT* factory_;
-            bobopt::optimizer* optimizer_;
-        };
-
-        FactoryT* factory_;
-        bobopt::optimizer* optimizer_;
-    };
-
-    // optimizer_frontend_action implementation.
-    //==============================================================================
-
-    /// \brief Create frontend action with all needed addition information.
-    template <typename FactoryT>
-    optimizer_frontend_action_factory<FactoryT>::optimizer_frontend_action::optimizer_frontend_action(FactoryT* factory, bobopt::optimizer* optimizer)
-        : factory_(factory)
-        , optimizer_(optimizer)
-    {
-    }
-
-    /// \brief Deletable through pointer to base.
-    template <typename FactoryT>
-    optimizer_frontend_action_factory<FactoryT>::optimizer_frontend_action::~optimizer_frontend_action()
-    {
-    }
-
-    /// \brief Immediately pass pointer to \c clang::CompilerInstance to optimizer object and create consumer using factory object.
-    template <typename FactoryT>
-    std::unique_ptr<ASTConsumer> optimizer_frontend_action_factory<FactoryT>::optimizer_frontend_action::CreateASTConsumer(clang::CompilerInstance& compiler_instance,
-                                                                                                           StringRef)
-    {
-        optimizer_->set_compiler(&compiler_instance);
-        return factory_->newASTConsumer();
-    }
-
-    // optimizer_frontend_action_factory implementation.
-    //==============================================================================
-
-    /// \brief Create factory with all needed additional information.
-    template <typename FactoryT>
-    optimizer_frontend_action_factory<FactoryT>::optimizer_frontend_action_factory(FactoryT* factory, bobopt::optimizer* optimizer)
-        : factory_(factory)
-        , optimizer_(optimizer)
-    {
-        BOBOPT_ASSERT(factory != nullptr);
-        BOBOPT_ASSERT(optimizer != nullptr);
-    }
-
-    /// \brief Deletable through pointer to base.
-    template <typename FactoryT>
-    optimizer_frontend_action_factory<FactoryT>::~optimizer_frontend_action_factory()
-    {
-    }
-
-    /// \brief Create wrapper of frontend action to catch \c clang::CompilerInstance.
-    template <typename FactoryT>
-    FrontendAction* optimizer_frontend_action_factory<FactoryT>::create()
-    {
-        return new optimizer_frontend_action(factory_, optimizer_);
-    }
-
-} // namespace
-
 /// \brief Setting up configuration file from command line.
 static llvm::cl::opt<std::string> opt_config_file("c", llvm::cl::desc("Specify config filename."), llvm::cl::value_desc("config file"));
 /// \brief Generation of default configuration file.
 static llvm::cl::opt<std::string> opt_gen_config_file("g", llvm::cl::desc("Generate default config file."), llvm::cl::value_desc("config file"));
+/// \brief Saving of time and memory statistics of the optimizer.
+static llvm::cl::opt<std::string> opt_stats_file("stats-file", llvm::cl::desc("Save time and memory statistics in JSON."), llvm::cl::value_desc("file"));
+/// \brief Parsing of bodies of functions optimizer doesn't analyze.
+static llvm::cl::opt<bool> opt_parse_all_bodies("parse-all-bodies", llvm::cl::desc("Parse bodies of all functions, also of those in system headers optimizer does not need."));
+/// \brief Parsing of translation units that can't contain any box.
+static llvm::cl::opt<bool> opt_no_prescan("no-prescan", llvm::cl::desc("Parse all translation units, even those lexical pre-scan finds without boxes."));
+/// \brief Precompiled header of includes common to translation units.
+static llvm::cl::opt<std::string> opt_pch_header("pch", llvm::cl::desc("Precompile header with common includes once and include it in all translation units."), llvm::cl::value_desc("header"));
+/// \brief Directory with precompiled headers kept between runs.
+static llvm::cl::opt<std::string> opt_pch_cache("pch-cache", llvm::cl::desc("Directory of precompiled headers kept between runs."), llvm::cl::value_desc("directory"), llvm::cl::init(".bobopt_pch"));
+/// \brief Long-lived server answering requests from standard input.
+static llvm::cl::opt<bool> opt_server("server", llvm::cl::desc("Keep running and answer analyze/apply/reload requests from standard input."));
+/// \brief Export of replacements to fixes file instead of modifying sources.
+static llvm::cl::opt<std::string> opt_export_fixes("export-fixes", llvm::cl::desc("Save replacements to fixes file, apply them later with -apply-fixes."), llvm::cl::value_desc("file"));
+/// \brief Comparison of decisions under several configurations in single parse.
+static llvm::cl::list<std::string> opt_what_if("what-if",
+                                               llvm::cl::desc("Analyze boxes under each configuration and print decisions that differ. No modifications."),
+                                               llvm::cl::value_desc("config files"),
+                                               llvm::cl::CommaSeparated);
+/// \brief Printing of time report of optimizer phases.
+static llvm::cl::opt<bool> opt_time_report("time-report", llvm::cl::desc("Print time spent in optimizer phases, translation units, boxes and methods."));
 
 /// \brief Command line option for program mode.
 static llvm::cl::opt<bobopt::modes>
@@ -129,6 +56,7 @@ opt_mode(llvm::cl::desc("Optimizer mode:"),
          llvm::cl::values(clEnumValN(bobopt::MODE_DIAGNOSTIC, "diagnostic", "Print diagnostic. No modifications."),
                           clEnumValN(bobopt::MODE_INTERACTIVE, "interactive", "Modify code according to user input."),
                           clEnumValN(bobopt::MODE_BUILD, "build", "Do not print any diagnostic, just modify code."),
+                          clEnumValN(bobopt::MODE_PROFILE, "profile", "Modify code as in build mode and insert profiling probes."),
                           clEnumValEnd));
 
 int main(int argc, const char* argv[])
@@ -150,8 +78,28 @@ int main(int argc, const char* argv[])
         return 0;
     }
 
+    // Applying of fixes files doesn't need compilation database either, it
+    // only merges fixes exported by previous runs.
+    if ((argc >= 3) && (std::string("-apply-fixes") == argv[1]))
+    {
+        const std::vector<std::string> file_names(argv + 2, argv + argc);
+        return bobopt::apply_fixes(file_names) ? 0 : 1;
+    }
+
+    // Calibration takes output configuration file before usual tooling
+    // options and sources.
+    std::string calibration_file;
+    std::vector<const char*> arguments(argv, argv + argc);
+    if ((argc >= 3) && (std::string("calibrate") == argv[1]))
+    {
+        calibration_file = argv[2];
+        arguments.erase(arguments.begin() + 1, arguments.begin() + 3);
+    }
+
+    int arguments_count = static_cast<int>(arguments.size());
+
     llvm::cl::OptionCategory category("Tooling options");
-    CommonOptionsParser options(argc, argv, category);
+    CommonOptionsParser options(arguments_count, arguments.data(), category);
 
     if (opt_gen_config_file.getNumOccurrences() > 0)
     {
@@ -167,28 +115,117 @@ int main(int argc, const char* argv[])
         return 0;
     }
 
+    bobopt::batch_optimizer batch(options.getCompilations(), opt_mode);
+    batch.set_skip_bodies(!opt_parse_all_bodies);
+    batch.set_prescan(!opt_no_prescan);
+
     if (opt_config_file.getNumOccurrences() > 0)
     {
         std::string file_name = opt_config_file.c_str();
-
-        bobopt::config_parser parser;
-        if (!parser.load(file_name))
+        if (!batch.load_config(file_name))
         {
             llvm::errs() << "Failed to load configuration file: " << file_name << "... using defaults.\n";
         }
     }
 
-    RefactoringTool tool(options.getCompilations(), options.getSourcePathList());
+    if (opt_stats_file.getNumOccurrences() > 0)
+    {
+        batch.set_stats_file(opt_stats_file.c_str());
+    }
+
+    batch.set_time_report(opt_time_report);
+
+    if (!calibration_file.empty())
+    {
+        // All translation units are scanned, pre-scan would skip those without boxes.
+        ClangTool tool(options.getCompilations(), options.getSourcePathList());
+
+        bobopt::calibration calibration;
+
+        MatchFinder finder;
+        finder.addMatcher(bobopt::calibration::FUNCTION_MATCHER, &calibration);
+        finder.addMatcher(bobopt::calibration::FOR_MATCHER, &calibration);
+
+        int result = tool.run(newFrontendActionFactory(&finder).get());
+        if (!calibration.save(calibration_file))
+        {
+            llvm::errs() << "Failed to save calibrated configuration file to: " << calibration_file << '\n';
+            result = 1;
+        }
+
+        batch.report();
+        return result;
+    }
+
+    if (opt_pch_header.getNumOccurrences() > 0)
+    {
+        batch.set_pch(opt_pch_header.c_str(), opt_pch_cache.c_str());
+    }
 
-    bobopt::optimizer optimizer(opt_mode, &tool.getReplacements());
+    const CompilationDatabase& compilations = batch.get_compilations();
 
-    MatchFinder finder;
-    finder.addMatcher(bobopt::optimizer::BOBOX_BOX_MATCHER, &optimizer);
-    finder.addMatcher(bobopt::optimizer::BOBOX_BASIC_BOX_MATCHER, &optimizer);
-    finder.addMatcher(bobopt::optimizer::USER_BOX_MATCHER, &optimizer);
+    if (!opt_what_if.empty())
+    {
+        bobopt::what_if_report report(std::vector<std::string>(opt_what_if.begin(), opt_what_if.end()));
+        if (!report.load())
+        {
+            return 1;
+        }
 
-    bobopt::optimizer_frontend_action_factory<MatchFinder> frontend_action_factory(&finder, &optimizer);
-    int result = tool.runAndSave(&frontend_action_factory);
+        // Methods record decisions to report, diagnostic of every configuration would only repeat them.
+        ClangTool tool(compilations, batch.scan_sources(options.getSourcePathList()));
+        Replacements replacements;
+        bobopt::optimizer optimizer(bobopt::MODE_BUILD, &replacements);
+        optimizer.set_what_if(&report);
+
+        MatchFinder finder;
+        bobopt::add_box_matchers(finder, &optimizer);
+
+        bobopt::optimizer_frontend_action_factory<MatchFinder> frontend_action_factory(&finder, &optimizer, !opt_parse_all_bodies);
+
+        const int result = tool.run(&frontend_action_factory);
+        report.print(llvm::outs());
+        batch.report();
+        return result;
+    }
+
+    if (opt_server)
+    {
+        // Server answers on standard input, it can't ask user questions there.
+        if (opt_mode == bobopt::MODE_INTERACTIVE)
+        {
+            llvm::errs() << "Interactive mode can't be used by server.\n";
+            return 1;
+        }
+
+        auto analyze = [&](const std::string& source, Replacements& replacements, std::vector<std::string>& dependencies) -> bool
+        {
+            ClangTool tool(compilations, std::vector<std::string>(1, source));
+            bobopt::optimizer optimizer(opt_mode, &replacements);
+
+            MatchFinder finder;
+            bobopt::add_box_matchers(finder, &optimizer);
+
+            bobopt::optimizer_frontend_action_factory<MatchFinder> frontend_action_factory(&finder, &optimizer, !opt_parse_all_bodies);
+            frontend_action_factory.set_dependencies(&dependencies);
+
+            // Statistics are saved and time report printed after every request.
+            const bool result = (tool.run(&frontend_action_factory) == 0);
+            batch.report();
+            return result;
+        };
+
+        // Sources given on command line warm up the server.
+        bobopt::server server(analyze);
+        server.warm_up(batch.scan_sources(options.getSourcePathList()));
+
+        return server.serve(std::cin, llvm::outs());
+    }
+
+    if (opt_export_fixes.getNumOccurrences() > 0)
+    {
+        batch.set_export_fixes(opt_export_fixes.c_str());
+    }
 
-    return result;
+    return batch.optimize_files(options.getSourcePathList()) ? 0 : 1;
 }
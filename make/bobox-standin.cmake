@@ -0,0 +1,4 @@
+set(BOBOPT_FOLDERS true CACHE BOOL "" FORCE)
+
+set(BUILD_BENCHMARKS true CACHE BOOL "" FORCE)
+set(BOBOX_STANDIN true CACHE BOOL "" FORCE)
\ No newline at end of file
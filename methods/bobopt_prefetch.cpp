@@ -1,15 +1,20 @@
 #include <methods/bobopt_prefetch.hpp>
 
+#include <bobopt_analysis_context.hpp>
+#include <bobopt_budget.hpp>
 #include <bobopt_debug.hpp>
 #include <bobopt_language.hpp>
 #include <bobopt_macros.hpp>
 #include <bobopt_optimizer.hpp>
 #include <bobopt_text_utils.hpp>
+#include <bobopt_time_report.hpp>
 #include <clang/bobopt_clang_utils.hpp>
 #include <clang/bobopt_control_flow_search.hpp>
 
 #include <clang/bobopt_clang_prolog.hpp>
+#include "llvm/ADT/SmallString.h"
 #include "llvm/Support/Casting.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/raw_ostream.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/AST/ASTContext.h"
@@ -529,6 +534,10 @@ namespace bobopt
             , decl_indent_()
             , line_indent_()
             , endl_()
+            , merging_(false)
+            , insertions_()
+            , merged_()
+            , merge_key_()
         {
         }
 
@@ -537,6 +546,30 @@ namespace bobopt
         {
         }
 
+        /// \brief Name of exceeded search budget limit used in diagnostic and counter.
+        static const char* get_budget_limit_name(analysis_budget::limits limit)
+        {
+            switch (limit)
+            {
+            case analysis_budget::LIMIT_STEPS:
+            {
+                return "statements";
+            }
+
+            case analysis_budget::LIMIT_TIME:
+            {
+                return "time";
+            }
+
+            default:
+            {
+                BOBOPT_ERROR("Should never reach this code.");
+            }
+            }
+
+            return "none";
+        }
+
         /// \brief Main optimization function.
         ///
         /// Step by step prepares object for optimization pass, collect inputs,
@@ -554,6 +587,8 @@ namespace bobopt
             BOBOPT_ASSERT(box != nullptr);
             BOBOPT_ASSERT(replacements != nullptr);
 
+            scoped_timer timer("prefetch::optimize");
+
             prepare();
 
             box_ = box;
@@ -586,6 +621,24 @@ namespace bobopt
             analyze_sync(used);
             analyze_body(used);
 
+            analysis_budget::limits limit = prefetched.get_exceeded_limit();
+            if (limit == analysis_budget::LIMIT_NONE)
+            {
+                limit = used.get_exceeded_limit();
+            }
+
+            if (limit != analysis_budget::LIMIT_NONE)
+            {
+                // (global.6) Search exceeded its budget, collected inputs are incomplete.
+                if (get_optimizer().verbose())
+                {
+                    emit_header();
+                }
+                report_budget_exceeded(box_, "prefetch", get_budget_limit_name(limit), "skipping box");
+                get_optimizer().record_decision("init_impl", "prefetched inputs", std::string("budget exceeded (") + get_budget_limit_name(limit) + ")");
+                return;
+            }
+
             names_type used_names = used.get_values();
             if (used_names.empty())
             {
@@ -607,31 +660,28 @@ namespace bobopt
                                 std::back_inserter(to_prefetch_names) // A - B
                                 );
 
+            const uses_type uses = get_uses(used_names, used);
+
             if (!to_prefetch_names.empty())
             {
                 if (init_ != nullptr)
                 {
-                    insert_into_body(to_prefetch_names, used);
+                    insert_into_body(to_prefetch_names, uses);
                 }
                 else
                 {
-                    insert_init_impl(to_prefetch_names, used);
+                    insert_init_impl(to_prefetch_names, uses);
                 }
             }
 
-            if (config_after_execution.get() && !used_names.empty())
+            if (config_after_execution.get())
             {
-                const auto filtered = filter_names(to_prefetch_names, used);
-                used_names.insert(used_names.end(), filtered.begin(), filtered.end());
-                std::sort(used_names.begin(), used_names.end());
-                used_names.erase(std::unique(used_names.begin(), used_names.end()), used_names.end());
-
                 if ((sync_ != nullptr) && sync_->hasBody())
                 {
                     CompoundStmt* body = llvm::dyn_cast_or_null<CompoundStmt>(sync_->getBody());
                     if ((body != nullptr) && !body->body_empty())
                     {
-                        attach_to_body(used_names, body);
+                        attach_to_body(used_names, uses, sync_, body);
                     }
                 }
 
@@ -640,12 +690,63 @@ namespace bobopt
                     CompoundStmt* body = llvm::dyn_cast_or_null<CompoundStmt>(body_->getBody());
                     if ((body != nullptr) && !body->body_empty())
                     {
-                        attach_to_body(used_names, body);
+                        attach_to_body(used_names, uses, body_, body);
                     }
                 }
             }
         }
 
+        /// \brief Inputs of box template are merged by name, each prefetch call is inserted once.
+        basic_method::merge_policies prefetch::get_merge_policy() const
+        {
+            return MERGE_METHOD;
+        }
+
+        /// \brief Collect insertions of following instantiations instead of inserting them.
+        void prefetch::begin_merge(const std::string& key)
+        {
+            merging_ = true;
+            merge_key_ = key;
+            insertions_.clear();
+        }
+
+        /// \brief Insert prefetch calls of all instantiations into box template.
+        ///
+        /// User is asked once for each input, diagnostic shows instantiations which
+        /// use the input. Calls are generated from inputs of instantiations of all
+        /// translation units so far.
+        void prefetch::end_merge(CXXRecordDecl* box, Replacements* replacements)
+        {
+            BOBOPT_ASSERT(box != nullptr);
+            BOBOPT_ASSERT(replacements != nullptr);
+
+            merging_ = false;
+
+            box_ = box;
+            replacements_ = replacements;
+
+            for (auto& site : insertions_)
+            {
+                merge_insertion(std::move(site));
+            }
+
+            insertions_.clear();
+
+            for (const auto& merged : merged_[merge_key_])
+            {
+                if (merged.prefetched.empty())
+                {
+                    continue;
+                }
+
+                const names_type names(merged.prefetched.begin(), merged.prefetched.end());
+                get_optimizer().record_decision(merged.subject, merged.aspect, join_names(names));
+
+                const std::string code = merged.prolog + make_prefetch_code(names, merged.indent, merged.endl) + merged.epilog;
+                replacements_->insert(Replacement(merged.file, merged.offset, 0, code));
+            }
+        }
+
         /// \brief Prepare object to optimization.
         void prefetch::prepare()
         {
@@ -777,6 +878,18 @@ namespace bobopt
             used.TraverseStmt(body_->getBody());
         }
 
+        /// \brief Names of inputs separated by commas for what-if report.
+        static std::string join_names(const std::vector<std::string>& names)
+        {
+            std::string result;
+            for (const auto& name : names)
+            {
+                result += (result.empty() ? "" : ", ") + name;
+            }
+
+            return result;
+        }
+
         /// \brief Create source code text with prefetch calls.
         static std::string make_prefetch_code(const std::vector<std::string>& to_prefetch, const std::string& indentation, const std::string& endl)
         {
@@ -794,60 +907,92 @@ namespace bobopt
             return code;
         }
 
-        /// \brief Filter inputs based on interaction with tool user.
-        prefetch::names_type prefetch::filter_names(const names_type& names, const detail::used_collector& used)
+        /// \brief Input declarations and their uses for diagnostic.
+        prefetch::uses_type prefetch::get_uses(const names_type& names, const detail::used_collector& used) const
         {
-            if (!get_optimizer().verbose())
-            {
-                return names;
-            }
-
-            names_type filtered;
-            filtered.reserve(names.size());
-
-            auto& diag = get_optimizer().get_diagnostic();
+            uses_type uses;
             for (const auto& name : names)
             {
-                CXXMethodDecl* decl = get_input(name);
-                BOBOPT_ASSERT(decl != nullptr);
+                input_uses& input = uses[name];
+                input.decl = get_input(name);
+                BOBOPT_ASSERT(input.decl != nullptr);
 
-                emit_input_declaration(decl);
-
-                auto locations = used.get_locations(name);
-                for (const auto& location : locations)
+                for (const auto& location : used.get_locations(name))
                 {
                     BOBOPT_ASSERT(location.get<CallExpr>() != nullptr);
-                    diag.emit(diag.get_message_stmt(diagnostic_message::info, location.get<CallExpr>(), "used here:"));
+                    input.locations.push_back(location.get<CallExpr>());
                 }
-                llvm::outs() << endl_;
 
-                if (init_ != nullptr)
+                if (merging_)
                 {
-                    diag.emit(diag.get_message_decl(diagnostic_message::suggestion, init_, "prefetch input in init:"));
+                    input.instantiations.push_back(get_optimizer().get_instantiation_name(box_));
                 }
-                else
+            }
+
+            return uses;
+        }
+
+        /// \brief Filter inputs based on interaction with tool user.
+        prefetch::names_type prefetch::filter_names(const insertion& site)
+        {
+            names_type filtered;
+            filtered.reserve(site.uses.size());
+
+            if (!get_optimizer().verbose() || (site.target == nullptr))
+            {
+                for (const auto& input : site.uses)
                 {
-                    diag.emit(diag.get_message_decl(diagnostic_message::suggestion, box_, "override init_impl() in box with prefetch call(s):"));
+                    filtered.emplace_back(input.first);
                 }
 
+                return filtered;
+            }
+
+            auto& diag = get_optimizer().get_diagnostic();
+            for (const auto& input : site.uses)
+            {
+                emit_input_declaration(input.second);
+
+                for (const CallExpr* location : input.second.locations)
+                {
+                    diag.emit(diag.get_message_stmt(diagnostic_message::info, location, "used here:"));
+                }
+                llvm::outs() << site.endl;
+
+                diag.emit(diag.get_message_decl(diagnostic_message::suggestion, site.target, site.suggestion));
+
                 if (get_optimizer().get_mode() == MODE_INTERACTIVE)
                 {
                     if (ask_yesno("Do you wish to prefetch this input?"))
                     {
-                        filtered.emplace_back(name);
+                        filtered.emplace_back(input.first);
                     }
-                    llvm::outs() << endl_ << endl_;
+                    llvm::outs() << site.endl << site.endl;
                 }
             }
 
             return filtered;
         }
 
+        /// \brief Uses of inputs to prefetch.
+        prefetch::uses_type prefetch::select_uses(const uses_type& uses, const names_type& names)
+        {
+            uses_type result;
+            for (const auto& name : names)
+            {
+                auto found = uses.find(name);
+                BOBOPT_ASSERT(found != uses.end());
+                result.insert(*found);
+            }
+
+            return result;
+        }
+
         /// \brief Insert prefetch calls to overriden \c init_impl() member function.
         ///
         /// \param to_prefetch Names of inputs to be prefetched.
-        /// \param should_prefetch Holder of source locations for reasoning why inputs should be prefetched.
-        void prefetch::insert_into_body(const names_type& to_prefetch, const detail::used_collector& used)
+        /// \param uses Uses of inputs for reasoning why inputs should be prefetched.
+        void prefetch::insert_into_body(const names_type& to_prefetch, const uses_type& uses)
         {
             BOBOPT_ASSERT(init_ != nullptr);
             BOBOPT_ASSERT(init_->hasBody());
@@ -855,79 +1000,66 @@ namespace bobopt
             CompoundStmt* body = llvm::dyn_cast_or_null<CompoundStmt>(init_->getBody());
             BOBOPT_ASSERT(body != nullptr);
 
-            if (get_optimizer().verbose())
-            {
-                emit_header();
-                emit_box_declaration();
-            }
-
-            const auto filtered = filter_names(to_prefetch, used);
-            if (filtered.empty())
-            {
-                return;
-            }
-
-            std::string body_indent;
+            insertion site;
             SourceManager& sm = get_optimizer().get_compiler().getSourceManager();
-            endl_ = detect_line_end(sm, box_);
+            site.endl = get_context().get_line_end();
             if (body->body_empty())
             {
-                body_indent = decl_indent(sm, init_) + detect_line_indent(sm, box_);
+                site.indent = decl_indent(sm, init_) + get_context().get_line_indent();
             }
             else
             {
-                body_indent = stmt_indent(sm, body->body_back());
+                site.indent = stmt_indent(sm, body->body_back());
             }
 
-            std::string code = endl_;
-            code += make_prefetch_code(filtered, body_indent, endl_);
-            const SourceLocation location = Lexer::getLocForEndOfToken(body->getLBracLoc(), 0, sm, get_optimizer().get_compiler().getLangOpts());
-            replacements_->insert(Replacement(sm, location, 0, code));
+            site.location = Lexer::getLocForEndOfToken(body->getLBracLoc(), 0, sm, get_optimizer().get_compiler().getLangOpts());
+            site.subject = "init_impl";
+            site.aspect = "prefetched inputs";
+            site.prolog = site.endl;
+            site.target = init_;
+            site.suggestion = "prefetch input in init:";
+            site.uses = select_uses(uses, to_prefetch);
+            add_insertion(std::move(site));
         }
 
         /// \brief Create overriden \c init_impl() implementation, calling base and prefetching input.
-        void prefetch::insert_init_impl(const names_type& to_prefetch, const detail::used_collector& used)
+        void prefetch::insert_init_impl(const names_type& to_prefetch, const uses_type& uses)
         {
             BOBOPT_ASSERT(init_ == nullptr);
 
-            if (get_optimizer().verbose())
-            {
-                emit_header();
-                emit_box_declaration();
-            }
-
-            const auto filtered = filter_names(to_prefetch, used);
-            if (filtered.empty())
-            {
-                return;
-            }
-
             static const std::string declaration = "virtual void init_impl()";
 
             auto& sm = get_optimizer().get_compiler().getSourceManager();
-            decl_indent_ = detect_method_decl_indent(sm, box_);
-            line_indent_ = detect_line_indent(sm, box_);
-            endl_ = detect_line_end(sm, box_);
+            decl_indent_ = get_context().get_method_indent();
+            line_indent_ = get_context().get_line_indent();
+            endl_ = get_context().get_line_end();
 
             const std::string box_indent = decl_indent(sm, box_);
-            const std::string body_indent = decl_indent_ + line_indent_;
 
-            auto implementation = box_indent + "protected:" + endl_ + decl_indent_ + declaration + endl_ + decl_indent_ + '{' + endl_;
-            implementation += make_prefetch_code(filtered, body_indent, endl_);
+            insertion site;
+            site.location = box_->getRBraceLoc();
+            site.subject = "init_impl";
+            site.aspect = "prefetched inputs";
+            site.prolog = box_indent + "protected:" + endl_ + decl_indent_ + declaration + endl_ + decl_indent_ + '{' + endl_;
+            site.indent = decl_indent_ + line_indent_;
+            site.endl = endl_;
 
             BOBOPT_ASSERT(base_init_ != nullptr);
             if (base_init_->getParent() != get_optimizer().get_bobox_box())
             {
-                implementation += body_indent + base_init_->getParent()->getQualifiedNameAsString() + "::init_impl();" + endl_;
+                site.epilog = site.indent + base_init_->getParent()->getQualifiedNameAsString() + "::init_impl();" + endl_;
             }
 
-            implementation += decl_indent_ + "}" + endl_;
-            replacements_->insert(Replacement(sm, box_->getRBraceLoc(), 0, implementation));
+            site.epilog += decl_indent_ + "}" + endl_;
+            site.target = box_;
+            site.suggestion = "override init_impl() in box with prefetch call(s):";
+            site.uses = select_uses(uses, to_prefetch);
+            add_insertion(std::move(site));
         }
 
         /// \brief In case of stateless boxes, objects are reused but init_impl is not called
         /// Thus, it is efficient to prefetch inputs at the end of body calls.
-        void prefetch::attach_to_body(const names_type& to_prefetch, CompoundStmt* body)
+        void prefetch::attach_to_body(const names_type& to_prefetch, const uses_type& uses, CXXMethodDecl* method, CompoundStmt* body)
         {
             if (to_prefetch.empty())
             {
@@ -939,6 +1071,11 @@ namespace bobopt
                         
             detail::prefetch_collector collector(&get_optimizer().get_compiler().getASTContext());
             collector.TraverseStmt(body);
+            if (collector.get_exceeded_limit() != analysis_budget::LIMIT_NONE)
+            {
+                report_budget_exceeded(box_, "prefetch", get_budget_limit_name(collector.get_exceeded_limit()), "skipping prefetch after execution");
+                return;
+            }
             names_type used = collector.get_values();
 
             names_type result;
@@ -957,14 +1094,143 @@ namespace bobopt
             }
 
             SourceManager& sm = get_optimizer().get_compiler().getSourceManager();
-            endl_ = detect_line_end(sm, box_);
-            const std::string body_indent = stmt_indent(sm, body->body_back());
-            const std::string rbrac_indent = location_indent(sm, body->getRBracLoc());
-
-            std::string code = endl_;
-            code += make_prefetch_code(result, body_indent, endl_);
-            code += rbrac_indent;
-            replacements_->insert(Replacement(sm, body->getRBracLoc(), 0, code));
+
+            insertion site;
+            site.location = body->getRBracLoc();
+            site.subject = method->getNameAsString();
+            site.aspect = "prefetched after execution";
+            site.endl = get_context().get_line_end();
+            site.prolog = site.endl;
+            site.indent = stmt_indent(sm, body->body_back());
+            site.epilog = location_indent(sm, body->getRBracLoc());
+            site.target = nullptr;
+            site.uses = select_uses(uses, result);
+            add_insertion(std::move(site));
+        }
+
+        /// \brief Insert prefetch calls, calls of instantiations at the same location are merged.
+        void prefetch::add_insertion(insertion site)
+        {
+            if (!merging_)
+            {
+                apply_insertion(site);
+                return;
+            }
+
+            auto found = std::find_if(insertions_.begin(), insertions_.end(), [&](const insertion& merged) {
+                return merged.location == site.location;
+            });
+
+            if (found == insertions_.end())
+            {
+                insertions_.push_back(std::move(site));
+                return;
+            }
+
+            for (auto& input : site.uses)
+            {
+                auto inserted = found->uses.insert(input);
+                if (inserted.second)
+                {
+                    continue;
+                }
+
+                // Instantiations share locations of template source.
+                input_uses& merged = inserted.first->second;
+                for (const CallExpr* location : input.second.locations)
+                {
+                    auto same = std::find_if(merged.locations.begin(), merged.locations.end(), [&](const CallExpr* merged_location) {
+                        return merged_location->getLocStart() == location->getLocStart();
+                    });
+
+                    if (same == merged.locations.end())
+                    {
+                        merged.locations.push_back(location);
+                    }
+                }
+
+                merged.instantiations.insert(merged.instantiations.end(), input.second.instantiations.begin(), input.second.instantiations.end());
+            }
+        }
+
+        /// \brief Let user confirm inputs of insertion.
+        prefetch::names_type prefetch::confirm_names(const insertion& site)
+        {
+            if (get_optimizer().verbose() && (site.target != nullptr))
+            {
+                emit_header();
+                emit_box_declaration();
+            }
+
+            return filter_names(site);
+        }
+
+        /// \brief Merge insertion of current translation unit with insertions of previous ones.
+        ///
+        /// User is asked only about inputs previous translation units didn't decide.
+        void prefetch::merge_insertion(insertion site)
+        {
+            SourceManager& sm = get_optimizer().get_compiler().getSourceManager();
+            const Replacement position(sm, site.location, 0, "");
+
+            llvm::SmallString<256> file(position.getFilePath());
+            llvm::sys::fs::make_absolute(file);
+
+            std::vector<merged_insertion>& merged = merged_[merge_key_];
+            auto found = std::find_if(merged.begin(), merged.end(), [&](const merged_insertion& previous) {
+                return (previous.file == file.str()) && (previous.offset == position.getOffset());
+            });
+
+            if (found == merged.end())
+            {
+                merged_insertion inserted;
+                inserted.file = file.str();
+                inserted.offset = position.getOffset();
+                inserted.subject = site.subject;
+                inserted.aspect = site.aspect;
+                inserted.prolog = site.prolog;
+                inserted.epilog = site.epilog;
+                inserted.indent = site.indent;
+                inserted.endl = site.endl;
+                merged.push_back(std::move(inserted));
+                found = merged.end() - 1;
+            }
+
+            for (auto input = site.uses.begin(); input != site.uses.end();)
+            {
+                if (found->decided.count(input->first) != 0)
+                {
+                    input = site.uses.erase(input);
+                    continue;
+                }
+
+                found->decided.insert(input->first);
+                ++input;
+            }
+
+            if (site.uses.empty())
+            {
+                return;
+            }
+
+            const auto filtered = confirm_names(site);
+            found->prefetched.insert(filtered.begin(), filtered.end());
+        }
+
+        /// \brief Let user confirm inputs of insertion, record decision and insert prefetch calls.
+        void prefetch::apply_insertion(const insertion& site)
+        {
+            const auto filtered = confirm_names(site);
+            if (filtered.empty())
+            {
+                return;
+            }
+
+            get_optimizer().record_decision(site.subject, site.aspect, join_names(filtered));
+
+            SourceManager& sm = get_optimizer().get_compiler().getSourceManager();
+            const std::string code = site.prolog + make_prefetch_code(filtered, site.indent, site.endl) + site.epilog;
+            replacements_->insert(Replacement(sm, site.location, 0, code));
         }
 
         /// \brief Access input member function declaration to access input by name.
@@ -1009,12 +1275,18 @@ namespace bobopt
             llvm::outs() << '\n';
         }
 
-        /// \brief Emit info about input declaration.
-        void prefetch::emit_input_declaration(CXXMethodDecl* decl) const
+        /// \brief Emit info about input declaration and instantiations of box template using it.
+        void prefetch::emit_input_declaration(const input_uses& input) const
         {
             const diagnostic& diag = basic_method::get_optimizer().get_diagnostic();
 
-            diagnostic_message input_message = diag.get_message_decl(diagnostic_message::info, decl, "missing prefetch for input declared here:");
+            std::string message = "missing prefetch for input declared here";
+            if (!input.instantiations.empty())
+            {
+                message += ", used by instantiation " + join_names(input.instantiations);
+            }
+
+            diagnostic_message input_message = diag.get_message_decl(diagnostic_message::info, input.decl, message + ":");
             diag.emit(input_message);
         }
 
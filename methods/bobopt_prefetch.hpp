@@ -43,18 +43,23 @@
 #include <bobopt_method.hpp>
 
 #include <clang/bobopt_clang_prolog.hpp>
+#include "clang/Basic/SourceLocation.h"
 #include "clang/Tooling/Refactoring.h"
 #include <clang/bobopt_clang_epilog.hpp>
 
+#include <map>
+#include <set>
 #include <string>
 #include <vector>
 
 // forward declarations:
 namespace clang
 {
+    class CallExpr;
     class CompoundStmt;
     class CXXRecordDecl;
     class CXXMethodDecl;
+    class NamedDecl;
 }
 
 namespace bobopt
@@ -95,6 +100,11 @@ namespace bobopt
         /// Method doesn't optimize \b single input if:
         /// - (single.1) There is already the prefetch call for an input.
         /// - (single.2) The optimizer cannot detect whether data from an input is likely to be necessary.
+        ///
+        /// Instantiations of box template insert prefetch calls at the same locations of
+        /// template source, inputs of all instantiations are merged and each call is inserted
+        /// once. Merged calls are kept for the whole run, translation unit with new
+        /// instantiations adds their inputs.
         class prefetch : public basic_method
         {
         public:
@@ -106,12 +116,65 @@ namespace bobopt
             // optimization:
             virtual void optimize(clang::CXXRecordDecl* box, clang::tooling::Replacements* replacements);
 
+            // merge of instantiations:
+            virtual merge_policies get_merge_policy() const BOBOPT_OVERRIDE;
+            virtual void begin_merge(const std::string& key) BOBOPT_OVERRIDE;
+            virtual void end_merge(clang::CXXRecordDecl* box, clang::tooling::Replacements* replacements) BOBOPT_OVERRIDE;
+
         private:
             BOBOPT_NONCOPYMOVABLE(prefetch);
 
             // typedefs:
             typedef std::vector<std::string> names_type;
-            
+
+            /// \brief Input to be prefetched and reasons to prefetch it.
+            struct input_uses
+            {
+                clang::CXXMethodDecl* decl;
+                std::vector<const clang::CallExpr*> locations;
+                /// \brief Instantiations of box template which use input.
+                names_type instantiations;
+            };
+
+            /// \brief Uses of inputs indexed by input name.
+            typedef std::map<std::string, input_uses> uses_type;
+
+            /// \brief Prefetch calls inserted at single location.
+            struct insertion
+            {
+                clang::SourceLocation location;
+                /// \brief Subject and aspect of recorded decision.
+                std::string subject;
+                std::string aspect;
+                /// \brief Code around prefetch calls.
+                std::string prolog;
+                std::string epilog;
+                std::string indent;
+                std::string endl;
+                /// \brief Declaration user is suggested to change, inputs aren't confirmed by user without it.
+                clang::NamedDecl* target;
+                std::string suggestion;
+                uses_type uses;
+            };
+
+            /// \brief Prefetch calls of box template merged from instantiations of all translation units.
+            struct merged_insertion
+            {
+                /// \brief Absolute path and offset of location.
+                std::string file;
+                unsigned offset;
+                std::string subject;
+                std::string aspect;
+                std::string prolog;
+                std::string epilog;
+                std::string indent;
+                std::string endl;
+                /// \brief Inputs to prefetch.
+                std::set<std::string> prefetched;
+                /// \brief Inputs already confirmed or declined by user.
+                std::set<std::string> decided;
+            };
+
             // helpers:
             void prepare();
 
@@ -122,16 +185,23 @@ namespace bobopt
             void analyze_sync(detail::used_collector& used) const;
             void analyze_body(detail::used_collector& used) const;
 
-            names_type filter_names(const names_type& names, const detail::used_collector& used);
-            void insert_into_body(const names_type& to_prefetch, const detail::used_collector& used);
-            void insert_init_impl(const names_type& to_prefetch, const detail::used_collector& used);
-            void attach_to_body(const names_type& to_prefetch, clang::CompoundStmt* body);
+            uses_type get_uses(const names_type& names, const detail::used_collector& used) const;
+            static uses_type select_uses(const uses_type& uses, const names_type& names);
+            names_type filter_names(const insertion& site);
+            void insert_into_body(const names_type& to_prefetch, const uses_type& uses);
+            void insert_init_impl(const names_type& to_prefetch, const uses_type& uses);
+            void attach_to_body(const names_type& to_prefetch, const uses_type& uses, clang::CXXMethodDecl* method, clang::CompoundStmt* body);
+
+            void add_insertion(insertion site);
+            void apply_insertion(const insertion& site);
+            void merge_insertion(insertion site);
+            names_type confirm_names(const insertion& site);
 
             clang::CXXMethodDecl* get_input(const std::string& name) const;
 
             void emit_header() const;
             void emit_box_declaration() const;
-            void emit_input_declaration(clang::CXXMethodDecl* decl) const;
+            void emit_input_declaration(const input_uses& input) const;
 
             // data members:
             clang::CXXRecordDecl* box_;
@@ -147,6 +217,14 @@ namespace bobopt
             std::string line_indent_;
             std::string endl_;
 
+            /// \brief Whether instantiations of box template are merged.
+            bool merging_;
+            /// \brief Insertions merged from instantiations in current translation unit.
+            std::vector<insertion> insertions_;
+            /// \brief Insertions of box templates merged in the whole run, indexed by merge key.
+            std::map<std::string, std::vector<merged_insertion> > merged_;
+            std::string merge_key_;
+
             // constants:
             static const std::string BOX_INIT_FUNCTION_NAME;
             static const std::string BOX_INIT_OVERRIDEN_PARENT_NAME;
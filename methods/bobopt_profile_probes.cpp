@@ -0,0 +1,228 @@
+#include <methods/bobopt_profile_probes.hpp>
+
+#include <bobopt_analysis_context.hpp>
+#include <bobopt_debug.hpp>
+#include <bobopt_macros.hpp>
+#include <bobopt_optimizer.hpp>
+#include <bobopt_statistics.hpp>
+#include <bobopt_text_utils.hpp>
+#include <bobopt_time_report.hpp>
+#include <clang/bobopt_clang_utils.hpp>
+
+#include <clang/bobopt_clang_prolog.hpp>
+#include "llvm/Support/Casting.h"
+#include "llvm/Support/raw_ostream.h"
+#include "clang/AST/DeclCXX.h"
+#include "clang/AST/RecursiveASTVisitor.h"
+#include "clang/AST/Stmt.h"
+#include "clang/AST/StmtCXX.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Lex/Lexer.h"
+#include <clang/bobopt_clang_epilog.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace clang;
+using namespace clang::tooling;
+
+namespace bobopt
+{
+
+    namespace methods
+    {
+
+        // Constants.
+        //======================================================================
+
+        const profile_probes::method_override profile_probes::BOX_EXEC_METHOD_OVERRIDES[] = { { { "sync_mach_etwas" }, { "bobox::basic_box" } },
+                                                                                              { { "async_mach_etwas" }, { "bobox::basic_box" } },
+                                                                                              { { "body_mach_etwas" }, { "bobox::basic_box" } },
+                                                                                              { { "push_envelope_impl" }, { "bobox::box" } },
+                                                                                              { { "sync_body" }, { "bobox::basic_box" } } };
+
+        /// \brief Has to match bobopt::profile::MAX_LOOPS of runtime.
+        const unsigned profile_probes::MAX_LOOPS = 16u;
+
+        // TU helpers.
+        //======================================================================
+
+        namespace
+        {
+
+            /// \brief Collector of loop bodies in order of their appearance.
+            class loop_bodies_collector : public RecursiveASTVisitor<loop_bodies_collector>
+            {
+            public:
+                bool VisitForStmt(ForStmt* for_stmt)
+                {
+                    add(for_stmt->getBody());
+                    return true;
+                }
+
+                bool VisitCXXForRangeStmt(CXXForRangeStmt* range_stmt)
+                {
+                    add(range_stmt->getBody());
+                    return true;
+                }
+
+                bool VisitWhileStmt(WhileStmt* while_stmt)
+                {
+                    add(while_stmt->getBody());
+                    return true;
+                }
+
+                bool VisitDoStmt(DoStmt* do_stmt)
+                {
+                    add(do_stmt->getBody());
+                    return true;
+                }
+
+                /// \brief Lambda bodies don't see scope probe of member function.
+                bool TraverseLambdaExpr(LambdaExpr*)
+                {
+                    return true;
+                }
+
+                /// \brief Only loops with compound body written directly in code are instrumented.
+                std::vector<CompoundStmt*> bodies;
+
+            private:
+                void add(Stmt* body)
+                {
+                    CompoundStmt* compound_stmt = llvm::dyn_cast_or_null<CompoundStmt>(body);
+                    if ((compound_stmt != nullptr) && !compound_stmt->getLBracLoc().isMacroID())
+                    {
+                        bodies.push_back(compound_stmt);
+                    }
+                }
+            };
+
+            /// \brief Indent of the first line in compound statement.
+            std::string body_indent(SourceManager& sm, box_context& context, const CompoundStmt* body)
+            {
+                if (body->body_empty())
+                {
+                    return location_indent(sm, body->getLBracLoc()) + context.get_line_indent();
+                }
+
+                return stmt_indent(sm, body->body_front());
+            }
+
+        } // namespace
+
+        // Method.
+        //======================================================================
+
+        /// \brief Create default constructed unusable object.
+        profile_probes::profile_probes()
+            : box_(nullptr)
+            , replacements_(nullptr)
+            , endl_()
+        {
+        }
+
+        /// \brief Deletable through pointer to base.
+        profile_probes::~profile_probes()
+        {
+        }
+
+        /// \brief Inherited optimization member function.
+        /// Instruments box only in profile mode, it does nothing otherwise.
+        void profile_probes::optimize(CXXRecordDecl* box, tooling::Replacements* replacements)
+        {
+            BOBOPT_ASSERT(box != nullptr);
+            BOBOPT_ASSERT(replacements != nullptr);
+
+            if (get_optimizer().get_mode() != MODE_PROFILE)
+            {
+                return;
+            }
+
+            scoped_timer timer("profile_probes::optimize");
+
+            box_ = box;
+            replacements_ = replacements;
+            endl_ = get_context().get_line_end();
+
+            bool instrumented = false;
+            for (auto method_it = box_->method_begin(); method_it != box_->method_end(); ++method_it)
+            {
+                CXXMethodDecl* method = *method_it;
+
+                for (const auto& exec_method : BOX_EXEC_METHOD_OVERRIDES)
+                {
+                    if ((method->getNameAsString() == exec_method.method_name) && overrides(method, exec_method.parent_name) && method->hasBody())
+                    {
+                        instrument_method(method);
+                        instrumented = true;
+                    }
+                }
+            }
+
+            if (instrumented)
+            {
+                insert_include();
+            }
+        }
+
+        /// \brief Include runtime of probes at the beginning of file with box.
+        /// Same replacement from more boxes in the file is inserted only once.
+        void profile_probes::insert_include()
+        {
+            SourceManager& sm = get_optimizer().get_compiler().getSourceManager();
+            const FileID file = sm.getFileID(sm.getExpansionLoc(box_->getLocation()));
+
+            const std::string code = "#include <bobopt_profile.hpp>" + endl_;
+            replacements_->insert(Replacement(sm, sm.getLocForStartOfFile(file), 0, code));
+        }
+
+        /// \brief Insert scope probe to the beginning of body and loop probes to the beginning of loop bodies.
+        void profile_probes::instrument_method(CXXMethodDecl* method)
+        {
+            CompoundStmt* body = llvm::dyn_cast_or_null<CompoundStmt>(method->getBody());
+            if (body == nullptr)
+            {
+                return;
+            }
+
+            SourceManager& sm = get_optimizer().get_compiler().getSourceManager();
+            const LangOptions& lang_options = get_optimizer().get_compiler().getLangOpts();
+
+            const std::string scope_code = endl_ + body_indent(sm, get_context(), body) + "BOBOPT_PROFILE_SCOPE(\"" + box_->getQualifiedNameAsString() +
+                                           "\", \"" + method->getNameAsString() + "\");";
+            const SourceLocation scope_location = Lexer::getLocForEndOfToken(sm.getExpansionLoc(body->getLBracLoc()), 0, sm, lang_options);
+            replacements_->insert(Replacement(sm, scope_location, 0, scope_code));
+
+            loop_bodies_collector collector;
+            collector.TraverseStmt(body);
+
+            unsigned index = 0;
+            for (auto* loop_body : collector.bodies)
+            {
+                if (index == MAX_LOOPS)
+                {
+                    llvm::errs() << "[WARNING] " << box_->getQualifiedNameAsString() << "::" << method->getNameAsString() << " has more than " << MAX_LOOPS
+                                 << " loops, following loops are not profiled.\n";
+                    statistics::instance().increment("profile_probes.loops_skipped");
+                    break;
+                }
+
+                std::string loop_code = endl_ + body_indent(sm, get_context(), loop_body) + "BOBOPT_PROFILE_LOOP(" + std::to_string(index) + ");";
+                const SourceLocation loop_location = Lexer::getLocForEndOfToken(loop_body->getLBracLoc(), 0, sm, lang_options);
+                replacements_->insert(Replacement(sm, loop_location, 0, loop_code));
+                ++index;
+            }
+
+            statistics::instance().increment("profile_probes.methods");
+        }
+
+    } // namespace
+
+    basic_method* create_profile_probes()
+    {
+        return new methods::profile_probes;
+    }
+
+} // namespace
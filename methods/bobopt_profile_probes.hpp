@@ -0,0 +1,93 @@
+/// \file bobopt_profile_probes.hpp File contains definition of the method
+/// that instruments boxes with profiling probes.
+///
+/// Method runs only in profile mode. It inserts probes of runtime in
+/// profile/bobopt_profile.hpp into box execution member functions:
+/// \code
+/// virtual void sync_mach_etwas() override
+/// {
+///     BOBOPT_PROFILE_SCOPE("some_box", "sync_mach_etwas");
+///     for (...)
+///     {
+///         BOBOPT_PROFILE_LOOP(0);
+///         //...
+///     }
+/// }
+/// \endcode
+/// Yields inserted by yield complex method are preceded by
+/// \c BOBOPT_PROFILE_YIELD() in profile mode.
+
+#ifndef BOBOPT_METHODS_BOBOPT_PROFILE_PROBES_HPP_GUARD_
+#define BOBOPT_METHODS_BOBOPT_PROFILE_PROBES_HPP_GUARD_
+
+#include <bobopt_language.hpp>
+#include <bobopt_macros.hpp>
+#include <bobopt_method.hpp>
+
+#include <clang/bobopt_clang_prolog.hpp>
+#include "clang/Tooling/Refactoring.h"
+#include <clang/bobopt_clang_epilog.hpp>
+
+#include <string>
+
+// forward declarations:
+namespace clang
+{
+    class CXXRecordDecl;
+    class CXXMethodDecl;
+}
+
+namespace bobopt
+{
+
+    namespace methods
+    {
+
+        /// \brief Definition of method inserting profiling probes.
+        class profile_probes : public basic_method
+        {
+        public:
+
+            // create/destroy:
+            profile_probes();
+            virtual ~profile_probes() BOBOPT_OVERRIDE;
+
+            // optimize:
+            virtual void optimize(clang::CXXRecordDecl* box, clang::tooling::Replacements* replacements) BOBOPT_OVERRIDE;
+
+        private:
+            BOBOPT_NONCOPYMOVABLE(profile_probes);
+
+            // helper structures:
+
+            /// \brief Structure that holds information about member function and name of parent it overrides.
+            struct method_override
+            {
+                std::string method_name;
+                std::string parent_name;
+            };
+
+            // helpers:
+            void insert_include();
+            void instrument_method(clang::CXXMethodDecl* method);
+
+            // data members:
+            clang::CXXRecordDecl* box_;
+            clang::tooling::Replacements* replacements_;
+
+            std::string endl_;
+
+            // constants:
+            static const method_override BOX_EXEC_METHOD_OVERRIDES[];
+            static const unsigned MAX_LOOPS;
+        };
+
+    } // namespace methods
+
+    /// \relates method_factory
+    /// \brief Function used to create profile_probes object.
+    basic_method* create_profile_probes();
+
+} // namespace bobopt
+
+#endif // guard
@@ -1,28 +1,42 @@
 #include <methods/bobopt_yield_complex.hpp>
 
+#include <bobopt_analysis_context.hpp>
+#include <bobopt_budget.hpp>
 #include <bobopt_config.hpp>
 #include <bobopt_debug.hpp>
 #include <bobopt_inline.hpp>
 #include <bobopt_macros.hpp>
 #include <bobopt_optimizer.hpp>
+#include <bobopt_statistics.hpp>
 #include <bobopt_text_utils.hpp>
+#include <bobopt_time_report.hpp>
 #include <bobopt_utils.hpp>
 #include <clang/bobopt_clang_utils.hpp>
 
 #include <clang/bobopt_clang_prolog.hpp>
 #include "clang/AST/ASTContext.h"
+#include "clang/AST/Attr.h"
 #include "clang/AST/ASTTypeTraits.h"
+#include "clang/AST/ExprCXX.h"
+#include "clang/AST/ParentMap.h"
 #include "clang/AST/RecursiveASTVisitor.h"
 #include "clang/AST/Stmt.h"
 #include "clang/Analysis/CFG.h"
+#include "clang/Basic/SourceManager.h"
 #include "clang/Frontend/CompilerInstance.h"
+#include "clang/Lex/Lexer.h"
 #include <clang/bobopt_clang_epilog.hpp>
 
 #include <algorithm>
+#include <cstdlib>
+#include <fstream>
 #include <iterator>
 #include <limits>
+#include <map>
 #include <memory>
 #include <numeric>
+#include <regex>
+#include <sstream>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -57,6 +71,9 @@ namespace bobopt
         static config_variable<unsigned> config_multiplier_for(config, "multiplier_for", 5u);
         /// \brief Multiplier for body complexity of while and do/while loops.
         static config_variable<unsigned> config_multiplier_while(config, "multiplier_while", 15u);
+        /// \brief Estimated number of elements of range processed by standard algorithm, e.g., std::for_each.
+        /// Complexity of functor passed to algorithm is multiplied by it.
+        static config_variable<unsigned> config_multiplier_algorithm(config, "multiplier_algorithm", 5u);
 
         /// \brief Optimal complexity for box execution.
         /// It is equivalent of 2 inner for loops with 2 calls to not inlined non trivial function rounded up in tens of thousands.
@@ -65,6 +82,38 @@ namespace bobopt
         /// \brief Enable insertion of yield before all function calls from predefined set of functions.
         static config_variable<bool> config_yield_predefined(config, "yield_predefined", false);
 
+        /// \brief Maximal number of paths in CFG data of single member function, zero for unlimited.
+        static config_variable<unsigned> config_max_paths(config, "max_paths", 20000u);
+        /// \brief Maximal number of yield placement iterations in single member function, zero for unlimited.
+        static config_variable<unsigned> config_max_iterations(config, "max_iterations", 64u);
+        /// \brief Maximal wall time of analysis of single member function in milliseconds, zero for unlimited.
+        static config_variable<unsigned> config_time_budget(config, "time_budget_ms", 2000u);
+        /// \brief When analysis exceeds its budget before any yield is placed, insert yield at the beginning of
+        /// outermost loop bodies. Otherwise member function is skipped.
+        static config_variable<bool> config_budget_fallback(config, "budget_fallback", true);
+
+        /// \brief Weight paths by probabilities of branches taken on them. Otherwise all paths are equally important.
+        static config_variable<bool> config_branch_weights(config, "branch_weights", true);
+        /// \brief Probability in percents of branch hinted as likely by __builtin_expect, [[likely]] or [[unlikely]].
+        /// Early return on poisoned envelope is hinted as unlikely.
+        static config_variable<unsigned> config_likely_probability(config, "likely_probability", 90u);
+        /// \brief Optional file with measured counts of branches. Each line holds "file:line taken not_taken" of
+        /// single if statement. Measured counts take precedence over hints in code.
+        static config_variable<std::string> config_branch_profile(config, "branch_profile", std::string());
+
+        /// \brief Improve greedy yield placement by bounded branch and bound search.
+        static config_variable<bool> config_search_placement(config, "search_placement", true);
+        /// \brief Maximal number of yields placed into single member function by search, zero for unlimited.
+        static config_variable<unsigned> config_max_yields(config, "max_yields", 0u);
+        /// \brief Scheduling overhead of single executed yield in complexity units.
+        static config_variable<unsigned> config_yield_overhead(config, "yield_overhead", 50u);
+        /// \brief Maximal number of placements evaluated by search, zero for unlimited.
+        static config_variable<unsigned> config_max_search_nodes(config, "max_search_nodes", 256u);
+        /// \brief Yield inside cheap loop body is executed only every K-th iteration, K is threshold divided by cost of body.
+        static config_variable<bool> config_stride_yields(config, "stride_yields", true);
+        /// \brief Maximal number of iterations between strided yields.
+        static config_variable<unsigned> config_max_stride(config, "max_stride", 1000u);
+
         // TU helpers.
         //======================================================================
 
@@ -88,6 +137,280 @@ namespace bobopt
                 return (method_decl->getNameAsString() == "yield") && (record_decl->getNameAsString() == "basic_box");
             }
 
+            method_context::block_cost get_block_cost(const CFGBlock& block);
+
+            /// \brief Analysis of member function, its budget and functor cache are shared by functors it calls.
+            ///
+            /// Block costs are computed by plain function cached in method context, so
+            /// functor analysis finds state of enclosing member function through scope.
+            class cost_scope
+            {
+            public:
+                cost_scope(analysis_budget& budget, box_context& box)
+                    : budget_(budget)
+                    , box_(box)
+                    , previous_(current_)
+                {
+                    current_ = this;
+                }
+
+                ~cost_scope()
+                {
+                    current_ = previous_;
+                }
+
+                static cost_scope* get_current()
+                {
+                    return current_;
+                }
+
+                analysis_budget& get_budget() const
+                {
+                    return budget_;
+                }
+
+                box_context::complexities_type& get_functor_complexities() const
+                {
+                    return box_.get_functor_complexities();
+                }
+
+            private:
+                BOBOPT_NONCOPYMOVABLE(cost_scope);
+
+                static cost_scope* current_;
+
+                analysis_budget& budget_;
+                box_context& box_;
+                cost_scope* previous_;
+            };
+
+            cost_scope* cost_scope::current_ = nullptr;
+
+            /// \brief Cost set by BOBOPT_COST annotation of function, see annotations/bobopt_annotations.hpp.
+            ///
+            /// All declarations are searched, so annotation in header applies to calls
+            /// of function defined in other translation unit. Member function inherits
+            /// annotation of member function it overrides.
+            bool get_annotated_cost(const FunctionDecl* function, unsigned& cost)
+            {
+                static const llvm::StringRef PREFIX("bobopt:cost:");
+
+                for (const FunctionDecl* redecl : function->redecls())
+                {
+                    for (const AnnotateAttr* attr : redecl->specific_attrs<AnnotateAttr>())
+                    {
+                        const llvm::StringRef annotation = attr->getAnnotation();
+                        if (annotation.startswith(PREFIX) && !annotation.drop_front(PREFIX.size()).getAsInteger(10, cost))
+                        {
+                            return true;
+                        }
+                    }
+                }
+
+                const CXXMethodDecl* method = llvm::dyn_cast<CXXMethodDecl>(function);
+                if (method != nullptr)
+                {
+                    for (auto it = method->begin_overridden_methods(), end = method->end_overridden_methods(); it != end; ++it)
+                    {
+                        if (get_annotated_cost(*it, cost))
+                        {
+                            return true;
+                        }
+                    }
+                }
+
+                return false;
+            }
+
+            // Iteration algorithms.
+            //==================================================================
+
+            /// \brief Standard algorithm executing functor for elements of range.
+            struct iteration_algorithm
+            {
+                /// \brief Name in namespace std.
+                const char* name;
+                /// \brief Functor is the last argument when call has at least this number of arguments.
+                unsigned functor_arguments;
+                /// \brief Index of argument with number of elements, negative when range is given by iterators.
+                int count_argument;
+                /// \brief Functor is executed n log n times, e.g., comparator of std::sort.
+                bool sorting;
+            };
+
+            /// \brief Registry of algorithms costed as loops over range.
+            const iteration_algorithm ITERATION_ALGORITHMS[] =
+            {
+                { "for_each", 3u, -1, false },
+                { "for_each_n", 3u, 1, false },
+                { "transform", 4u, -1, false },
+                { "generate", 3u, -1, false },
+                { "generate_n", 3u, 1, false },
+                { "accumulate", 4u, -1, false },
+                { "count_if", 3u, -1, false },
+                { "find_if", 3u, -1, false },
+                { "find_if_not", 3u, -1, false },
+                { "all_of", 3u, -1, false },
+                { "any_of", 3u, -1, false },
+                { "none_of", 3u, -1, false },
+                { "copy_if", 4u, -1, false },
+                { "remove_if", 3u, -1, false },
+                { "unique", 3u, -1, false },
+                { "adjacent_find", 3u, -1, false },
+                { "min_element", 3u, -1, false },
+                { "max_element", 3u, -1, false },
+                { "partition", 3u, -1, false },
+                { "stable_partition", 3u, -1, false },
+                { "sort", 3u, -1, true },
+                { "stable_sort", 3u, -1, true }
+            };
+
+            /// \brief Find callee in registry of iteration algorithms, \c nullptr if it isn't there.
+            const iteration_algorithm* find_iteration_algorithm(const FunctionDecl* callee)
+            {
+                if ((callee == nullptr) || (callee->getIdentifier() == nullptr) || !callee->isInStdNamespace())
+                {
+                    return nullptr;
+                }
+
+                const llvm::StringRef name = callee->getName();
+                for (const auto& algorithm : ITERATION_ALGORITHMS)
+                {
+                    if (name == algorithm.name)
+                    {
+                        return &algorithm;
+                    }
+                }
+
+                return nullptr;
+            }
+
+            /// \brief Function call operator of functor class.
+            const FunctionDecl* get_call_operator(const CXXRecordDecl* record)
+            {
+                if ((record == nullptr) || !record->hasDefinition())
+                {
+                    return nullptr;
+                }
+
+                if (record->isLambda())
+                {
+                    return record->getLambdaCallOperator();
+                }
+
+                for (const CXXMethodDecl* method : record->methods())
+                {
+                    if (method->getOverloadedOperator() == OO_Call)
+                    {
+                        return method;
+                    }
+                }
+
+                return nullptr;
+            }
+
+            /// \brief Function executed by functor argument, i.e., lambda, function or function object.
+            const FunctionDecl* get_functor_function(const Expr* functor)
+            {
+                const Expr* expr = functor;
+                while (expr != nullptr)
+                {
+                    expr = expr->IgnoreParenImpCasts();
+
+                    if (const MaterializeTemporaryExpr* temporary = llvm::dyn_cast<MaterializeTemporaryExpr>(expr))
+                    {
+                        expr = temporary->GetTemporaryExpr();
+                        continue;
+                    }
+
+                    if (const CXXBindTemporaryExpr* bind = llvm::dyn_cast<CXXBindTemporaryExpr>(expr))
+                    {
+                        expr = bind->getSubExpr();
+                        continue;
+                    }
+
+                    // Functor passed by value is copied or moved from temporary.
+                    const CXXConstructExpr* construct = llvm::dyn_cast<CXXConstructExpr>(expr);
+                    if ((construct != nullptr) && (construct->getNumArgs() == 1) && construct->getConstructor()->isCopyOrMoveConstructor())
+                    {
+                        expr = construct->getArg(0);
+                        continue;
+                    }
+
+                    const UnaryOperator* address = llvm::dyn_cast<UnaryOperator>(expr);
+                    if ((address != nullptr) && (address->getOpcode() == UO_AddrOf))
+                    {
+                        expr = address->getSubExpr();
+                        continue;
+                    }
+
+                    if (const LambdaExpr* lambda = llvm::dyn_cast<LambdaExpr>(expr))
+                    {
+                        return lambda->getCallOperator();
+                    }
+
+                    const DeclRefExpr* ref = llvm::dyn_cast<DeclRefExpr>(expr);
+                    if ((ref != nullptr) && llvm::isa<FunctionDecl>(ref->getDecl()))
+                    {
+                        return llvm::cast<FunctionDecl>(ref->getDecl());
+                    }
+
+                    return get_call_operator(expr->getType()->getAsCXXRecordDecl());
+                }
+
+                return nullptr;
+            }
+
+            unsigned get_functor_complexity(const FunctionDecl* function);
+
+            /// \brief Estimated number of functor executions by iteration algorithm.
+            unsigned long long get_algorithm_executions(const iteration_algorithm& algorithm, const CallExpr* call_expr)
+            {
+                unsigned long long result = config_multiplier_algorithm.get();
+
+                if ((algorithm.count_argument >= 0) && (static_cast<unsigned>(algorithm.count_argument) < call_expr->getNumArgs()))
+                {
+                    const Expr* count = call_expr->getArg(static_cast<unsigned>(algorithm.count_argument));
+
+                    llvm::APSInt value;
+                    if (!count->isValueDependent() && count->EvaluateAsInt(value, call_expr->getDirectCallee()->getASTContext()) && value.isStrictlyPositive())
+                    {
+                        result = value.getLimitedValue(std::numeric_limits<unsigned>::max());
+                    }
+                }
+
+                if (algorithm.sorting)
+                {
+                    unsigned long long log = 1ull;
+                    while ((log < 64ull) && ((1ull << log) < result))
+                    {
+                        ++log;
+                    }
+
+                    result *= log;
+                }
+
+                return std::min<unsigned long long>(result, std::numeric_limits<unsigned>::max());
+            }
+
+            /// \brief Complexity of iteration algorithm, functor complexity multiplied by range size estimate.
+            unsigned get_algorithm_complexity(const iteration_algorithm& algorithm, const CallExpr* call_expr)
+            {
+                // Every element costs at least iteration itself.
+                unsigned long long functor = 1ull;
+                const unsigned args = call_expr->getNumArgs();
+                if (args >= algorithm.functor_arguments)
+                {
+                    functor += get_functor_complexity(get_functor_function(call_expr->getArg(args - 1)));
+                }
+
+                const unsigned long long result = get_algorithm_executions(algorithm, call_expr) * functor;
+                return static_cast<unsigned>(std::min<unsigned long long>(result, std::numeric_limits<unsigned>::max()));
+            }
+
+            // Complexity.
+            //==================================================================
+
             /// \brief Function returns complexity of call expression.
             unsigned get_call_complexity(const CallExpr* call_expr)
             {
@@ -95,49 +418,403 @@ namespace bobopt
 
                 const FunctionDecl* callee = call_expr->getDirectCallee();
 
+                // Cost known by user takes precedence over estimates.
+                unsigned cost = 0u;
+                if ((callee != nullptr) && get_annotated_cost(callee, cost))
+                {
+                    return cost;
+                }
+
+                if (const iteration_algorithm* algorithm = find_iteration_algorithm(callee))
+                {
+                    return get_algorithm_complexity(*algorithm, call_expr);
+                }
+
                 if (callee->hasTrivialBody())
                 {
                     return config_call_trivial_complexity.get();
                 }
 
-                if (callee->isConstexpr())
+                if (callee->isConstexpr())
+                {
+                    return config_call_constexpr_complexity.get();
+                }
+
+                if (callee->isInlined())
+                {
+                    return config_call_inline_complexity.get();
+                }
+
+                return config_call_default_complexity.get();
+            }
+
+            /// \brief Collector of calls executed by statement itself.
+            class element_calls_collector : public RecursiveASTVisitor<element_calls_collector>
+            {
+            public:
+                bool VisitCallExpr(CallExpr* call_expr)
+                {
+                    calls.push_back(call_expr);
+                    return true;
+                }
+
+                /// \brief Lambda body is costed as functor of algorithm it is passed to.
+                bool TraverseLambdaExpr(LambdaExpr*)
+                {
+                    return true;
+                }
+
+                std::vector<const CallExpr*> calls;
+            };
+
+            /// \brief Function returns complexity of single CFG element.
+            unsigned get_element_complexity(const CFGElement& element)
+            {
+                if (element.getKind() != CFGElement::Kind::Statement)
+                {
+                    return 1u;
+                }
+
+                const Stmt* stmt = element.castAs<CFGStmt>().getStmt();
+                BOBOPT_ASSERT(stmt != nullptr);
+
+                element_calls_collector collector;
+                collector.TraverseStmt(const_cast<Stmt*>(stmt));
+
+                unsigned result = 1u;
+                for (const CallExpr* call_expr : collector.calls)
+                {
+                    if (is_yield_call(call_expr))
+                    {
+                        return 0u;
+                    }
+
+                    result += get_call_complexity(call_expr);
+                }
+
+                return result;
+            }
+
+            /// \brief Function returns complexity of CFG block, computed once per block by method context.
+            method_context::block_cost get_block_cost(const CFGBlock& block)
+            {
+                method_context::block_cost result;
+                result.complexity = 0u;
+                result.yield = false;
+
+                for (const CFGElement& element : block)
+                {
+                    auto element_complexity = get_element_complexity(element);
+
+                    // There was call to Bobox yield() in element.
+                    // I consider this blocks complexity equal to zero.
+                    if (element_complexity == 0u)
+                    {
+                        result.complexity = 0u;
+                        result.yield = true;
+                        break;
+                    }
+
+                    result.complexity += element_complexity;
+                }
+
+                return result;
+            }
+
+            // Branch probabilities.
+            //==================================================================
+
+            /// \brief Probabilities of successors of CFG blocks indexed by block id.
+            typedef std::unordered_map<unsigned, std::vector<double> > probabilities_type;
+
+            /// \brief Measured counts of branches loaded from \c branch_profile file.
+            class branch_profile
+            {
+            public:
+                /// \brief Counts of single if statement.
+                struct counts_type
+                {
+                    unsigned long long taken;
+                    unsigned long long not_taken;
+                };
+
+                /// \brief Access profile loaded from file in configuration.
+                static const branch_profile& instance()
+                {
+                    static branch_profile profile;
+                    if (profile.file_name_ != config_branch_profile.get())
+                    {
+                        profile.load(config_branch_profile.get());
+                    }
+                    return profile;
+                }
+
+                /// \brief Find counts of if statement on line in file. File name
+                /// in profile may be relative, it is matched as suffix.
+                bool find(const std::string& file_name, unsigned line, counts_type& counts) const
+                {
+                    auto range = branches_.equal_range(line);
+                    for (auto it = range.first; it != range.second; ++it)
+                    {
+                        const std::string& suffix = it->second.first;
+                        if ((suffix.size() <= file_name.size()) && (file_name.compare(file_name.size() - suffix.size(), suffix.size(), suffix) == 0))
+                        {
+                            counts = it->second.second;
+                            return true;
+                        }
+                    }
+
+                    return false;
+                }
+
+            private:
+                typedef std::multimap<unsigned, std::pair<std::string, counts_type> > branches_type;
+
+                branch_profile()
+                    : file_name_()
+                    , branches_()
+                {
+                }
+
+                void load(const std::string& file_name)
+                {
+                    file_name_ = file_name;
+                    branches_.clear();
+
+                    if (file_name.empty())
+                    {
+                        return;
+                    }
+
+                    std::ifstream file(file_name);
+                    if (!file)
+                    {
+                        llvm::errs() << "[ERROR] Failed to open branch profile: " << file_name << "\n";
+                        return;
+                    }
+
+                    std::string line;
+                    while (std::getline(file, line))
+                    {
+                        if (line.empty() || (line[0] == '#'))
+                        {
+                            continue;
+                        }
+
+                        std::istringstream stream(line);
+                        std::string location;
+                        counts_type counts;
+                        if (!(stream >> location >> counts.taken >> counts.not_taken))
+                        {
+                            llvm::errs() << "[ERROR] Invalid line in branch profile: " << line << "\n";
+                            continue;
+                        }
+
+                        const auto separator = location.rfind(':');
+                        if ((separator == std::string::npos) || (separator + 1 == location.size()))
+                        {
+                            llvm::errs() << "[ERROR] Invalid location in branch profile: " << location << "\n";
+                            continue;
+                        }
+
+                        const auto line_number = static_cast<unsigned>(std::strtoul(location.c_str() + separator + 1, nullptr, 10));
+                        branches_.insert(std::make_pair(line_number, std::make_pair(location.substr(0, separator), counts)));
+                    }
+                }
+
+                std::string file_name_;
+                branches_type branches_;
+            };
+
+            /// \brief Function detects \c __builtin_expect(expr, value) as condition
+            /// and returns expected value of condition.
+            bool get_expected_condition(const Expr* cond, const ASTContext& context, bool& expected)
+            {
+                const CallExpr* call_expr = llvm::dyn_cast<CallExpr>(cond->IgnoreParenImpCasts());
+                if ((call_expr == nullptr) || (call_expr->getNumArgs() != 2))
+                {
+                    return false;
+                }
+
+                const FunctionDecl* callee = call_expr->getDirectCallee();
+                if ((callee == nullptr) || (callee->getNameAsString() != "__builtin_expect"))
+                {
+                    return false;
+                }
+
+                llvm::APSInt value;
+                if (!call_expr->getArg(1)->EvaluateAsInt(value, context))
+                {
+                    return false;
+                }
+
+                expected = value.getBoolValue();
+                return true;
+            }
+
+            /// \brief Function looks up \c [[likely]] or \c [[unlikely]] attribute
+            /// in source code between two locations.
+            ///
+            /// Attributes are not part of AST for C++ standards before C++20,
+            /// therefore they are looked up in source text.
+            ///
+            /// \return 1 for likely, -1 for unlikely and 0 when there's no attribute.
+            int get_likelihood_attribute(const ASTContext& context, SourceLocation after, const Stmt* stmt)
+            {
+                static const std::regex REGEX_ATTRIBUTE(R"(\[\[\s*(un)?likely\s*\]\])");
+
+                const AttributedStmt* attributed_stmt = llvm::dyn_cast<AttributedStmt>(stmt);
+                if (attributed_stmt != nullptr)
+                {
+                    stmt = attributed_stmt->getSubStmt();
+                }
+
+                const SourceLocation before = stmt->getLocStart();
+                if (after.isInvalid() || before.isInvalid() || after.isMacroID() || before.isMacroID())
+                {
+                    return 0;
+                }
+
+                const SourceManager& sm = context.getSourceManager();
+                const SourceLocation begin = Lexer::getLocForEndOfToken(after, 0, sm, context.getLangOpts());
+                if (begin.isInvalid() || !sm.isBeforeInTranslationUnit(begin, before))
+                {
+                    return 0;
+                }
+
+                bool invalid = false;
+                const std::string text = Lexer::getSourceText(CharSourceRange::getCharRange(begin, before), sm, context.getLangOpts(), &invalid).str();
+                std::smatch match;
+                if (invalid || !std::regex_search(text, match, REGEX_ATTRIBUTE))
+                {
+                    return 0;
+                }
+
+                return match[1].matched ? -1 : 1;
+            }
+
+            /// \brief Function detects \c if (envelope->is_poisoned()) { ... return; } pattern.
+            bool is_poisoned_return(const IfStmt* if_stmt)
+            {
+                if ((if_stmt->getElse() != nullptr) || (if_stmt->getThen() == nullptr))
+                {
+                    return false;
+                }
+
+                nodes_collector<CXXMemberCallExpr> calls_collector;
+                calls_collector.TraverseStmt(const_cast<Expr*>(if_stmt->getCond()));
+
+                bool poisoned = false;
+                for (auto it = calls_collector.nodes_begin(), end = calls_collector.nodes_end(); it != end; ++it)
+                {
+                    const CXXMethodDecl* method_decl = (*it)->getMethodDecl();
+                    if ((method_decl != nullptr) && (method_decl->getNameAsString() == "is_poisoned"))
+                    {
+                        poisoned = true;
+                        break;
+                    }
+                }
+
+                if (!poisoned)
+                {
+                    return false;
+                }
+
+                nodes_collector<ReturnStmt> returns_collector;
+                returns_collector.TraverseStmt(const_cast<Stmt*>(if_stmt->getThen()));
+                return (returns_collector.nodes_begin() != returns_collector.nodes_end());
+            }
+
+            /// \brief Function returns probability of then branch of if statement
+            /// or negative value when it's unknown.
+            double get_then_probability(const IfStmt* if_stmt, const ASTContext& context)
+            {
+                const double likely = std::min(config_likely_probability.get(), 100u) / 100.0;
+
+                // Measured counts.
+                if (!config_branch_profile.get().empty())
+                {
+                    const SourceManager& sm = context.getSourceManager();
+                    const PresumedLoc location = sm.getPresumedLoc(sm.getExpansionLoc(if_stmt->getLocStart()));
+
+                    branch_profile::counts_type counts;
+                    if (location.isValid() && branch_profile::instance().find(location.getFilename(), location.getLine(), counts))
+                    {
+                        const auto total = counts.taken + counts.not_taken;
+                        if (total != 0)
+                        {
+                            return static_cast<double>(counts.taken) / total;
+                        }
+                    }
+                }
+
+                // __builtin_expect(), usually hidden in likely() and unlikely() macros.
+                bool expected = false;
+                if (get_expected_condition(if_stmt->getCond(), context, expected))
+                {
+                    return expected ? likely : (1.0 - likely);
+                }
+
+                // [[likely]] and [[unlikely]] attributes.
+                int likelihood = get_likelihood_attribute(context, if_stmt->getCond()->getLocEnd(), if_stmt->getThen());
+                if (likelihood != 0)
+                {
+                    return (likelihood > 0) ? likely : (1.0 - likely);
+                }
+
+                if (if_stmt->getElse() != nullptr)
                 {
-                    return config_call_constexpr_complexity.get();
+                    likelihood = get_likelihood_attribute(context, if_stmt->getElseLoc(), if_stmt->getElse());
+                    if (likelihood != 0)
+                    {
+                        return (likelihood > 0) ? (1.0 - likely) : likely;
+                    }
                 }
 
-                if (callee->isInlined())
+                // End of stream is handled only once.
+                if (is_poisoned_return(if_stmt))
                 {
-                    return config_call_inline_complexity.get();
+                    return 1.0 - likely;
                 }
 
-                return config_call_default_complexity.get();
+                return -1.0;
             }
 
-            /// \brief Function returns complexity of single CFG element.
-            unsigned get_element_complexity(const CFGElement& element)
+            /// \brief Function collects known probabilities of if statement
+            /// branches in CFG. The first successor is then branch.
+            probabilities_type get_branch_probabilities(const CFG& cfg, const ASTContext& context)
             {
-                if (element.getKind() != CFGElement::Kind::Statement)
+                probabilities_type result;
+                if (!config_branch_weights.get())
                 {
-                    return 1u;
+                    return result;
                 }
 
-                const Stmt* stmt = element.castAs<CFGStmt>().getStmt();
-                BOBOPT_ASSERT(stmt != nullptr);
-
-                nodes_collector<CallExpr> collector;
-                collector.TraverseStmt(const_cast<Stmt*>(stmt));
-
-                unsigned result = 1u;
-                for (auto it = collector.nodes_begin(), end = collector.nodes_end(); it != end; ++it)
+                for (auto it = cfg.begin(), end = cfg.end(); it != end; ++it)
                 {
-                    const CallExpr* call_expr = *it;
+                    const CFGBlock* block = *it;
+                    if ((block == nullptr) || (block->succ_size() != 2))
+                    {
+                        continue;
+                    }
 
-                    if (is_yield_call(call_expr))
+                    CFGTerminator terminator = block->getTerminator();
+                    if (!terminator)
                     {
-                        return 0u;
+                        continue;
                     }
 
-                    result += get_call_complexity(call_expr);
+                    const IfStmt* if_stmt = llvm::dyn_cast<IfStmt>(terminator.getStmt());
+                    if (if_stmt == nullptr)
+                    {
+                        continue;
+                    }
+
+                    const double then_probability = get_then_probability(if_stmt, context);
+                    if (then_probability >= 0.0)
+                    {
+                        result[block->getBlockID()] = std::vector<double>{ then_probability, 1.0 - then_probability };
+                    }
                 }
 
                 return result;
@@ -177,10 +854,25 @@ namespace bobopt
                 yield_state yield;
                 std::vector<path_data_type> paths;
                 std::unordered_map<unsigned, unsigned> loops;
+                /// \brief Expected executions of block per execution of member function,
+                /// product of multipliers of enclosing loops.
+                double executions;
             };
 
             typedef std::unordered_map<unsigned, block_data_type> data_type;
 
+            /// \brief Probabilities of paths indexed by path id.
+            typedef std::vector<double> weights_type;
+
+            /// \brief Limit of analysis budget exceeded by analysis.
+            enum class budget_limit
+            {
+                none,
+                paths,
+                iterations,
+                time
+            };
+
         private:
             typedef std::vector<std::pair<unsigned, block_data_type::yield_state> > yields_type;
 
@@ -193,33 +885,73 @@ namespace bobopt
             }
 
         public:
-            explicit cfg_data(const CFG& cfg)
-                : cfg_(cfg)
+            cfg_data(method_context& method, const ASTContext& context, analysis_budget& budget)
+                : method_(method)
+                , cfg_(*method.get_cfg())
                 , data_()
+                , weights_()
+                , initial_data_()
+                , initial_weights_()
+                , probabilities_(get_branch_probabilities(cfg_, context))
+                , budget_(budget)
+                , exceeded_(budget_limit::none)
             {
-                cfg_data_builder builder(cfg);
+                cfg_data_builder builder(method_, probabilities_, budget_);
                 data_ = builder.build();
+                weights_ = builder.get_weights();
+                exceeded_ = builder.get_exceeded();
+
+                initial_data_ = data_;
+                initial_weights_ = weights_;
             }
 
+            /// \brief Greedily place yields while placement improves goodness.
+            ///
+            /// When budget is exceeded, placement stops and data of the last
+            /// completed step are kept.
             bool optimize()
             {
-                unsigned goodness = get_goodness(data_);
+                if (exceeded_ != budget_limit::none)
+                {
+                    return false;
+                }
+
+                double goodness = get_goodness(data_, weights_);
                 bool optimized = false;
 
-                for (;;)
+                for (unsigned iteration = 0u;; ++iteration)
                 {
-                    auto result = optimize_step(data_);
+                    if ((config_max_iterations.get() != 0u) && (iteration == config_max_iterations.get()))
+                    {
+                        exceeded_ = budget_limit::iterations;
+                        break;
+                    }
+
+                    if (!budget_.check_time())
+                    {
+                        exceeded_ = budget_limit::time;
+                        break;
+                    }
+
+                    weights_type weights;
+                    auto result = optimize_step(data_, weights);
+                    if (exceeded_ != budget_limit::none)
+                    {
+                        break;
+                    }
+
                     if (!result.second)
                     {
                         break;
                     }
 
-                    unsigned temp_goodness = get_goodness(result.first);
+                    double temp_goodness = get_goodness(result.first, weights);
                     if (temp_goodness < goodness)
                     {
                         optimized = true;
                         goodness = temp_goodness;
                         data_.swap(result.first);
+                        weights_.swap(weights);
                     }
                     else
                     {
@@ -230,15 +962,114 @@ namespace bobopt
                 return optimized;
             }
 
+            /// \brief Search for placement with the lowest cost with at most
+            /// \c max_yields planned yields, zero is unlimited.
+            ///
+            /// Search is branch and bound over sets of blocks. Children of
+            /// placement are placements with one more yield in block with path
+            /// over threshold, block ids are increasing to visit every set only
+            /// once. Placement can't be cheaper than overhead of its yields.
+            /// Current placement, usually result of greedy optimization, is the
+            /// initial bound when it satisfies the limit.
+            ///
+            /// \return Whether search wasn't truncated by number of evaluated
+            /// placements or time budget.
+            bool search()
+            {
+                BOBOPT_ASSERT(exceeded_ == budget_limit::none);
+
+                placement_type root;
+                root.data = initial_data_;
+                root.weights = initial_weights_;
+                root.cost = get_cost(root.data, root.weights);
+                root.yields = 0u;
+
+                placement_type best;
+                if ((config_max_yields.get() == 0u) || (get_planned_count() <= config_max_yields.get()))
+                {
+                    best.data = data_;
+                    best.weights = weights_;
+                    best.cost = get_cost();
+                    best.yields = get_planned_count();
+                }
+                else
+                {
+                    best = root;
+                }
+
+                unsigned nodes = 0u;
+                const bool complete = search_placement(root, 0u, best, nodes);
+
+                data_.swap(best.data);
+                weights_.swap(best.weights);
+                return complete;
+            }
+
+            /// \brief Cost of current placement.
+            double get_cost() const
+            {
+                return get_cost(data_, weights_);
+            }
+
+            /// \brief Number of planned yields in current placement.
+            unsigned get_planned_count() const
+            {
+                unsigned result = 0u;
+                for (const auto& block : data_)
+                {
+                    if (block.second.yield == block_data_type::yield_state::planned)
+                    {
+                        ++result;
+                    }
+                }
+
+                return result;
+            }
+
+            /// \brief Complexity of the most complex path between yields in current placement.
+            unsigned get_max_complexity() const
+            {
+                unsigned result = 0u;
+                for (const auto& block : data_)
+                {
+                    if ((block.first != cfg_.getExit().getBlockID()) && (block.second.yield == block_data_type::yield_state::no))
+                    {
+                        continue;
+                    }
+
+                    for (const auto& path : block.second.paths)
+                    {
+                        result = std::max(result, path.complexity);
+                    }
+                }
+
+                return result;
+            }
+
             /// \brief Return calculated data.
             data_type get_data() const
             {
                 return data_;
             }
 
+            /// \brief Return limit of budget exceeded during analysis.
+            budget_limit get_exceeded() const
+            {
+                return exceeded_;
+            }
+
         private:
             BOBOPT_NONCOPYMOVABLE(cfg_data);
 
+            /// \brief Evaluated placement of yields.
+            struct placement_type
+            {
+                data_type data;
+                weights_type weights;
+                double cost;
+                unsigned yields;
+            };
+
             /// \brief Builder of additional CFG data from analyzer CFG.
             ///
             /// Class uses context when building additional data and tries to
@@ -247,30 +1078,51 @@ namespace bobopt
             class cfg_data_builder
             {
             public:
-                explicit cfg_data_builder(const CFG& cfg)
-                    : cfg_(cfg)
+                cfg_data_builder(method_context& method, const probabilities_type& probabilities, analysis_budget& budget)
+                    : method_(method)
+                    , cfg_(*method.get_cfg())
+                    , probabilities_(probabilities)
                     , data_()
+                    , weights_()
                     , id_(0)
                     , yields_()
                     , path_stack_()
                     , loop_stack_()
+                    , executions_(1.0)
+                    , budget_(budget)
+                    , exceeded_(budget_limit::none)
                 {
                 }
 
+                /// \brief Build data. Returned data are incomplete when budget is exceeded.
                 data_type build(const yields_type& yields = yields_type())
                 {
                     yields_ = yields;
 
                     preprocess();
-                    process(cfg_.getEntry(), next_id(), 0u);
+                    process(cfg_.getEntry(), next_id(1.0), 0u);
                     postprocess();
 
 #ifndef NDEBUG
-                    debug_check();
+                    if (exceeded_ == budget_limit::none)
+                    {
+                        debug_check();
+                    }
 #endif // NDEBUG
                     return data_;
                 }
 
+                budget_limit get_exceeded() const
+                {
+                    return exceeded_;
+                }
+
+                /// \brief Probabilities of paths built by the last call to \c build().
+                weights_type get_weights() const
+                {
+                    return weights_;
+                }
+
             private:
                 BOBOPT_NONCOPYMOVABLE(cfg_data_builder);
 
@@ -327,11 +1179,35 @@ namespace bobopt
                 }
 #endif // NDEBUG
 
-                BOBOPT_INLINE unsigned next_id()
+                /// \brief Start new path with given probability.
+                BOBOPT_INLINE unsigned next_id(double weight)
                 {
+                    BOBOPT_ASSERT(weights_.size() == id_);
+                    weights_.push_back(weight);
                     return id_++;
                 }
 
+                /// \brief Probability of reaching successor at index from block.
+                ///
+                /// Without known probability of branch, all successors are
+                /// equally likely. With branch weights disabled, all paths have
+                /// the same weight.
+                BOBOPT_INLINE double get_probability(const CFGBlock& block, unsigned index, unsigned count) const
+                {
+                    if (!config_branch_weights.get())
+                    {
+                        return 1.0;
+                    }
+
+                    const auto found = probabilities_.find(block.getBlockID());
+                    if ((found != std::end(probabilities_)) && (index < found->second.size()))
+                    {
+                        return found->second[index];
+                    }
+
+                    return 1.0 / count;
+                }
+
                 BOBOPT_INLINE block_data_type::yield_state get_block_yield(unsigned id) const
                 {
                     for (const auto& block : yields_)
@@ -351,12 +1227,39 @@ namespace bobopt
                     return !found;
                 }
 
+                /// \brief Number of paths grows exponentially with number of
+                /// branches, check budget before processing each block.
+                bool check_budget()
+                {
+                    if (exceeded_ != budget_limit::none)
+                    {
+                        return false;
+                    }
+
+                    if ((config_max_paths.get() != 0u) && (id_ > config_max_paths.get()))
+                    {
+                        exceeded_ = budget_limit::paths;
+                        return false;
+                    }
+
+                    if (!budget_.consume())
+                    {
+                        exceeded_ = budget_limit::time;
+                        return false;
+                    }
+
+                    return true;
+                }
+
                 void preprocess()
                 {
                     data_.clear();
+                    weights_.clear();
                     id_ = 0;
+                    exceeded_ = budget_limit::none;
                     path_stack_.clear();
                     loop_stack_.clear();
+                    executions_ = 1.0;
                 }
 
                 void postprocess()
@@ -374,6 +1277,11 @@ namespace bobopt
 
                 std::vector<unsigned> process(const CFGBlock& block, unsigned path, unsigned complexity)
                 {
+                    if (!check_budget())
+                    {
+                        return std::vector<unsigned>();
+                    }
+
                     auto block_id = block.getBlockID();
 
                     // Check whether we are in loop.
@@ -390,22 +1298,23 @@ namespace bobopt
                     auto& block_data = data_[block_id];
                     block_data.yield = get_block_yield(block_id);
 
+                    // Block reached also after leaving loop, e.g., by break, is executed once per enclosing loops.
+                    if (block_data.paths.empty() || (executions_ < block_data.executions))
+                    {
+                        block_data.executions = executions_;
+                    }
+
                     unsigned block_complexity = 0u;
                     if (block_data.yield == block_data_type::yield_state::no)
                     {
-                        for (const CFGElement& element : block)
+                        const auto& cost = method_.get_block_cost(block, get_block_cost);
+                        if (cost.yield)
                         {
-                            auto stmt_comlexity = get_element_complexity(element);
-                            block_complexity += stmt_comlexity;
-
-                            // There was call to Bobox yield() in element.
-                            // I consider this blocks complexity equal to zero.
-                            if (stmt_comlexity == 0u)
-                            {
-                                block_complexity = 0u;
-                                block_data.yield = block_data_type::yield_state::present;
-                                break;
-                            }
+                            block_data.yield = block_data_type::yield_state::present;
+                        }
+                        else
+                        {
+                            block_complexity = cost.complexity;
                         }
                     }
 
@@ -415,7 +1324,7 @@ namespace bobopt
                         block_data.paths.push_back(make_path_data(path, complexity));
 
                         // Start new path and ignore returned paths.
-                        process_succ(block, next_id(), 0u);
+                        process_succ(block, next_id(weights_[path]), 0u);
                         return std::vector<unsigned>();
                     }
 
@@ -474,20 +1383,26 @@ namespace bobopt
                     // Process all successing blocks.
                     // The first branch is deep branch where current path continues.
                     // For all other branches, there's new path created.
+                    // Probability of path is split among branches.
                     auto block_it = block.succ_begin();
                     if ((block_it != block.succ_end()) && (*block_it != nullptr))
                     {
+                        const auto count = static_cast<unsigned>(std::count_if(block.succ_begin(), block.succ_end(), [](const CFGBlock* succ)
+                                                                               { return succ != nullptr; }));
+                        const double weight = weights_[path];
+
+                        weights_[path] = weight * get_probability(block, 0u, count);
                         append(return_paths, process(**block_it, path, complexity));
 
                         ++block_it;
-                        for (auto end = block.succ_end(); block_it != end; ++block_it)
+                        for (unsigned index = 1u, end = block.succ_size(); index != end; ++index, ++block_it)
                         {
                             if (*block_it == nullptr)
                             {
                                 continue;
                             }
 
-                            auto id = next_id();
+                            auto id = next_id(weight * get_probability(block, index, count));
                             return_paths.push_back(id);
                             append(return_paths, process(**block_it, id, complexity));
                         }
@@ -520,7 +1435,10 @@ namespace bobopt
                         stack_guard_type<unsigned> guard(loop_stack_, block.getBlockID());
                         BOBOPT_UNUSED_EXPRESSION(guard);
 
+                        const double executions = executions_;
+                        executions_ *= multiplier;
                         process(body, path, 0u);
+                        executions_ = executions;
                     }
 
                     std::vector<unsigned> return_paths;
@@ -542,20 +1460,25 @@ namespace bobopt
                     return return_paths;
                 }
 
+                method_context& method_;
                 const CFG& cfg_;
+                const probabilities_type& probabilities_;
 
                 data_type data_;
+                weights_type weights_;
                 unsigned id_;
                 yields_type yields_;
                 std::vector<unsigned> path_stack_;
                 std::vector<unsigned> loop_stack_;
+                /// \brief Product of multipliers of loops on \c loop_stack_.
+                double executions_;
+                analysis_budget& budget_;
+                budget_limit exceeded_;
             }; // cfg_data_builder
 
-            std::pair<data_type, bool> optimize_step(const data_type& src_data)
+            /// \brief Find all blocks where paths end, i.e., exit and yield blocks.
+            std::vector<const block_data_type*> get_end_blocks(const data_type& src_data, yields_type& yields) const
             {
-                yields_type yields;
-
-                // Find all blocks where paths end, i.e., exit and yield blocks.
                 std::vector<const block_data_type*> end_blocks;
                 for (const auto& block : src_data)
                 {
@@ -570,9 +1493,17 @@ namespace bobopt
                 BOBOPT_ASSERT(exit_block_it != std::end(src_data));
                 end_blocks.push_back(&(exit_block_it->second));
 
+                return end_blocks;
+            }
+
+            std::pair<data_type, bool> optimize_step(const data_type& src_data, weights_type& dst_weights)
+            {
+                yields_type yields;
+                const auto end_blocks = get_end_blocks(src_data, yields);
+
                 // Iterate through all blocks and calculate what we can achieve
                 // by placing yield inside block.
-                unsigned goodness = std::numeric_limits<unsigned>::max();
+                double goodness = std::numeric_limits<double>::max();
                 unsigned block_id = 0u;
                 bool optimized = false;
                 for (const auto& block : src_data)
@@ -587,7 +1518,7 @@ namespace bobopt
                         continue;
                     }
 
-                    auto result = optimize_block(block.second, end_blocks);
+                    auto result = optimize_block(block.second, end_blocks, weights_);
                     if (result.second && (result.first < goodness))
                     {
                         block_id = block.first;
@@ -602,8 +1533,11 @@ namespace bobopt
                 {
                     yields.emplace_back(block_id, block_data_type::yield_state::planned);
 
-                    cfg_data_builder builder(cfg_);
-                    return std::make_pair(builder.build(yields), true);
+                    cfg_data_builder builder(method_, probabilities_, budget_);
+                    auto data = builder.build(yields);
+                    dst_weights = builder.get_weights();
+                    exceeded_ = builder.get_exceeded();
+                    return std::make_pair(std::move(data), true);
                 }
 
                 return std::make_pair(data_type(), false);
@@ -617,9 +1551,23 @@ namespace bobopt
                                     { return std::find(std::begin(path.ids), std::end(path.ids), id) != std::end(path.ids); });
             }
 
-            std::pair<unsigned, bool> optimize_block(const block_data_type& block, const std::vector<const block_data_type*>& end_blocks)
+            /// \brief Sum of probabilities of paths.
+            static double get_weight(const std::vector<unsigned>& ids, const weights_type& weights)
+            {
+                double result = 0.0;
+                for (auto id : ids)
+                {
+                    BOBOPT_ASSERT(id < weights.size());
+                    result += weights[id];
+                }
+
+                return result;
+            }
+
+            /// \brief Expected distance from threshold after placing yield into block.
+            std::pair<double, bool> optimize_block(const block_data_type& block, const std::vector<const block_data_type*>& end_blocks, const weights_type& weights)
             {
-                unsigned distance = 0u;
+                double distance = 0.0;
                 unsigned count = 0u;
 
                 // Check whether block is worth optimizing.
@@ -634,12 +1582,12 @@ namespace bobopt
                         over_threshold = true;
                     }
 
-                    distance += ids_size * value_distance(config_threshold.get(), path.complexity);
+                    distance += get_weight(path.ids, weights) * value_distance(config_threshold.get(), path.complexity);
                 }
 
                 if (!over_threshold)
                 {
-                    return std::make_pair(0u, false);
+                    return std::make_pair(0.0, false);
                 }
 
                 // Evaluate blocks at the end of paths.
@@ -655,12 +1603,12 @@ namespace bobopt
                             const auto found_it = find_path(id, block);
                             if (found_it == std::end(block.paths))
                             {
-                                distance += path_distance;
+                                distance += weights[id] * path_distance;
                                 continue;
                             }
 
                             auto new_complexity = path.complexity - found_it->complexity;
-                            distance += value_distance(config_threshold.get(), new_complexity);
+                            distance += weights[id] * value_distance(config_threshold.get(), new_complexity);
                         }
                     }
                 }
@@ -668,43 +1616,224 @@ namespace bobopt
                 return std::make_pair(distance, true);
             }
 
-            unsigned get_goodness(const data_type& data) const
+            /// \brief Recursive step of \c search().
+            bool search_placement(const placement_type& current, unsigned min_block_id, placement_type& best, unsigned& nodes)
+            {
+                if (current.cost < best.cost)
+                {
+                    best = current;
+                }
+
+                if ((config_max_yields.get() != 0u) && (current.yields >= config_max_yields.get()))
+                {
+                    return true;
+                }
+
+                // More yields can't lower overhead.
+                if (get_overhead(current.data, current.weights) >= best.cost)
+                {
+                    return true;
+                }
+
+                yields_type yields;
+                const auto end_blocks = get_end_blocks(current.data, yields);
+
+                // Evaluate the most promising blocks first.
+                std::vector<std::pair<double, unsigned> > candidates;
+                for (const auto& block : current.data)
+                {
+                    if ((block.second.yield != block_data_type::yield_state::no) || (block.first == cfg_.getExit().getBlockID()) || (block.first < min_block_id))
+                    {
+                        continue;
+                    }
+
+                    auto result = optimize_block(block.second, end_blocks, current.weights);
+                    if (result.second)
+                    {
+                        candidates.emplace_back(result.first, block.first);
+                    }
+                }
+                std::sort(std::begin(candidates), std::end(candidates));
+
+                for (const auto& candidate : candidates)
+                {
+                    if ((config_max_search_nodes.get() != 0u) && (nodes >= config_max_search_nodes.get()))
+                    {
+                        return false;
+                    }
+                    ++nodes;
+
+                    yields_type next_yields(yields);
+                    next_yields.emplace_back(candidate.second, block_data_type::yield_state::planned);
+
+                    cfg_data_builder builder(method_, probabilities_, budget_);
+                    placement_type next;
+                    next.data = builder.build(next_yields);
+                    if (builder.get_exceeded() != budget_limit::none)
+                    {
+                        return false;
+                    }
+
+                    next.weights = builder.get_weights();
+                    next.cost = get_cost(next.data, next.weights);
+                    next.yields = current.yields + 1u;
+
+                    if (!search_placement(next, candidate.second + 1u, best, nodes))
+                    {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+            /// \brief Cost of placement is expected distance from threshold plus expected overhead of yields.
+            double get_cost(const data_type& data, const weights_type& weights) const
+            {
+                return get_goodness(data, weights) + get_overhead(data, weights);
+            }
+
+            /// \brief Expected scheduling overhead of planned yields. Yield is
+            /// executed by every path ending in its block, once per iteration
+            /// of each enclosing loop.
+            static double get_overhead(const data_type& data, const weights_type& weights)
+            {
+                double executions = 0.0;
+                for (const auto& block : data)
+                {
+                    if (block.second.yield == block_data_type::yield_state::planned)
+                    {
+                        for (const auto& path : block.second.paths)
+                        {
+                            executions += get_weight(path.ids, weights) * block.second.executions;
+                        }
+                    }
+                }
+
+                return executions * config_yield_overhead.get();
+            }
+
+            /// \brief Expected distance of complexity of paths from threshold. Lower is better.
+            double get_goodness(const data_type& data, const weights_type& weights) const
             {
                 auto exit_it = data.find(cfg_.getExit().getBlockID());
                 BOBOPT_ASSERT(exit_it != std::end(data));
                 BOBOPT_ASSERT(exit_it->second.yield != block_data_type::yield_state::planned);
 
-                unsigned distance = 0u;
+                double distance = 0.0;
                 unsigned count = 0u;
 
-                // Paths ending in Exit block.
-                for (const auto& path : exit_it->second.paths)
+                // Paths ending in Exit block.
+                for (const auto& path : exit_it->second.paths)
+                {
+                    const auto ids_count = static_cast<unsigned>(path.ids.size());
+                    count += ids_count;
+                    distance += get_weight(path.ids, weights) * value_distance(config_threshold.get(), path.complexity);
+                }
+
+                // Paths ending in yielded blocks.
+                for (const auto& block : data)
+                {
+                    if (block.second.yield != block_data_type::yield_state::no)
+                    {
+                        for (const auto& path : block.second.paths)
+                        {
+                            const auto ids_count = static_cast<unsigned>(path.ids.size());
+                            count += ids_count;
+                            distance += get_weight(path.ids, weights) * value_distance(config_threshold.get(), path.complexity);
+                        }
+                    }
+                }
+
+                return distance;
+            }
+
+            method_context& method_;
+            const CFG& cfg_;
+            data_type data_;
+            weights_type weights_;
+            data_type initial_data_;
+            weights_type initial_weights_;
+            probabilities_type probabilities_;
+            analysis_budget& budget_;
+            budget_limit exceeded_;
+        };
+
+        namespace
+        {
+
+            /// \brief Complexity of single execution of functor, the most complex path of its CFG.
+            ///
+            /// Functor is costed by the same path analysis as member function, branches
+            /// count by the more complex arm and loops by their multipliers. When paths
+            /// of functor exceed analysis budget, all blocks of its CFG are summed.
+            /// Functor spends budget of member function that calls it and its
+            /// complexity is cached in box context.
+            unsigned get_functor_complexity(const FunctionDecl* function)
+            {
+                // Functions whose complexity is being computed, recursive functor is costed as ordinary call.
+                static std::vector<const FunctionDecl*> stack;
+
+                unsigned cost = 0u;
+                if ((function != nullptr) && get_annotated_cost(function, cost))
+                {
+                    return cost;
+                }
+
+                const FunctionDecl* definition = nullptr;
+                if ((function == nullptr) || !function->hasBody(definition) || (std::find(stack.begin(), stack.end(), definition) != stack.end()))
+                {
+                    return config_call_default_complexity.get();
+                }
+
+                cost_scope* scope = cost_scope::get_current();
+                if (scope != nullptr)
+                {
+                    auto found = scope->get_functor_complexities().find(definition);
+                    if (found != scope->get_functor_complexities().end())
+                    {
+                        return found->second;
+                    }
+                }
+
+                method_context context(const_cast<FunctionDecl*>(definition));
+                const CFG* cfg = context.get_cfg();
+                if (cfg == nullptr)
+                {
+                    return config_call_default_complexity.get();
+                }
+
+                stack.push_back(definition);
+
+                // Outside of member function analysis functor gets its own budget.
+                analysis_budget own_budget(0u, config_time_budget.get());
+                analysis_budget& budget = (scope != nullptr) ? scope->get_budget() : own_budget;
+                cfg_data data(context, definition->getASTContext(), budget);
+
+                unsigned result = 0u;
+                if (data.get_exceeded() == cfg_data::budget_limit::none)
                 {
-                    const auto ids_count = static_cast<unsigned>(path.ids.size());
-                    count += ids_count;
-                    distance += ids_count * value_distance(config_threshold.get(), path.complexity);
+                    result = data.get_max_complexity();
                 }
-
-                // Paths ending in yielded blocks.
-                for (const auto& block : data)
+                else
                 {
-                    if (block.second.yield != block_data_type::yield_state::no)
+                    for (const CFGBlock* block : *cfg)
                     {
-                        for (const auto& path : block.second.paths)
-                        {
-                            const auto ids_count = static_cast<unsigned>(path.ids.size());
-                            count += ids_count;
-                            distance += ids_count * value_distance(config_threshold.get(), path.complexity);
-                        }
+                        result += context.get_block_cost(*block, get_block_cost).complexity;
                     }
                 }
 
-                return distance;
+                stack.pop_back();
+
+                if (scope != nullptr)
+                {
+                    scope->get_functor_complexities()[definition] = result;
+                }
+
+                return result;
             }
 
-            const CFG& cfg_;
-            data_type data_;
-        };
+        } // namespace
 
         // yield_complex implementation.
         //==============================================================================
@@ -721,6 +1850,9 @@ namespace bobopt
         yield_complex::yield_complex()
             : box_(nullptr)
             , replacements_(nullptr)
+            , context_(nullptr)
+            , endl_()
+            , counters_(0)
         {
         }
 
@@ -729,6 +1861,13 @@ namespace bobopt
         {
         }
 
+        /// \brief Instantiations of box template can differ in cost, yields of the most
+        /// expensive one are kept in each member function, together with its counters.
+        basic_method::merge_policies yield_complex::get_merge_policy() const
+        {
+            return MERGE_WORST_CASE;
+        }
+
         /// \brief Inherited optimization member function.
         /// It just checks and stores optmization parameters and forwards job to dedicated member function.
         void yield_complex::optimize(CXXRecordDecl* box, tooling::Replacements* replacements)
@@ -736,6 +1875,8 @@ namespace bobopt
             BOBOPT_ASSERT(box != nullptr);
             BOBOPT_ASSERT(replacements != nullptr);
 
+            scoped_timer timer("yield_complex::optimize");
+
             box_ = box;
             replacements_ = replacements;
 
@@ -768,27 +1909,32 @@ namespace bobopt
         {
             BOBOPT_ASSERT(method != nullptr);
 
-            if (!method->hasBody())
-            {
-                return;
-            }
+            method_context& context = get_context().get_method_context(method);
 
-            CompoundStmt* body = llvm::dyn_cast_or_null<CompoundStmt>(method->getBody());
+            CompoundStmt* body = context.get_body();
             if (body == nullptr)
             {
                 return;
             }
 
-            CFG::BuildOptions options;
-            std::unique_ptr<CFG> cfg(CFG::buildCFG(method, body, &method->getASTContext(), options));
+            scoped_timer timer("optimize_method");
 
+            const CFG* cfg = context.get_cfg();
             if (cfg == nullptr)
             {
                 llvm::errs() << "[ERROR] Failed to build CFG from function body.\n";
                 return;
             }
 
+            context_ = &context;
+            counters_ = 0;
             optimize_body(method, body, *cfg);
+            context_ = nullptr;
+
+            if (time_report::instance().enabled())
+            {
+                time_report::instance().add_item(time_report::IK_METHOD, method->getQualifiedNameAsString(), timer.elapsed());
+            }
         }
 
         typedef std::unordered_map<unsigned, const CFGBlock*> id_block_map;
@@ -838,21 +1984,109 @@ namespace bobopt
             out << "\n\n";
         }
 
+        /// \brief Name of exceeded budget limit used in diagnostic and counter.
+        static const char* get_budget_limit_name(cfg_data::budget_limit limit)
+        {
+            switch (limit)
+            {
+            case cfg_data::budget_limit::paths:
+            {
+                return "paths";
+            }
+
+            case cfg_data::budget_limit::iterations:
+            {
+                return "iterations";
+            }
+
+            case cfg_data::budget_limit::time:
+            {
+                return "time";
+            }
+
+            default:
+            {
+                BOBOPT_ERROR("Should never reach this code.");
+            }
+            }
+
+            return "none";
+        }
+
         /// \brief Optimize member function body represented by CFG.
         void yield_complex::optimize_body(CXXMethodDecl* method, CompoundStmt* body, const CFG& cfg)
         {
             if (config_yield_predefined.get() && yield_predefined(cfg, body))
             {
+                get_optimizer().record_decision(method->getNameAsString(), "yields", "predefined");
+                return;
+            }
+
+            analysis_budget budget(0u, config_time_budget.get());
+            cost_scope scope(budget, get_context());
+            BOBOPT_UNUSED_EXPRESSION(scope);
+
+            std::unique_ptr<cfg_data> data;
+            {
+                scoped_timer timer("cfg_data build");
+                data = make_unique<cfg_data>(*context_, method->getASTContext(), budget);
+            }
+
+            // Paths are incomplete, there's nothing to optimize on.
+            if (data->get_exceeded() != cfg_data::budget_limit::none)
+            {
+                yield_fallback(method, body, get_budget_limit_name(data->get_exceeded()));
+                return;
+            }
+
+            // Instantiations of box template are compared by the costliest path before placement.
+            get_optimizer().record_cost(method, data->get_max_complexity());
+
+            bool optimized = false;
+            {
+                scoped_timer timer("cfg_data::optimize");
+                optimized = data->optimize();
+            }
+
+            // Yields placed before budget was exceeded are kept.
+            const bool exceeded = (data->get_exceeded() != cfg_data::budget_limit::none);
+            if (exceeded && !optimized)
+            {
+                yield_fallback(method, body, get_budget_limit_name(data->get_exceeded()));
                 return;
             }
 
-            cfg_data data(cfg);
-            if (!data.optimize())
+            // Greedy result is kept for comparison with search.
+            const unsigned greedy_yields = data->get_planned_count();
+            const double greedy_cost = data->get_cost();
+            bool searched = false;
+            bool search_complete = true;
+            if (config_search_placement.get() && !exceeded)
+            {
+                scoped_timer timer("cfg_data::search");
+                searched = true;
+                search_complete = data->search();
+                optimized = (data->get_planned_count() != 0u);
+
+                if (data->get_cost() < greedy_cost)
+                {
+                    statistics::instance().increment("yield_complex.search.improved");
+                }
+                if (!search_complete)
+                {
+                    statistics::instance().increment("yield_complex.search.truncated");
+                }
+            }
+
+            get_optimizer().record_decision(method->getNameAsString(), "yields", std::to_string(data->get_planned_count()));
+            get_optimizer().record_decision(method->getNameAsString(), "max path cost", std::to_string(data->get_max_complexity()));
+
+            if (!optimized)
             {
                 return;
             }
 
-            auto optimized_data = data.get_data();
+            auto optimized_data = data->get_data();
             auto map = build_block_map(cfg);
 
             std::vector<unsigned> ids;
@@ -864,11 +2098,7 @@ namespace bobopt
                 }
             }
 
-            nodes_collector<CompoundStmt> compound_collector;
-            compound_collector.TraverseStmt(body);
-            std::vector<const CompoundStmt*> stmts(compound_collector.nodes_begin(), compound_collector.nodes_end());
-
-            endl_ = detect_line_end(get_optimizer().get_compiler().getSourceManager(), box_);
+            endl_ = get_context().get_line_end();
 
             if (get_optimizer().verbose())
             {
@@ -876,6 +2106,19 @@ namespace bobopt
 
                 auto& diag = get_optimizer().get_diagnostic();
                 diag.emit(diag.get_message_decl(diagnostic_message::types::info, method, "method takes too long time on some paths:"));
+
+                if (searched)
+                {
+                    std::ostringstream message;
+                    message << "greedy placement: " << greedy_yields << " yield(s), cost " << greedy_cost << "; search placement: " << data->get_planned_count()
+                            << " yield(s), cost " << data->get_cost() << (search_complete ? "" : " (search truncated)") << "\n\n";
+                    llvm::outs() << message.str();
+                }
+            }
+
+            if (exceeded)
+            {
+                report_budget_exceeded(method, "yield_complex", get_budget_limit_name(data->get_exceeded()), "keeping yields placed so far");
             }
 
             // Insert yields.
@@ -883,7 +2126,113 @@ namespace bobopt
             {
                 BOBOPT_ASSERT(map.count(id) == 1);
                 const CFGBlock& block = *(map.find(id)->second);
-                BOBOPT_CHECK(inserter(block, stmts));
+                BOBOPT_CHECK(inserter(block));
+            }
+        }
+
+        namespace
+        {
+
+            /// \brief Collects bodies of loops that are not nested in other loops.
+            class outermost_loops_collector : public RecursiveASTVisitor<outermost_loops_collector>
+            {
+            public:
+                bool TraverseForStmt(ForStmt* for_stmt)
+                {
+                    bodies.push_back(for_stmt->getBody());
+                    return true;
+                }
+
+                bool TraverseCXXForRangeStmt(CXXForRangeStmt* for_range_stmt)
+                {
+                    bodies.push_back(for_range_stmt->getBody());
+                    return true;
+                }
+
+                bool TraverseWhileStmt(WhileStmt* while_stmt)
+                {
+                    bodies.push_back(while_stmt->getBody());
+                    return true;
+                }
+
+                bool TraverseDoStmt(DoStmt* do_stmt)
+                {
+                    bodies.push_back(do_stmt->getBody());
+                    return true;
+                }
+
+                /// \brief Lambda bodies are not executed by member function itself.
+                bool TraverseLambdaExpr(LambdaExpr*)
+                {
+                    return true;
+                }
+
+                std::vector<Stmt*> bodies;
+            };
+
+            /// \brief Function detects whether statement of member function contains call to Bobox yield().
+            bool contains_yield_call(method_context& context, Stmt* stmt)
+            {
+                for (const auto* call_expr : context.get_calls())
+                {
+                    if (is_yield_call(call_expr) && context.contains(stmt, call_expr))
+                    {
+                        return true;
+                    }
+                }
+
+                return false;
+            }
+
+        } // namespace
+
+        /// \brief Cheap heuristic used when analysis exceeds its budget.
+        ///
+        /// Yield is inserted at the beginning of body of every outermost loop
+        /// that doesn't yield already. Member function without such loops is
+        /// skipped, as well as any member function when fallback is disabled.
+        void yield_complex::yield_fallback(CXXMethodDecl* method, CompoundStmt* body, const char* limit)
+        {
+            get_optimizer().record_decision(method->getNameAsString(), "yields", std::string("budget fallback (") + limit + ")");
+
+            if (get_optimizer().verbose())
+            {
+                emit_header(box_);
+            }
+
+            if (!config_budget_fallback.get())
+            {
+                report_budget_exceeded(method, "yield_complex", limit, "skipping method");
+                return;
+            }
+
+            outermost_loops_collector collector;
+            collector.TraverseStmt(body);
+
+            std::vector<Stmt*> first_stmts;
+            for (auto* loop_body : collector.bodies)
+            {
+                CompoundStmt* compound_stmt = llvm::dyn_cast_or_null<CompoundStmt>(loop_body);
+                if ((compound_stmt == nullptr) || compound_stmt->body_empty() || contains_yield_call(get_context().get_method_context(method), compound_stmt))
+                {
+                    continue;
+                }
+
+                first_stmts.push_back(*compound_stmt->body_begin());
+            }
+
+            if (first_stmts.empty())
+            {
+                report_budget_exceeded(method, "yield_complex", limit, "skipping method without loops to yield in");
+                return;
+            }
+
+            report_budget_exceeded(method, "yield_complex", limit, "placing yield() at the beginning of outermost loops");
+
+            endl_ = get_context().get_line_end();
+            for (auto* stmt : first_stmts)
+            {
+                inserter_invoke(stmt, stmt->getLocStart());
             }
         }
 
@@ -1071,21 +2420,14 @@ namespace bobopt
             auto newEnd = std::unique(std::begin(callback.statements), std::end(callback.statements));
             callback.statements.erase(newEnd, std::end(callback.statements));
 
-            endl_ = detect_line_end(get_optimizer().get_compiler().getSourceManager(), box_);
-
-            nodes_collector<CompoundStmt> collector;
-            collector.TraverseStmt(body);
+            endl_ = get_context().get_line_end();
 
             bool inserted = false;
             for (auto* stmt : callback.statements)
             {
-                for (auto it = collector.nodes_begin(), end = collector.nodes_end(); it != end; ++it)
+                if (inserter(stmt))
                 {
-                    if (inserter(stmt, *it))
-                    {
-                        inserted = true;
-                        break;
-                    }
+                    inserted = true;
                 }
             }
 
@@ -1095,37 +2437,186 @@ namespace bobopt
         namespace
         {
 
-            /// \brief Helper for looking up statement in AST subtree.
-            class recursive_stmt_find_helper : public RecursiveASTVisitor<recursive_stmt_find_helper>
+            /// \brief Body of innermost loop that executes statement on every iteration, \c nullptr if there's none.
+            ///
+            /// Increment of for loop is considered part of its body, yield for it is placed at the end of body.
+            const Stmt* get_enclosing_loop_body(method_context& context, const Stmt* stmt)
             {
-            public:
-                recursive_stmt_find_helper(const Stmt* stmt)
-                    : stmt_(stmt)
+                const ParentMap& parent_map = context.get_parent_map();
+                for (const Stmt* child = stmt, *parent = parent_map.getParent(stmt); parent != nullptr; child = parent, parent = parent_map.getParent(parent))
                 {
+                    if (llvm::isa<LambdaExpr>(parent))
+                    {
+                        return nullptr;
+                    }
+
+                    const ForStmt* for_stmt = llvm::dyn_cast<ForStmt>(parent);
+                    if ((for_stmt != nullptr) && ((child == for_stmt->getBody()) || (child == for_stmt->getInc())))
+                    {
+                        return for_stmt->getBody();
+                    }
+
+                    const CXXForRangeStmt* for_range_stmt = llvm::dyn_cast<CXXForRangeStmt>(parent);
+                    if ((for_range_stmt != nullptr) && (child == for_range_stmt->getBody()))
+                    {
+                        return for_range_stmt->getBody();
+                    }
+
+                    const WhileStmt* while_stmt = llvm::dyn_cast<WhileStmt>(parent);
+                    if ((while_stmt != nullptr) && (child == while_stmt->getBody()))
+                    {
+                        return while_stmt->getBody();
+                    }
+
+                    const DoStmt* do_stmt = llvm::dyn_cast<DoStmt>(parent);
+                    if ((do_stmt != nullptr) && (child == do_stmt->getBody()))
+                    {
+                        return do_stmt->getBody();
+                    }
                 }
 
-                bool VisitStmt(Stmt* stmt)
+                return nullptr;
+            }
+
+            /// \brief Number of executions of statement per single iteration of loop body.
+            ///
+            /// Statement in body or increment of nested loop is executed once per its
+            /// iteration, loops are multiplied as in analysis of paths.
+            unsigned long long get_nested_executions(method_context& context, const Stmt* body, const Stmt* stmt)
+            {
+                const ParentMap& parent_map = context.get_parent_map();
+
+                unsigned long long result = 1ull;
+                for (const Stmt* child = stmt, *parent = parent_map.getParent(stmt); (child != body) && (parent != nullptr); child = parent, parent = parent_map.getParent(parent))
                 {
-                    return !(stmt_ == stmt);
+                    const ForStmt* for_stmt = llvm::dyn_cast<ForStmt>(parent);
+                    if ((for_stmt != nullptr) && ((child == for_stmt->getBody()) || (child == for_stmt->getInc())))
+                    {
+                        result *= config_multiplier_for.get();
+                        continue;
+                    }
+
+                    const CXXForRangeStmt* for_range_stmt = llvm::dyn_cast<CXXForRangeStmt>(parent);
+                    if ((for_range_stmt != nullptr) && (child == for_range_stmt->getBody()))
+                    {
+                        result *= config_multiplier_for.get();
+                        continue;
+                    }
+
+                    const WhileStmt* while_stmt = llvm::dyn_cast<WhileStmt>(parent);
+                    if ((while_stmt != nullptr) && (child == while_stmt->getBody()))
+                    {
+                        result *= config_multiplier_while.get();
+                        continue;
+                    }
+
+                    const DoStmt* do_stmt = llvm::dyn_cast<DoStmt>(parent);
+                    if ((do_stmt != nullptr) && (child == do_stmt->getBody()))
+                    {
+                        result *= config_multiplier_while.get();
+                    }
                 }
 
-            private:
-                const Stmt* stmt_;
-            };
+                return result;
+            }
+
+            /// \brief Complexity of single iteration of loop body, nested loops are multiplied.
+            unsigned get_loop_body_complexity(method_context& context, const Stmt* body)
+            {
+                const CFG* cfg = context.get_cfg();
+                BOBOPT_ASSERT(cfg != nullptr);
+
+                unsigned long long result = 0ull;
+                for (const CFGBlock* block : *cfg)
+                {
+                    for (const CFGElement& element : *block)
+                    {
+                        if (element.getKind() != CFGElement::Kind::Statement)
+                        {
+                            continue;
+                        }
+
+                        const Stmt* stmt = element.castAs<CFGStmt>().getStmt();
+                        if (context.contains(body, stmt))
+                        {
+                            result += context.get_block_cost(*block, get_block_cost).complexity * get_nested_executions(context, body, stmt);
+                        }
+                        break;
+                    }
+                }
+
+                return static_cast<unsigned>(std::min<unsigned long long>(result, std::numeric_limits<unsigned>::max()));
+            }
 
         } // namespace
 
+        /// \brief Number of iterations of loop between two executions of yield placed before statement.
+        ///
+        /// Stride is one outside of loops and in loops whose body alone reaches threshold.
+        unsigned yield_complex::get_stride(const Stmt* stmt) const
+        {
+            if (!config_stride_yields.get() || (context_ == nullptr))
+            {
+                return 1u;
+            }
+
+            const Stmt* body = get_enclosing_loop_body(*context_, stmt);
+            if (body == nullptr)
+            {
+                return 1u;
+            }
+
+            const unsigned complexity = std::max(get_loop_body_complexity(*context_, body), 1u);
+            const unsigned stride = std::min(config_threshold.get() / complexity, config_max_stride.get());
+            return std::max(stride, 1u);
+        }
+
+        /// \brief Declare new yield counter at the beginning of member function body, returns its name.
+        ///
+        /// Counter lives for the whole invocation, so stride holds also when loop
+        /// is nested and runs only few iterations at once.
+        std::string yield_complex::declare_counter() const
+        {
+            BOBOPT_ASSERT(context_ != nullptr);
+
+            const CompoundStmt* body = context_->get_body();
+            BOBOPT_ASSERT((body != nullptr) && !body->body_empty());
+
+            auto& sm = get_optimizer().get_compiler().getSourceManager();
+            const LangOptions& lang_options = get_optimizer().get_compiler().getLangOpts();
+
+            const std::string name = "bobopt_yield_counter_" + std::to_string(counters_++);
+            const std::string code = endl_ + stmt_indent(sm, body->body_front()) + "unsigned " + name + " = 0;";
+            const SourceLocation location = Lexer::getLocForEndOfToken(sm.getExpansionLoc(body->getLBracLoc()), 0, sm, lang_options);
+            replacements_->insert(Replacement(sm, location, 0, code));
+
+            return name;
+        }
+
         /// \brief Final phase for inserting \c yield() call to source code.
+        ///
+        /// Yield inside loop with cheap body is guarded by counter of iterations,
+        /// so it runs roughly once per threshold worth of work.
         void yield_complex::inserter_invoke(Stmt* stmt, SourceLocation location) const
         {
             auto& sm = get_optimizer().get_compiler().getSourceManager();
             location = sm.getExpansionLoc(location);
 
+            const unsigned stride = get_stride(stmt);
+
             bool update_code = false;
             if (get_optimizer().verbose())
             {
                 auto& diag = get_optimizer().get_diagnostic();
-                diag.emit(diag.get_message_stmt(diagnostic_message::types::suggestion, stmt, "placing yield() call just before statement:"));
+                if (stride > 1u)
+                {
+                    const std::string message = "placing yield() call executed every " + std::to_string(stride) + " iterations just before statement:";
+                    diag.emit(diag.get_message_stmt(diagnostic_message::types::suggestion, stmt, message));
+                }
+                else
+                {
+                    diag.emit(diag.get_message_stmt(diagnostic_message::types::suggestion, stmt, "placing yield() call just before statement:"));
+                }
 
                 if (get_optimizer().get_mode() == MODE_INTERACTIVE)
                 {
@@ -1137,9 +2628,27 @@ namespace bobopt
                 }
             }
 
-            if (update_code || (get_optimizer().get_mode() == MODE_BUILD))
+            const modes mode = get_optimizer().get_mode();
+            if (update_code || (mode == MODE_BUILD) || (mode == MODE_PROFILE))
             {
-                std::string yield_code = "yield();" + endl_ + location_indent(sm, location);
+                const std::string indent = location_indent(sm, location);
+
+                std::string yield_code;
+                if (stride > 1u)
+                {
+                    const std::string counter = declare_counter();
+                    const std::string call = (mode == MODE_PROFILE) ? "{ BOBOPT_PROFILE_YIELD(); yield(); }" : "yield();";
+                    yield_code = "if (++" + counter + " % " + std::to_string(stride) + " == 0) " + call + endl_ + indent;
+                    statistics::instance().increment("yield_complex.strided_yields");
+                }
+                else
+                {
+                    if (mode == MODE_PROFILE)
+                    {
+                        yield_code = "BOBOPT_PROFILE_YIELD();" + endl_ + indent;
+                    }
+                    yield_code += "yield();" + endl_ + indent;
+                }
                 replacements_->insert(Replacement(sm, location, 0, yield_code));
             }
         }
@@ -1147,12 +2656,13 @@ namespace bobopt
         /// \brief Helper to analyze subtree of single statement in compound statement.
         bool yield_complex::inserter_helper(Stmt* dst_stmt, const Stmt* src_stmt) const
         {
-            recursive_stmt_find_helper helper(src_stmt);
+            BOBOPT_ASSERT(context_ != nullptr);
+            method_context& context = *context_;
 
             IfStmt* if_stmt = llvm::dyn_cast<IfStmt>(dst_stmt);
             if (if_stmt != nullptr)
             {
-                if (!helper.TraverseStmt(if_stmt->getCond()))
+                if (context.contains(if_stmt->getCond(), src_stmt))
                 {
                     inserter_invoke(if_stmt, if_stmt->getLocStart());
                     return true;
@@ -1163,22 +2673,20 @@ namespace bobopt
             ForStmt* for_stmt = llvm::dyn_cast<ForStmt>(dst_stmt);
             if (for_stmt != nullptr)
             {
-                if (!helper.TraverseStmt(for_stmt->getInit()))
+                if (context.contains(for_stmt->getInit(), src_stmt))
                 {
                     inserter_invoke(for_stmt, for_stmt->getLocStart());
                     return true;
                 }
 
-                recursive_stmt_find_helper helper1(src_stmt);
-                if (!helper1.TraverseStmt(for_stmt->getInc()))
+                if (context.contains(for_stmt->getInc(), src_stmt))
                 {
                     const CompoundStmt* body = llvm::dyn_cast_or_null<const CompoundStmt>(for_stmt->getBody());
                     inserter_invoke(for_stmt->getInc(), body->getRBracLoc());
                     return true;
                 }
 
-                recursive_stmt_find_helper helper2(src_stmt);
-                if (!helper1.TraverseStmt(for_stmt->getCond()))
+                if (context.contains(for_stmt->getCond(), src_stmt))
                 {
                     inserter_invoke(for_stmt->getCond(), for_stmt->getLocStart());
                     return true;
@@ -1190,7 +2698,7 @@ namespace bobopt
             WhileStmt* while_stmt = llvm::dyn_cast<WhileStmt>(dst_stmt);
             if (while_stmt != nullptr)
             {
-                if (!helper.TraverseStmt(while_stmt->getCond()))
+                if (context.contains(while_stmt->getCond(), src_stmt))
                 {
                     inserter_invoke(while_stmt, while_stmt->getLocStart());
                     return true;
@@ -1201,7 +2709,7 @@ namespace bobopt
             SwitchStmt* switch_stmt = llvm::dyn_cast<SwitchStmt>(dst_stmt);
             if (switch_stmt != nullptr)
             {
-                if (!helper.TraverseStmt(switch_stmt->getCond()))
+                if (context.contains(switch_stmt->getCond(), src_stmt))
                 {
                     inserter_invoke(switch_stmt, switch_stmt->getLocStart());
                     return true;
@@ -1215,7 +2723,7 @@ namespace bobopt
                 return false;
             }
 
-            if (!helper.TraverseStmt(dst_stmt))
+            if (context.contains(dst_stmt, src_stmt))
             {
                 inserter_invoke(dst_stmt, dst_stmt->getLocStart());
                 return true;
@@ -1224,12 +2732,32 @@ namespace bobopt
             return false;
         }
 
-        /// \brief Helper for insert yield for block into compound statement.
-        bool yield_complex::inserter(const Stmt* stmt, const CompoundStmt* compound_stmt) const
+        /// \brief Helper for insert yield before statement into the outermost compound statement that allows it.
+        ///
+        /// Compound statements enclosing statement are found through parent map of member function, outermost
+        /// first. Only child of compound statement on the way to statement can hold it.
+        bool yield_complex::inserter(const Stmt* stmt) const
         {
-            for (auto it = compound_stmt->body_begin(), end = compound_stmt->body_end(); it != end; ++it)
+            BOBOPT_ASSERT(context_ != nullptr);
+            const ParentMap& parent_map = context_->get_parent_map();
+
+            std::vector<Stmt*> ancestors;
+            for (const Stmt* it = stmt; it != nullptr; it = parent_map.getParent(it))
             {
-                if (inserter_helper(*it, stmt))
+                ancestors.push_back(const_cast<Stmt*>(it));
+            }
+
+            // Ancestors are ordered from statement up to member function body.
+            for (auto it = ancestors.rbegin(), end = ancestors.rend(); it != end; ++it)
+            {
+                const CompoundStmt* compound_stmt = llvm::dyn_cast<CompoundStmt>(*it);
+                auto child_it = std::next(it);
+                if ((compound_stmt == nullptr) || (child_it == end))
+                {
+                    continue;
+                }
+
+                if (inserter_helper(*child_it, stmt))
                 {
                     return true;
                 }
@@ -1238,8 +2766,8 @@ namespace bobopt
             return false;
         }
 
-        /// \brief Helper for insert of block yield into single compound statement from set of compound statements.
-        bool yield_complex::inserter(const CFGBlock& block, const std::vector<const CompoundStmt*>& stmts) const
+        /// \brief Helper for insert of block yield before the first statement of block.
+        bool yield_complex::inserter(const CFGBlock& block) const
         {
             if (block.empty())
             {
@@ -1261,14 +2789,7 @@ namespace bobopt
                 return false;
             }
 
-            for (const auto* stmt : stmts)
-            {
-                if (inserter(block_stmt, stmt))
-                {
-                    return true;
-                }
-            }
-            return false;
+            return inserter(block_stmt);
         }
 
     } // namespace
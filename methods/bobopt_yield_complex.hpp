@@ -23,7 +23,6 @@
 
 #include <memory>
 #include <string>
-#include <vector>
 
 // forward declarations:
 namespace clang
@@ -39,6 +38,9 @@ namespace clang
 namespace bobopt
 {
 
+    // forward declarations:
+    class method_context;
+
     namespace methods
     {
 
@@ -59,6 +61,7 @@ namespace bobopt
 
             // optimize:
             virtual void optimize(clang::CXXRecordDecl* box, clang::tooling::Replacements* replacements) BOBOPT_OVERRIDE;
+            virtual merge_policies get_merge_policy() const BOBOPT_OVERRIDE;
 
         private:
             BOBOPT_NONCOPYMOVABLE(yield_complex);
@@ -76,19 +79,26 @@ namespace bobopt
             void optimize_methods();
             void optimize_method(clang::CXXMethodDecl* method);
             void optimize_body(clang::CXXMethodDecl* method, clang::CompoundStmt* body, const clang::CFG& cfg);
+            void yield_fallback(clang::CXXMethodDecl* method, clang::CompoundStmt* body, const char* limit);
 
             bool yield_predefined(const clang::CFG& cfg, clang::CompoundStmt* body);
 
+            unsigned get_stride(const clang::Stmt* stmt) const;
+            std::string declare_counter() const;
+
             void inserter_invoke(clang::Stmt* stmt, clang::SourceLocation location) const;
             bool inserter_helper(clang::Stmt* dst_stmt, const clang::Stmt* src_stmt) const;
-            bool inserter(const clang::Stmt* stmt, const clang::CompoundStmt* compound_stmt) const;
-            bool inserter(const clang::CFGBlock& block, const std::vector<const clang::CompoundStmt*>& stmts) const;
+            bool inserter(const clang::Stmt* stmt) const;
+            bool inserter(const clang::CFGBlock& block) const;
 
             // data members:
             clang::CXXRecordDecl* box_;
             clang::tooling::Replacements* replacements_;
+            method_context* context_;
 
             std::string endl_;
+            /// \brief Number of yield counters declared in current member function.
+            mutable unsigned counters_;
 
             // constants:
             static const method_override BOX_EXEC_METHOD_OVERRIDES[];
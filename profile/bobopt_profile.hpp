@@ -0,0 +1,352 @@
+/// \file bobopt_profile.hpp File contains runtime of probes inserted by the
+/// optimizer in profile mode.
+///
+/// Header is self-contained, instrumented program only needs the profile
+/// directory in its include path. Probes record:
+/// - wall time of every invocation of box execution member function,
+///   time spent in yield() is included,
+/// - trip counts of loops per invocation,
+/// - each execution of yield() inserted by the optimizer.
+///
+/// Records are collected in per-thread ring buffer, which is drained into
+/// the log when it wraps around and when thread exits. Sites of probes are
+/// written at the end of the log when program exits. Log is written to file
+/// set by BOBOPT_PROFILE_OUTPUT environment variable, bobopt_profile.bin by
+/// default. Threads writing records have to finish before exit.
+///
+/// Log format (native endianness):
+/// \code
+/// header:  char magic[8] ("BOBOPTPF"), uint32 version
+/// block:   uint32 tag, uint32 count, payload
+/// records: count x record
+/// sites:   count x (uint32 line, string box, string method, string file)
+/// string:  uint32 length, chars
+/// \endcode
+/// Site id of record is the index of site in the sites block.
+
+#ifndef BOBOPT_PROFILE_BOBOPT_PROFILE_HPP_GUARD_
+#define BOBOPT_PROFILE_BOBOPT_PROFILE_HPP_GUARD_
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/// \def BOBOPT_PROFILE_SCOPE(box, method)
+/// Probe placed at the beginning of box execution member function. Measures
+/// the whole invocation and holds loop counters.
+#define BOBOPT_PROFILE_SCOPE(box, method) \
+    static const ::bobopt::profile::site_type bobopt_profile_site_ = ::bobopt::profile::log_writer::instance().register_site(box, method, __FILE__, __LINE__); \
+    ::bobopt::profile::scope bobopt_profile_scope_(bobopt_profile_site_)
+
+/// \def BOBOPT_PROFILE_LOOP(index)
+/// Probe placed at the beginning of loop body. Index is unique in member
+/// function and less than \c bobopt::profile::MAX_LOOPS.
+#define BOBOPT_PROFILE_LOOP(index) bobopt_profile_scope_.loop(index, __LINE__)
+
+/// \def BOBOPT_PROFILE_YIELD()
+/// Probe placed just before yield() inserted by optimizer.
+#define BOBOPT_PROFILE_YIELD() bobopt_profile_scope_.yield(__LINE__)
+
+namespace bobopt
+{
+
+    namespace profile
+    {
+
+        typedef std::uint32_t site_type;
+
+        /// \brief Maximal number of loops profiled in single member function.
+        /// Optimizer doesn't instrument more loops.
+        static const unsigned MAX_LOOPS = 16u;
+        /// \brief Number of records in per-thread ring buffer.
+        static const std::size_t BUFFER_CAPACITY = 4096u;
+
+        static const char LOG_MAGIC[8] = { 'B', 'O', 'B', 'O', 'P', 'T', 'P', 'F' };
+        static const std::uint32_t LOG_VERSION = 1u;
+
+        /// \brief Tags of log blocks.
+        enum block_tags
+        {
+            BT_RECORDS = 1,
+            BT_SITES = 2
+        };
+
+        /// \brief Kinds of records.
+        enum record_kinds
+        {
+            /// Value is wall time of invocation in nanoseconds.
+            RK_INVOCATION = 1,
+            /// Value is number of iterations of loop at line during single invocation.
+            RK_LOOP = 2,
+            /// Inserted yield at line was executed.
+            RK_YIELD = 3
+        };
+
+        /// \brief Single record of the log.
+        struct record
+        {
+            std::uint32_t kind;
+            site_type site;
+            std::uint32_t line;
+            std::uint32_t reserved;
+            std::uint64_t value;
+        };
+
+        /// \brief Source location of scope probe.
+        struct site
+        {
+            std::string box;
+            std::string method;
+            std::string file;
+            std::uint32_t line;
+        };
+
+        // log_writer:
+        //======================================================================
+
+        /// \brief Process-wide writer of the log. Owns sites of probes.
+        class log_writer
+        {
+        public:
+            static log_writer& instance()
+            {
+                static log_writer writer;
+                return writer;
+            }
+
+            ~log_writer()
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!open())
+                {
+                    return;
+                }
+
+                write_header(BT_SITES, static_cast<std::uint32_t>(sites_.size()));
+                for (const auto& site : sites_)
+                {
+                    write_value(site.line);
+                    write_string(site.box);
+                    write_string(site.method);
+                    write_string(site.file);
+                }
+            }
+
+            site_type register_site(const char* box, const char* method, const char* file, unsigned line)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+
+                site new_site;
+                new_site.box = box;
+                new_site.method = method;
+                new_site.file = file;
+                new_site.line = line;
+                sites_.push_back(new_site);
+
+                return static_cast<site_type>(sites_.size() - 1);
+            }
+
+            void write(const record* records, std::size_t count)
+            {
+                if (count == 0)
+                {
+                    return;
+                }
+
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!open())
+                {
+                    return;
+                }
+
+                write_header(BT_RECORDS, static_cast<std::uint32_t>(count));
+                os_.write(reinterpret_cast<const char*>(records), static_cast<std::streamsize>(count * sizeof(record)));
+            }
+
+        private:
+            log_writer()
+                : mutex_()
+                , os_()
+                , sites_()
+                , failed_(false)
+            {
+            }
+
+            log_writer(const log_writer&);
+            log_writer& operator=(const log_writer&);
+
+            bool open()
+            {
+                if (os_.is_open())
+                {
+                    return true;
+                }
+
+                if (failed_)
+                {
+                    return false;
+                }
+
+                const char* file_name = std::getenv("BOBOPT_PROFILE_OUTPUT");
+                if ((file_name == nullptr) || (*file_name == '\0'))
+                {
+                    file_name = "bobopt_profile.bin";
+                }
+
+                os_.open(file_name, std::ios::binary | std::ios::trunc);
+                if (!os_)
+                {
+                    failed_ = true;
+                    return false;
+                }
+
+                os_.write(LOG_MAGIC, sizeof(LOG_MAGIC));
+                write_value(LOG_VERSION);
+                return true;
+            }
+
+            void write_header(std::uint32_t tag, std::uint32_t count)
+            {
+                write_value(tag);
+                write_value(count);
+            }
+
+            void write_value(std::uint32_t value)
+            {
+                os_.write(reinterpret_cast<const char*>(&value), sizeof(value));
+            }
+
+            void write_string(const std::string& value)
+            {
+                write_value(static_cast<std::uint32_t>(value.size()));
+                os_.write(value.data(), static_cast<std::streamsize>(value.size()));
+            }
+
+            std::mutex mutex_;
+            std::ofstream os_;
+            std::vector<site> sites_;
+            bool failed_;
+        };
+
+        // thread_buffer:
+        //======================================================================
+
+        /// \brief Per-thread ring buffer of records. It is drained into the log
+        /// when it wraps around and when thread exits.
+        class thread_buffer
+        {
+        public:
+            static thread_buffer& instance()
+            {
+                static thread_local thread_buffer buffer;
+                return buffer;
+            }
+
+            ~thread_buffer()
+            {
+                flush();
+            }
+
+            void push(record_kinds kind, site_type site, std::uint32_t line, std::uint64_t value)
+            {
+                record& entry = records_[size_];
+                entry.kind = kind;
+                entry.site = site;
+                entry.line = line;
+                entry.reserved = 0;
+                entry.value = value;
+
+                if (++size_ == records_.size())
+                {
+                    flush();
+                }
+            }
+
+            void flush()
+            {
+                log_writer::instance().write(records_.data(), size_);
+                size_ = 0;
+            }
+
+        private:
+            thread_buffer()
+                : records_(BUFFER_CAPACITY)
+                , size_(0)
+            {
+                // Writer has to outlive buffer of the main thread.
+                log_writer::instance();
+            }
+
+            thread_buffer(const thread_buffer&);
+            thread_buffer& operator=(const thread_buffer&);
+
+            std::vector<record> records_;
+            std::size_t size_;
+        };
+
+        // scope:
+        //======================================================================
+
+        /// \brief Probe of single invocation of box execution member function.
+        class scope
+        {
+        public:
+            typedef std::chrono::steady_clock clock_type;
+
+            explicit scope(site_type site)
+                : site_(site)
+                , start_(clock_type::now())
+            {
+                std::memset(counts_, 0, sizeof(counts_));
+                std::memset(lines_, 0, sizeof(lines_));
+            }
+
+            ~scope()
+            {
+                const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - start_);
+
+                thread_buffer& buffer = thread_buffer::instance();
+                buffer.push(RK_INVOCATION, site_, 0, static_cast<std::uint64_t>(elapsed.count()));
+                for (unsigned i = 0; i < MAX_LOOPS; ++i)
+                {
+                    if (lines_[i] != 0)
+                    {
+                        buffer.push(RK_LOOP, site_, lines_[i], counts_[i]);
+                    }
+                }
+            }
+
+            void loop(unsigned index, unsigned line)
+            {
+                if (index < MAX_LOOPS)
+                {
+                    ++counts_[index];
+                    lines_[index] = line;
+                }
+            }
+
+            void yield(unsigned line)
+            {
+                thread_buffer::instance().push(RK_YIELD, site_, line, 1);
+            }
+
+        private:
+            scope(const scope&);
+            scope& operator=(const scope&);
+
+            site_type site_;
+            clock_type::time_point start_;
+            std::uint32_t counts_[MAX_LOOPS];
+            std::uint32_t lines_[MAX_LOOPS];
+        };
+
+    } // profile
+
+} // bobopt
+
+#endif // guard
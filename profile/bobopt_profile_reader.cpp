@@ -0,0 +1,269 @@
+/// \file bobopt_profile_reader.cpp Reader of logs written by programs
+/// instrumented in profile mode.
+///
+/// Usage: bobopt_profile_reader <log> [<log> ...]
+///
+/// Prints per-box report: invocations and wall time of each execution member
+/// function, trip counts of its loops and how many times inserted yields
+/// fired. Logs of several runs are merged by names of boxes and member
+/// functions.
+
+#include <profile/bobopt_profile.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bobopt
+{
+
+    namespace profile
+    {
+
+        /// \brief Summary of values of single probe.
+        struct summary
+        {
+            summary()
+                : count(0)
+                , total(0)
+                , max(0)
+            {
+            }
+
+            void add(std::uint64_t value)
+            {
+                ++count;
+                total += value;
+                max = std::max(max, value);
+            }
+
+            double mean() const
+            {
+                return (count == 0) ? 0.0 : static_cast<double>(total) / count;
+            }
+
+            std::uint64_t count;
+            std::uint64_t total;
+            std::uint64_t max;
+        };
+
+        /// \brief Profile of single box execution member function.
+        struct method_profile
+        {
+            std::string file;
+            summary invocations;
+            std::map<std::uint32_t, summary> loops;
+            std::map<std::uint32_t, std::uint64_t> yields;
+        };
+
+        /// \brief Profiles of member functions of single box.
+        typedef std::map<std::string, method_profile> box_profile;
+        /// \brief Profiles of boxes by their names.
+        typedef std::map<std::string, box_profile> report_type;
+
+        static bool read_value(std::istream& is, std::uint32_t& value)
+        {
+            return static_cast<bool>(is.read(reinterpret_cast<char*>(&value), sizeof(value)));
+        }
+
+        static bool read_string(std::istream& is, std::string& value)
+        {
+            std::uint32_t length = 0;
+            if (!read_value(is, length))
+            {
+                return false;
+            }
+
+            value.resize(length);
+            return (length == 0) || static_cast<bool>(is.read(&value[0], length));
+        }
+
+        /// \brief Read the whole log and merge it into report.
+        static bool read_log(const std::string& file_name, report_type& report)
+        {
+            std::ifstream is(file_name, std::ios::binary);
+            if (!is)
+            {
+                std::cerr << "failed to open log: " << file_name << std::endl;
+                return false;
+            }
+
+            char magic[sizeof(LOG_MAGIC)];
+            std::uint32_t version = 0;
+            if (!is.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), LOG_MAGIC) || !read_value(is, version) ||
+                (version != LOG_VERSION))
+            {
+                std::cerr << "invalid log header: " << file_name << std::endl;
+                return false;
+            }
+
+            // Sites are written at exit, records have to wait for them.
+            std::vector<record> records;
+            std::vector<site> sites;
+
+            std::uint32_t tag = 0;
+            while (read_value(is, tag))
+            {
+                std::uint32_t count = 0;
+                if (!read_value(is, count))
+                {
+                    std::cerr << "truncated log: " << file_name << std::endl;
+                    return false;
+                }
+
+                if (tag == BT_RECORDS)
+                {
+                    const std::size_t offset = records.size();
+                    records.resize(offset + count);
+                    if (!is.read(reinterpret_cast<char*>(&records[offset]), static_cast<std::streamsize>(count * sizeof(record))))
+                    {
+                        std::cerr << "truncated log: " << file_name << std::endl;
+                        return false;
+                    }
+                }
+                else if (tag == BT_SITES)
+                {
+                    for (std::uint32_t i = 0; i < count; ++i)
+                    {
+                        site new_site;
+                        if (!read_value(is, new_site.line) || !read_string(is, new_site.box) || !read_string(is, new_site.method) ||
+                            !read_string(is, new_site.file))
+                        {
+                            std::cerr << "truncated log: " << file_name << std::endl;
+                            return false;
+                        }
+                        sites.push_back(new_site);
+                    }
+                }
+                else
+                {
+                    std::cerr << "unknown block " << tag << " in log: " << file_name << std::endl;
+                    return false;
+                }
+            }
+
+            if (sites.empty() && !records.empty())
+            {
+                std::cerr << "log without sites, program didn't exit normally: " << file_name << std::endl;
+                return false;
+            }
+
+            for (const auto& entry : records)
+            {
+                if (entry.site >= sites.size())
+                {
+                    std::cerr << "record of unknown site " << entry.site << " in log: " << file_name << std::endl;
+                    return false;
+                }
+
+                const site& entry_site = sites[entry.site];
+                method_profile& profile = report[entry_site.box][entry_site.method];
+                profile.file = entry_site.file;
+
+                switch (entry.kind)
+                {
+                case RK_INVOCATION:
+                {
+                    profile.invocations.add(entry.value);
+                    break;
+                }
+
+                case RK_LOOP:
+                {
+                    profile.loops[entry.line].add(entry.value);
+                    break;
+                }
+
+                case RK_YIELD:
+                {
+                    profile.yields[entry.line] += entry.value;
+                    break;
+                }
+
+                default:
+                {
+                    std::cerr << "unknown record kind " << entry.kind << " in log: " << file_name << std::endl;
+                    return false;
+                }
+                }
+            }
+
+            return true;
+        }
+
+        /// \brief Print time given in nanoseconds in microseconds.
+        static std::string format_us(double ns)
+        {
+            std::ostringstream os;
+            os << std::fixed << std::setprecision(3) << (ns / 1000.0) << " us";
+            return os.str();
+        }
+
+        static void print_report(std::ostream& os, const report_type& report)
+        {
+            for (const auto& box : report)
+            {
+                os << "box " << box.first << '\n';
+                for (const auto& method : box.second)
+                {
+                    const method_profile& profile = method.second;
+                    const summary& invocations = profile.invocations;
+
+                    os << "    " << method.first << " (" << profile.file << "): " << invocations.count << " invocations, total "
+                       << format_us(static_cast<double>(invocations.total)) << ", mean " << format_us(invocations.mean()) << ", max "
+                       << format_us(static_cast<double>(invocations.max)) << '\n';
+
+                    for (const auto& loop : profile.loops)
+                    {
+                        os << "        loop at line " << loop.first << ": executed in " << loop.second.count << " invocations, "
+                           << loop.second.total << " trips, mean " << std::fixed << std::setprecision(1) << loop.second.mean() << ", max "
+                           << loop.second.max << '\n';
+                    }
+
+                    for (const auto& yield : profile.yields)
+                    {
+                        const double per_invocation = (invocations.count == 0) ? 0.0 : static_cast<double>(yield.second) / invocations.count;
+                        os << "        yield at line " << yield.first << ": fired " << yield.second << " times, " << std::fixed
+                           << std::setprecision(3) << per_invocation << " per invocation\n";
+                    }
+
+                    if (profile.yields.empty())
+                    {
+                        os << "        no inserted yield fired\n";
+                    }
+                }
+                os << '\n';
+            }
+        }
+
+    } // profile
+
+} // bobopt
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "usage: bobopt_profile_reader <log> [<log> ...]" << std::endl;
+        return 2;
+    }
+
+    bobopt::profile::report_type report;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (!bobopt::profile::read_log(argv[i], report))
+        {
+            return 1;
+        }
+    }
+
+    bobopt::profile::print_report(std::cout, report);
+    return 0;
+}